@@ -26,6 +26,11 @@ typedef enum   rdpq_dither_s rdpq_dither_t;
 #define GL_N64_reduced_aliasing         1
 #define GL_N64_interpenetrating         1
 #define GL_N64_dither_mode              1
+#define GL_N64_draw_queue               1
+#define GL_N64_texture_load_stats       1
+#define GL_N64_secondary_texture        1
+#define GL_N64_preconverted_buffer      1
+#define GL_N64_instanced_draw           1
 
 /* Data types */
 
@@ -246,6 +251,14 @@ void glDrawArrays(GLenum mode, GLint first, GLsizei count);
 
 void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices);
 
+/* GL_N64_instanced_draw: draw the same elements once for each of the instancecount matrices
+ * (16 floats each, column-major), which are multiplied onto the modelview matrix. When the RSP
+ * pipeline is used, the vertex commands are generated only once and replayed for each instance.
+ * While a display list or a rspq block is being recorded, instances are drawn one by one instead.
+ * One level of the modelview stack is used, so GL_STACK_OVERFLOW is raised (and nothing is drawn)
+ * if the stack is full. */
+void glDrawElementsInstancedN64(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices, GLsizei instancecount, const GLfloat *matrices);
+
 void glInterleavedArrays(GLenum format, GLsizei stride, const GLvoid *pointer);
 
 void glGenVertexArrays(GLsizei n, GLuint *arrays);
@@ -445,6 +458,8 @@ void glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffse
 void glSurfaceTexImageN64(GLenum target, GLint level, surface_t *surface, rdpq_texparms_t *texparms);
 void glSpriteTextureN64(GLenum target, sprite_t *sprite, rdpq_texparms_t *texparms);
 
+void glSecondaryTextureN64(GLuint texture, GLenum mode, rdpq_texparms_t *texparms);
+
 void glTexParameteri(GLenum target, GLenum pname, GLint param);
 void glTexParameterf(GLenum target, GLenum pname, GLfloat param);
 
@@ -456,7 +471,7 @@ void glBindTexture(GLenum target, GLuint texture);
 void glDeleteTextures(GLsizei n, const GLuint *textures);
 void glGenTextures(GLsizei n, GLuint *textures);
 
-GLboolean glAreTexturesResident(GLsizei n, const GLuint *textures, const GLboolean *residences);
+GLboolean glAreTexturesResident(GLsizei n, const GLuint *textures, GLboolean *residences);
 
 void glPrioritizeTextures(GLsizei n, const GLuint *textures, const GLclampf *priorities);
 
@@ -587,6 +602,9 @@ GLboolean glIsList(GLuint list);
 
 void glDeleteLists(GLuint list, GLsizei range);
 
+void glBeginDrawQueueN64(void);
+void glEndDrawQueueN64(void);
+
 /* Synchronization */
 
 void glFlush(void);
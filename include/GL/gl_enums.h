@@ -50,6 +50,55 @@
 #define GL_VERTEX_HALF_FIXED_PRECISION_N64              0x6F20
 #define GL_TEXTURE_COORD_HALF_FIXED_PRECISION_N64       0x6F21
 
+/** @brief Statistics of the last draw queue submitted by glEndDrawQueueN64 (see glGetIntegerv)
+ * 
+ * Between glBeginDrawQueueN64 and glEndDrawQueueN64, glCallList does not run the display list
+ * but records it, together with the current modelview matrix, 2D texture, face culling and blending state.
+ * glEndDrawQueueN64 sorts the recorded calls (opaque ones roughly front to back and grouped by state,
+ * blended ones back to front), submits them restoring the recorded state for each, and then restores
+ * the state that was current when it was called. All other state is taken from the time of submission,
+ * so display lists should not depend on it. Display lists must not be deleted while they are queued.
+ * 
+ * GL_DRAW_QUEUE_DRAWS_N64 is the number of submitted display lists, GL_DRAW_QUEUE_STATE_CHANGES_N64
+ * the number of state changes caused by the submission, and GL_DRAW_QUEUE_UNSORTED_STATE_CHANGES_N64
+ * the number of state changes that the same calls would have caused in their original order. */
+#define GL_DRAW_QUEUE_DRAWS_N64                         0x6F30
+#define GL_DRAW_QUEUE_STATE_CHANGES_N64                 0x6F31
+#define GL_DRAW_QUEUE_UNSORTED_STATE_CHANGES_N64        0x6F32
+
+/* GL_N64_texture_load_stats: number of texture loads into TMEM, and total number of bytes loaded,
+ * since the beginning of the frame (gl_context_begin). A texture is loaded only when a primitive is
+ * drawn with a texture different from the one currently in TMEM, or after the texture was modified.
+ * Plain rdpq calls that load TMEM within the GL context (eg: rdpq_tex_upload, sprite blits, text)
+ * are tracked by rdpq, and cause the texture to be loaded again by the next primitive. Display lists
+ * cannot know what is in TMEM when they are called, so they must be run via glCallList. */
+#define GL_TEXTURE_LOADS_N64                            0x6F33
+#define GL_TEXTURE_LOAD_BYTES_N64                       0x6F34
+
+/* GL_N64_secondary_texture: glSecondaryTextureN64(texture, mode, texparms) combines a second texture
+ * with the 2D texture in a single pass, using the 2-cycle mode of the RDP (eg: for lightmaps or detail
+ * textures). mode is GL_MODULATE (multiply), GL_DECAL (blend using the alpha of the second texture) or
+ * GL_ADD (add the colors); the result is then combined with the vertex color following GL_TEXTURE_ENV_MODE.
+ * Passing 0 as texture disables the second texture.
+ *
+ * The RDP samples both textures with the same texture coordinates (in texels of the 2D texture), so
+ * the second texture has no texture coordinate array: texparms can be used to scale (scale_log) and
+ * offset (translate) it. The second texture must be a non-palettized texture with a single level that
+ * fits in 2 KiB of TMEM together with the 2D texture (this is asserted when drawing), which cannot use
+ * mipmaps, and fog is not supported.
+ * The image is captured when glSecondaryTextureN64 is called, so call it again after modifying it.
+ *
+ * GL_SECONDARY_TEXTURE_BINDING_N64 is the current second texture, or 0. */
+#define GL_SECONDARY_TEXTURE_BINDING_N64                0x6F35
+
+/* GL_N64_preconverted_buffer: buffer usage hint for static vertex data that is drawn with the RSP pipeline.
+ * When all enabled arrays are sourced from such a buffer, the vertices are converted once to the format
+ * expected by the RSP (the first time they are drawn with a given array layout) and the result is cached
+ * in the buffer object, so that later draws just copy it into the command stream. The cache is discarded
+ * when the buffer is modified (glBufferDataARB, glBufferSubDataARB, glMapBufferARB), and costs memory
+ * proportional to the number of vertices in the buffer. */
+#define GL_STATIC_DRAW_PRECONVERTED_N64                 0x6F36
+
 #define GL_VERTEX_ARRAY                                 0x8074
 #define GL_NORMAL_ARRAY                                 0x8075
 #define GL_COLOR_ARRAY                                  0x8076
@@ -0,0 +1,161 @@
+/**
+ * @file arena.h
+ * @brief Arena (linear) memory allocator
+ * @ingroup arena
+ */
+#ifndef __LIBDRAGON_ARENA_H
+#define __LIBDRAGON_ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup arena
+ * @{
+ */
+
+/** @brief Default size of the chunks reserved by an arena (64 KiB) */
+#define ARENA_DEFAULT_CHUNK_SIZE    (64*1024)
+
+/** @brief A chunk of memory reserved by an arena (opaque) */
+typedef struct arena_chunk_s arena_chunk_t;
+
+/**
+ * @brief An arena allocator.
+ *
+ * The structure can be placed anywhere (eg: as a static variable) and must be
+ * initialized with #arena_init. The statistics fields can be read freely
+ * but must not be modified.
+ */
+typedef struct arena_s {
+    arena_chunk_t *first;       ///< First chunk
+    arena_chunk_t *cur;         ///< Chunk where allocations are being carved
+    size_t chunk_size;          ///< Size of the chunks to reserve from the heap
+    size_t reserved;            ///< Memory reserved from the heap (statistic)
+    size_t used;                ///< Memory currently allocated (statistic)
+    size_t peak;                ///< Maximum value ever reached by used (statistic)
+} arena_t;
+
+/**
+ * @brief A position within an arena, see #arena_mark and #arena_rewind.
+ */
+typedef struct {
+    arena_chunk_t *chunk;       ///< Chunk which was current when the mark was taken
+    size_t offset;              ///< Offset within the chunk
+    size_t used;                ///< Used bytes when the mark was taken
+} arena_mark_t;
+
+/**
+ * @brief Initialize an arena.
+ *
+ * No memory is reserved until the first allocation. Chunks are reserved from
+ * the heap as needed, and kept until #arena_close is called: this means that
+ * an arena used with the same pattern every frame (or every level) does not
+ * touch the heap anymore after the first run, avoiding fragmentation.
+ *
+ * @param arena         Arena to initialize
+ * @param chunk_size    Size of the chunks to reserve from the heap, or 0
+ *                      for #ARENA_DEFAULT_CHUNK_SIZE.
+ */
+void arena_init(arena_t *arena, size_t chunk_size);
+
+/**
+ * @brief Release all the memory reserved by an arena.
+ *
+ * @param arena         Arena to close
+ */
+void arena_close(arena_t *arena);
+
+/**
+ * @brief Allocate memory from an arena.
+ *
+ * Allocation is a simple pointer bump. The memory can't be freed individually:
+ * use #arena_reset or #arena_rewind to release all allocations at once.
+ * Requests bigger than the chunk size are served by a dedicated chunk.
+ *
+ * @param arena         Arena to allocate from
+ * @param size          Size in bytes
+ * @param align         Alignment in bytes (power of two, at least 1)
+ * @return Pointer to the allocated memory, or NULL if out of memory
+ */
+void *arena_alloc(arena_t *arena, size_t size, size_t align);
+
+/**
+ * @brief Release all allocations of an arena, keeping its memory for reuse.
+ *
+ * This is the typical call at the start of each frame for a frame arena.
+ *
+ * @param arena         Arena to reset
+ */
+void arena_reset(arena_t *arena);
+
+/**
+ * @brief Take note of the current position of an arena.
+ *
+ * Together with #arena_rewind, this allows to nest scopes within an arena:
+ * for instance, a level can take a mark before loading its assets and
+ * rewind to it when unloaded, leaving the allocations done before intact.
+ *
+ * @param arena         Arena
+ * @return The current position
+ */
+arena_mark_t arena_mark(arena_t *arena);
+
+/**
+ * @brief Release all allocations performed after a mark was taken.
+ *
+ * @param arena         Arena
+ * @param mark          Position returned by #arena_mark
+ */
+void arena_rewind(arena_t *arena, arena_mark_t mark);
+
+/**
+ * @brief Check whether a pointer was allocated by an arena.
+ *
+ * @param arena         Arena
+ * @param ptr           Pointer to check
+ * @return true if the pointer is within one of the chunks of the arena
+ */
+bool arena_contains(arena_t *arena, const void *ptr);
+
+/**
+ * @brief Redirect library loaders to an arena.
+ *
+ * While an arena is current, the objects created by #asset_load,
+ * #sprite_load, #rdpq_paragraph_build and #model64_load are allocated from
+ * it instead of the heap. The free functions of those objects (#sprite_free,
+ * #rdpq_paragraph_free, #model64_free) become no-ops for them: their memory
+ * is released together with the arena. Buffers returned by #asset_load
+ * must not be passed to free().
+ *
+ * A typical usage is to make a level arena current while loading the
+ * level, and restoring the previous one afterwards:
+ *
+ * @code{.c}
+ *      arena_t *prev = arena_set_current(&level_arena);
+ *      level->bg = sprite_load("rom:/level1.sprite");
+ *      level->map = model64_load("rom:/level1.model64");
+ *      arena_set_current(prev);
+ * @endcode
+ *
+ * @param arena         Arena to make current, or NULL to go back to the heap
+ * @return The arena that was previously current
+ */
+arena_t *arena_set_current(arena_t *arena);
+
+/**
+ * @brief Return the arena currently used by library loaders, or NULL
+ */
+arena_t *arena_get_current(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
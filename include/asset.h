@@ -58,6 +58,9 @@ extern "C" {
  * If the file was compressed using the mkasset tool, it will be
  * automatically uncompressed.
  * 
+ * If an arena was made current via #arena_set_current, the buffer is
+ * allocated from it and must not be freed with free().
+ * 
  * @param fn        Filename to load (including filesystem prefix)
  * @param sz        Pointer to an integer where the size of the file will be stored
  * @return void*    Pointer to the loaded file (must be freed with free() when done)
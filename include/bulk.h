@@ -0,0 +1,104 @@
+/**
+ * @file bulk.h
+ * @brief Bulk memory copies and fills
+ * @ingroup bulk
+ */
+#ifndef __LIBDRAGON_BULK_H
+#define __LIBDRAGON_BULK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup bulk Bulk memory copies and fills
+ * @ingroup rsp_compute
+ * @brief memcpy / memset replacements for large buffers, offloaded to RSP and RDP.
+ *
+ * Copying or filling a large buffer with the CPU goes through the data cache:
+ * every byte that is touched evicts something else (the VR4300 data cache
+ * is only 8 KiB), so a big memcpy also slows down the code that runs right
+ * after it. The functions in this module offload big transfers to the RSP
+ * (via @ref rsp_compute, that streams the data through DMEM with DMA) or,
+ * for fills, to the RDP in fill mode, which is the fastest way to write
+ * memory on the N64. Neither of them pollutes the CPU cache.
+ *
+ * The functions are synchronous and behave exactly like memcpy / memset:
+ * small or unaligned transfers, or transfers requested when the accelerators
+ * are not initialized, simply fall back to the CPU. The size thresholds
+ * (#BULK_RSP_MIN_SIZE and #BULK_RDP_MIN_SIZE) are provisional estimates:
+ * they have not been measured yet, and should be tuned with the crossover
+ * benchmark in the testsuite (`test_bulk_benchmark`).
+ *
+ * The RSP path is used only if #rsp_compute_init was called; the RDP path
+ * is used only if #rdpq_init was called. Since they wait for the RSP queue,
+ * these functions must not be called while recording a rspq block, nor
+ * from interrupt handlers.
+ * @{
+ */
+
+/**
+ * @brief Minimum size for a copy or fill to be offloaded to the RSP.
+ *
+ * Below this size, the cost of the round-trip through the RSP queue is
+ * higher than the time the CPU needs to do the work.
+ */
+#define BULK_RSP_MIN_SIZE       4096
+
+/**
+ * @brief Minimum size for a fill to be offloaded to the RDP.
+ *
+ * The RDP fills memory much faster than the RSP, but it requires a full
+ * sync of the RDP pipeline, which is expensive.
+ */
+#define BULK_RDP_MIN_SIZE       16384
+
+/**
+ * @brief Copy a memory buffer, offloading large copies to the RSP.
+ *
+ * The buffers must not overlap. The RSP path is used if the source and
+ * destination have the same alignment modulo 8; the unaligned head and
+ * tail are copied by the CPU while the RSP works.
+ *
+ * @param dst           Destination buffer
+ * @param src           Source buffer
+ * @param n             Number of bytes to copy
+ * @return dst
+ */
+void *bulk_memcpy(void *dst, const void *src, size_t n);
+
+/**
+ * @brief Fill a memory buffer with a 32-bit pattern, offloading large fills.
+ *
+ * Large fills are done by the RDP (if the buffer is big enough to amortize
+ * a full sync) or by the RSP.
+ *
+ * @param dst           Destination buffer (4-byte aligned)
+ * @param pattern       32-bit pattern to repeat
+ * @param n             Number of bytes to fill (multiple of 4)
+ * @return dst
+ */
+void *bulk_memset32(void *dst, uint32_t pattern, size_t n);
+
+/**
+ * @brief Fill a memory buffer with a byte, offloading large fills.
+ *
+ * This is a drop-in replacement for memset. See #bulk_memset32.
+ *
+ * @param dst           Destination buffer
+ * @param c             Byte value
+ * @param n             Number of bytes to fill
+ * @return dst
+ */
+void *bulk_memset(void *dst, int c, size_t n);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
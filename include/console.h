@@ -9,6 +9,7 @@
 
 #include <stdbool.h>
 #include "display.h"
+#include "graphics.h"
 
 /**
  * @addtogroup console
@@ -84,6 +85,8 @@ void console_set_debug(bool debug);
 void console_set_render_mode(int mode);
 void console_clear();
 void console_render();
+void console_init_overlay(void);
+void console_render_overlay(int x, int y, color_t color);
 
 #ifdef __cplusplus
 }
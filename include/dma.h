@@ -7,6 +7,7 @@
 #define __LIBDRAGON_DMA_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,6 +39,50 @@ bool io_accessible(uint32_t pi_address);
 __attribute__((deprecated("use dma_wait instead"))) 
 volatile int dma_busy(void);
 
+/** @brief Default priority of a queued DMA request */
+#define DMA_PRIORITY_NORMAL     0
+/** @brief Priority for latency-sensitive streaming (eg: audio) */
+#define DMA_PRIORITY_HIGH       10
+
+/** @brief State of a queued DMA request */
+typedef enum {
+    DMA_REQ_IDLE = 0,       ///< Not yet submitted (or reinitialized by the user)
+    DMA_REQ_PENDING,        ///< Waiting in the queue, or partially transferred
+    DMA_REQ_DONE,           ///< Transfer completed
+} dma_req_state_t;
+
+/**
+ * @brief A PI DMA read request, to be submitted with #dma_queue_read
+ * 
+ * The structure is owned by the caller and must stay valid until the request
+ * is completed. Fill in the public fields before submitting it; the other
+ * fields are managed by the DMA queue.
+ */
+typedef struct dma_req_s {
+    void *ram_address;          ///< Destination buffer in RDRAM
+    uint32_t pi_address;        ///< PI address to read from (same 1-bit misalignment of ram_address)
+    uint32_t len;               ///< Number of bytes to read
+    int priority;               ///< Priority (higher values are transferred first)
+    /** 
+     * @brief Optional completion callback.
+     * 
+     * It is called under interrupt, as soon as the transfer is finished. It is
+     * allowed to submit new requests from within the callback.
+     */
+    void (*callback)(struct dma_req_s *req);
+    void *arg;                  ///< Opaque user data for the callback
+
+    volatile dma_req_state_t state; ///< Current state of the request
+    uint32_t done;              ///< Number of bytes already transferred
+    struct dma_req_s *next;     ///< Next request in the queue
+} dma_req_t;
+
+void dma_queue_read(dma_req_t *req);
+bool dma_req_done(dma_req_t *req);
+void dma_req_wait(dma_req_t *req);
+void dma_queue_wait(void);
+void dma_queue_read_wait(void *ram_address, uint32_t pi_address, uint32_t len, int priority);
+
 
 #ifdef __cplusplus
 }
@@ -6,6 +6,8 @@
 #ifndef __LIBDRAGON_DRAGONFS_H
 #define __LIBDRAGON_DRAGONFS_H
 
+#include <stdbool.h>
+
 /** 
  * @addtogroup dfs
  * @{
@@ -101,6 +103,7 @@ int dfs_close(uint32_t handle);
 int dfs_eof(uint32_t handle);
 int dfs_size(uint32_t handle);
 uint32_t dfs_rom_addr(const char *path);
+void dfs_trace_log(bool enable);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,236 @@
+/**
+ * @file fgeom.h
+ * @brief Vector, quaternion and matrix math for 3D graphics
+ * @ingroup fastmath
+ */
+#ifndef __LIBDRAGON_FGEOM_H
+#define __LIBDRAGON_FGEOM_H
+
+#include <stdint.h>
+#include "fmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup fastmath
+ * @{
+ */
+
+/** @brief A 3D vector */
+typedef union {
+    struct { float x, y, z; };
+    float v[3];         ///< Components as an array
+} fm_vec3_t;
+
+/** @brief A 4D (homogeneous) vector */
+typedef union {
+    struct { float x, y, z, w; };
+    float v[4];         ///< Components as an array
+} fm_vec4_t;
+
+/** @brief A rotation quaternion */
+typedef union {
+    struct { float x, y, z, w; };
+    float v[4];         ///< Components as an array
+} fm_quat_t;
+
+/**
+ * @brief A 4x4 matrix
+ *
+ * The matrix is stored in column-major order (`m[column][row]`), the same
+ * layout used by OpenGL, so it can be passed as-is to `glLoadMatrixf` and
+ * `glMultMatrixf`.
+ */
+typedef struct {
+    float m[4][4];
+} fm_mat4_t;
+
+/**
+ * @brief A 4x4 matrix in the fixed-point format used by RSP ucodes
+ *
+ * Each element is a signed 16.16 number, split in two halves: the integer
+ * parts of all elements come first, followed by all the fractional parts.
+ * This is the layout the RSP needs to load the matrix in the vector registers
+ * and run the multiplications with VMUDN / VMADH. The structure is 16-byte
+ * aligned so that it can be DMA'd directly.
+ */
+typedef struct {
+    int16_t integer[4][4];      ///< Integer parts (column-major)
+    uint16_t fraction[4][4];    ///< Fractional parts (column-major)
+} __attribute__((aligned(16))) fm_mat4_fixed_t;
+
+/** @brief Add two vectors */
+static inline void fm_vec3_add(fm_vec3_t *out, const fm_vec3_t *a, const fm_vec3_t *b) {
+    out->x = a->x + b->x; out->y = a->y + b->y; out->z = a->z + b->z;
+}
+
+/** @brief Subtract two vectors */
+static inline void fm_vec3_sub(fm_vec3_t *out, const fm_vec3_t *a, const fm_vec3_t *b) {
+    out->x = a->x - b->x; out->y = a->y - b->y; out->z = a->z - b->z;
+}
+
+/** @brief Scale a vector by a scalar */
+static inline void fm_vec3_scale(fm_vec3_t *out, const fm_vec3_t *a, float s) {
+    out->x = a->x * s; out->y = a->y * s; out->z = a->z * s;
+}
+
+/** @brief Dot product of two vectors */
+static inline float fm_vec3_dot(const fm_vec3_t *a, const fm_vec3_t *b) {
+    return a->x * b->x + a->y * b->y + a->z * b->z;
+}
+
+/** @brief Cross product of two vectors (out can alias the inputs) */
+static inline void fm_vec3_cross(fm_vec3_t *out, const fm_vec3_t *a, const fm_vec3_t *b) {
+    float x = a->y * b->z - a->z * b->y;
+    float y = a->z * b->x - a->x * b->z;
+    float z = a->x * b->y - a->y * b->x;
+    out->x = x; out->y = y; out->z = z;
+}
+
+/** @brief Squared length of a vector */
+static inline float fm_vec3_len2(const fm_vec3_t *a) {
+    return fm_vec3_dot(a, a);
+}
+
+/** @brief Length of a vector */
+static inline float fm_vec3_len(const fm_vec3_t *a) {
+    float l2 = fm_vec3_len2(a);
+    return l2 > 0 ? l2 * fm_rsqrtf(l2) : 0;
+}
+
+/**
+ * @brief Normalize a vector, using #fm_rsqrtf.
+ *
+ * A zero vector is left unchanged.
+ */
+static inline void fm_vec3_norm(fm_vec3_t *out, const fm_vec3_t *a) {
+    float l2 = fm_vec3_len2(a);
+    if (l2 > 0) fm_vec3_scale(out, a, fm_rsqrtf(l2));
+    else *out = *a;
+}
+
+/** @brief Linear interpolation between two vectors */
+static inline void fm_vec3_lerp(fm_vec3_t *out, const fm_vec3_t *a, const fm_vec3_t *b, float t) {
+    out->x = a->x + (b->x - a->x) * t;
+    out->y = a->y + (b->y - a->y) * t;
+    out->z = a->z + (b->z - a->z) * t;
+}
+
+/** @brief Set a quaternion to the identity rotation */
+static inline void fm_quat_identity(fm_quat_t *out) {
+    *out = (fm_quat_t){{ 0, 0, 0, 1 }};
+}
+
+/** @brief Dot product of two quaternions */
+static inline float fm_quat_dot(const fm_quat_t *a, const fm_quat_t *b) {
+    return a->x * b->x + a->y * b->y + a->z * b->z + a->w * b->w;
+}
+
+/** @brief Normalize a quaternion, using #fm_rsqrtf */
+static inline void fm_quat_norm(fm_quat_t *out, const fm_quat_t *q) {
+    float s = fm_rsqrtf(fm_quat_dot(q, q));
+    out->x = q->x * s; out->y = q->y * s; out->z = q->z * s; out->w = q->w * s;
+}
+
+/**
+ * @brief Create a quaternion from a rotation around an axis.
+ *
+ * @param out       Output quaternion
+ * @param axis      Rotation axis (must be normalized)
+ * @param angle     Rotation angle in radians
+ */
+void fm_quat_from_axis_angle(fm_quat_t *out, const fm_vec3_t *axis, float angle);
+
+/** @brief Multiply two quaternions (compose rotations: first b, then a). Out can alias. */
+void fm_quat_mul(fm_quat_t *out, const fm_quat_t *a, const fm_quat_t *b);
+
+/** @brief Rotate a vector by a (normalized) quaternion. Out can alias v. */
+void fm_quat_rotate(fm_vec3_t *out, const fm_quat_t *q, const fm_vec3_t *v);
+
+/**
+ * @brief Interpolate between two rotations.
+ *
+ * Uses a normalized linear interpolation along the shortest path. For the
+ * small angles that are typical between animation keyframes, this is visually
+ * indistinguishable from a slerp, and much cheaper.
+ */
+void fm_quat_nlerp(fm_quat_t *out, const fm_quat_t *a, const fm_quat_t *b, float t);
+
+/** @brief Set a matrix to identity */
+void fm_mat4_identity(fm_mat4_t *out);
+
+/**
+ * @brief Multiply two matrices (out = a * b).
+ *
+ * Out can alias either input.
+ */
+void fm_mat4_mul(fm_mat4_t *out, const fm_mat4_t *a, const fm_mat4_t *b);
+
+/**
+ * @brief Build a matrix from scale, rotation and translation.
+ *
+ * The resulting matrix applies the scale first, then the rotation, and
+ * finally the translation. Any of the parameters can be NULL.
+ */
+void fm_mat4_from_srt(fm_mat4_t *out, const fm_vec3_t *scale, const fm_quat_t *rot, const fm_vec3_t *pos);
+
+/**
+ * @brief Invert an affine matrix (rotation, scale and translation, no projection).
+ *
+ * This is much faster than a generic 4x4 inversion. Out can alias m.
+ */
+void fm_mat4_affine_invert(fm_mat4_t *out, const fm_mat4_t *m);
+
+/**
+ * @brief Transform a 3D point by a matrix (w=1), producing a homogeneous result.
+ */
+static inline void fm_mat4_mul_vec3(fm_vec4_t *out, const fm_mat4_t *m, const fm_vec3_t *v) {
+    for (int i=0; i<4; i++)
+        out->v[i] = m->m[0][i] * v->x + m->m[1][i] * v->y + m->m[2][i] * v->z + m->m[3][i];
+}
+
+/**
+ * @brief Transform an array of 3D points by a matrix.
+ *
+ * This is the batch version of #fm_mat4_mul_vec3. It keeps the matrix
+ * in FPU registers for the whole array, and writes homogeneous coordinates
+ * as output. Input and output can be interleaved with other vertex
+ * attributes by specifying the distance in bytes between consecutive
+ * elements.
+ *
+ * @param m             Transformation matrix
+ * @param in            First input point
+ * @param in_stride     Distance in bytes between input points (0 = packed)
+ * @param out           First output point
+ * @param out_stride    Distance in bytes between output points (0 = packed)
+ * @param count         Number of points
+ */
+void fm_mat4_transform_vec3(const fm_mat4_t *m, const fm_vec3_t *in, int in_stride,
+    fm_vec4_t *out, int out_stride, int count);
+
+/**
+ * @brief Transform an array of 3D points by a matrix, without the w row.
+ *
+ * Same as #fm_mat4_transform_vec3 but for affine matrices: the fourth
+ * row is assumed to be (0,0,0,1) and the output is a 3D point.
+ */
+void fm_mat4_transform_vec3_affine(const fm_mat4_t *m, const fm_vec3_t *in, int in_stride,
+    fm_vec3_t *out, int out_stride, int count);
+
+/**
+ * @brief Convert a matrix to the fixed-point format used by RSP ucodes.
+ *
+ * Values are converted to signed 16.16, so they must be in the range
+ * [-32768, 32768).
+ */
+void fm_mat4_to_fixed(fm_mat4_fixed_t *out, const fm_mat4_t *m);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -87,10 +87,14 @@ static inline float fm_truncf(float x) {
     /* Notice that trunc.w.s is also emitted by the compiler when casting a
      * float to int, but in this case we want a floating point result anyway,
      * so it's useless to go back and forth a GPR. */
+#ifdef N64
     float yint, y;
     __asm ("trunc.w.s  %0,%1" : "=f"(yint) : "f"(x));
     __asm ("cvt.s.w  %0,%1" : "=f"(y) : "f"(yint));
     return y;
+#else
+    return __builtin_truncf(x);
+#endif
 }
 
 /**
@@ -99,10 +103,14 @@ static inline float fm_truncf(float x) {
  * Optimized version using the MIPS ceil.w.s instruction.
  */
 static inline float fm_ceilf(float x) {
+#ifdef N64
     float yint, y;
     __asm ("ceil.w.s  %0,%1" : "=f"(yint) : "f"(x));
     __asm ("cvt.s.w  %0,%1" : "=f"(y) : "f"(yint));
     return y;
+#else
+    return __builtin_ceilf(x);
+#endif
 }
 
 /**
@@ -187,6 +195,26 @@ float fm_cosf(float x);
  */
 float fm_atan2f(float y, float x);
 
+/**
+ * @brief Fast reciprocal square root (1 / sqrtf(x)).
+ * 
+ * Computes an initial approximation by manipulating the floating point
+ * representation, refined by two Newton-Raphson iterations. The relative
+ * error is within ~5e-6, and it runs in about ~15 ticks, versus ~60 ticks
+ * of the sqrt.s + div.s sequence generated for `1.0f / sqrtf(x)`.
+ * 
+ * The result is undefined for x <= 0.
+ */
+static inline float fm_rsqrtf(float x) {
+    int32_t i = BITCAST_F2I(x);
+    i = 0x5f375a86 - (i >> 1);
+    float y = BITCAST_I2F(i);
+    float xhalf = x * 0.5f;
+    y = y * (1.5f - xhalf * y * y);
+    y = y * (1.5f - xhalf * y * y);
+    return y;
+}
+
 #ifdef LIBDRAGON_FAST_MATH
     #define truncf(x)     fm_truncf(x)
     #define floorf(x)     fm_floorf(x)
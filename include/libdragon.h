@@ -27,6 +27,7 @@
 /* Easy include wrapper */
 #include "n64types.h"
 #include "fmath.h"
+#include "fgeom.h"
 #include "audio.h"
 #include "console.h"
 #include "debug.h"
@@ -44,6 +45,8 @@
 #include "graphics.h"
 #include "interrupt.h"
 #include "n64sys.h"
+#include "uncached_pool.h"
+#include "arena.h"
 #include "backtrace.h"
 #include "rdp.h"
 #include "rsp.h"
@@ -58,6 +61,8 @@
 #include "xm64.h"
 #include "ym64.h"
 #include "rspq.h"
+#include "rsp_compute.h"
+#include "bulk.h"
 #include "rdpq.h"
 #include "rdpq_tri.h"
 #include "rdpq_rect.h"
@@ -68,6 +73,7 @@
 #include "rdpq_text.h"
 #include "rdpq_paragraph.h"
 #include "rdpq_font.h"
+#include "rdpq_occlusion.h"
 #include "rdpq_debug.h"
 #include "rdpq_macros.h"
 #include "surface.h"
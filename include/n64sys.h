@@ -259,6 +259,17 @@ void inst_cache_invalidate_all(void);
 
 int get_memory_size();
 bool is_memory_expanded();
+
+/** @brief Statistics about the heap, see #sys_get_heap_stats */
+typedef struct {
+    int total;              ///< Total size of the heap in bytes
+    int used;               ///< Bytes currently allocated
+    int free;               ///< Bytes available (free chunks plus memory never reserved by the allocator)
+    int largest_free;       ///< Largest block that can currently be allocated
+    int fragmentation;      ///< Percentage of free memory not available as a single block
+} heap_stats_t;
+
+void sys_get_heap_stats(heap_stats_t *stats);
 void *malloc_uncached(size_t size);
 void *malloc_uncached_aligned(int align, size_t size);
 void free_uncached(void *buf);
@@ -12,12 +12,17 @@
  * Moreover, a small render target stack is kept internally so to make it easier to
  * temporarily switch rendering to an offscreen surface, and then restore the main
  * render target.
+ * 
+ * Finally, a pool of transient render targets is available (see #rdpq_rt_acquire)
+ * for offscreen passes like shadows, reflections or post-processing, so that
+ * they can share and recycle their buffers instead of allocating their own.
  */
 
 #ifndef LIBDRAGON_RDPQ_ATTACH_H
 #define LIBDRAGON_RDPQ_ATTACH_H
 
 #include "rspq.h"
+#include "surface.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -192,6 +197,90 @@ void rdpq_detach_cb(void (*cb)(void*), void *arg);
  */
 const surface_t* rdpq_get_attached(void);
 
+/** @brief Statistics of the render target pool (see #rdpq_rt_get_stats) */
+typedef struct {
+    int num_surfaces;           ///< Number of surfaces allocated by the pool
+    int num_in_use;             ///< Number of surfaces acquired and not yet recycled
+    int memory;                 ///< Memory allocated by the pool (in bytes)
+    int memory_in_use;          ///< Memory of the surfaces in use (in bytes)
+    int peak_memory;            ///< Peak of the memory allocated by the pool (in bytes)
+    int peak_memory_in_use;     ///< Peak of the memory of the surfaces in use (in bytes)
+} rdpq_rt_stats_t;
+
+/**
+ * @brief Acquire a transient render target from the pool
+ * 
+ * This function returns a surface with the requested format and size, that
+ * can be used as an offscreen render target (and Z-buffer) with #rdpq_attach,
+ * and then as a texture. The surface is owned by the pool: when it is not
+ * needed anymore, call #rdpq_rt_release, and the pool will hand it out
+ * again to a later #rdpq_rt_acquire with the same format and size.
+ * 
+ * The contents of the surface are undefined: use #rdpq_attach_clear or
+ * #rdpq_clear if needed.
+ * 
+ * A new surface is allocated only if all the ones with the same format and size
+ * are in use, so an effect that acquires and releases its render targets every
+ * frame does not allocate memory after the first one.
+ * 
+ * @code{.c}
+ *      // Render the shadow map
+ *      surface_t *shadow = rdpq_rt_acquire(FMT_I8, 64, 64);
+ *      rdpq_attach_clear(shadow, NULL);
+ *      draw_shadow_casters();
+ *      rdpq_detach();
+ * 
+ *      // Use it while rendering the scene
+ *      rdpq_attach(display_get(), NULL);
+ *      draw_scene(shadow);
+ *      rdpq_rt_release(shadow);
+ *      rdpq_detach_show();
+ * @endcode
+ * 
+ * @param[in] format    Format of the surface
+ * @param[in] width     Width of the surface in pixels
+ * @param[in] height    Height of the surface in pixels
+ * @return              The surface
+ * 
+ * @see #rdpq_rt_release
+ */
+surface_t* rdpq_rt_acquire(tex_format_t format, uint16_t width, uint16_t height);
+
+/**
+ * @brief Release a render target acquired from the pool
+ * 
+ * The surface is not reused immediately: it is recycled only after the RDP
+ * has finished processing all commands enqueued until now, including those
+ * that are still reading from it (eg: as a texture). So it is safe to release
+ * a render target right after the last command that uses it is enqueued,
+ * without waiting for the RDP. The surface must not be attached anymore.
+ * 
+ * @param[in] surf      The surface returned by #rdpq_rt_acquire
+ * 
+ * @see #rdpq_rt_acquire
+ */
+void rdpq_rt_release(surface_t *surf);
+
+/**
+ * @brief Free all the surfaces of the pool that are not in use
+ * 
+ * This can be used when the offscreen passes change (eg: on a level change),
+ * to give back the memory of the render targets that are not needed anymore.
+ */
+void rdpq_rt_trim(void);
+
+/**
+ * @brief Get the statistics of the render target pool
+ * 
+ * The peak memory values can be used to budget the memory of the offscreen
+ * passes: `peak_memory_in_use` is the most memory that was needed at the same
+ * time, while `peak_memory` also includes the surfaces that were allocated for
+ * different formats or sizes.
+ * 
+ * @return              The statistics
+ */
+rdpq_rt_stats_t rdpq_rt_get_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,224 @@
+/**
+ * @file rdpq_occlusion.h
+ * @brief RDP Command queue: coarse occlusion culling
+ * @ingroup rdpq
+ */
+
+#ifndef LIBDRAGON_RDPQ_OCCLUSION_H
+#define LIBDRAGON_RDPQ_OCCLUSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "rdpq_tri.h"
+#include "fgeom.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup rdpq_occlusion Coarse occlusion culling
+ * @ingroup rdpq
+ * @brief Reject hidden geometry on the CPU, before it reaches the RDP.
+ *
+ * The RDP performs the depth test per pixel: a hidden triangle costs the
+ * same Z-buffer read bandwidth as a visible one, and RDRAM bandwidth is
+ * usually the bottleneck of a 3D scene. In scenes with heavy occlusion
+ * (eg: indoor levels), a lot of it is spent on pixels that are then discarded.
+ *
+ * This module implements a small, low-resolution depth buffer on the CPU.
+ * Each cell covers #RDPQ_OCCLUSION_CELL_SIZE x #RDPQ_OCCLUSION_CELL_SIZE pixels,
+ * and cells are grouped into tiles of #RDPQ_OCCLUSION_TILE_CELLS x
+ * #RDPQ_OCCLUSION_TILE_CELLS cells which store the farthest depth of their
+ * cells, so that large objects can be rejected checking just a few tiles.
+ *
+ * Each frame, the application draws a few big occluders (walls, floors,
+ * terrain: usually a simplified version of the level geometry) into the
+ * buffer, and then tests objects or triangles against it before drawing them:
+ *
+ * @code{.c}
+ *      rdpq_occlusion_clear(occ);
+ *      rdpq_occlusion_add_mesh(occ, &mvp, wall_verts, wall_indices, num_wall_indices);
+ *
+ *      for (int i=0; i<num_objects; i++) {
+ *          // Skip the object (including all its GL or rdpq commands)
+ *          // if it is fully hidden behind the occluders.
+ *          if (!rdpq_occlusion_test_box(occ, &objects[i].mvp, &objects[i].min, &objects[i].max))
+ *              continue;
+ *          draw_object(&objects[i]);
+ *      }
+ * @endcode
+ *
+ * The buffer is conservative: an occluder only fills the cells that it
+ * completely covers, and an object is rejected only if all the cells it
+ * touches are nearer than the object's nearest point. So culling never
+ * removes anything that would be visible; it just might keep something that
+ * is actually hidden. Since it works with bounding boxes and screen-space
+ * rectangles, it is useful for objects of at least a few cells; there is
+ * no point in testing tiny objects.
+ *
+ * Depth follows the rdpq convention: 0 is the near plane and 1 the far plane,
+ * and smaller values are nearer. The functions accepting a matrix use the
+ * OpenGL conventions (clip space with Z in [-1, 1], Y pointing up), and map
+ * the whole clip space to the whole buffer, so the buffer should have the
+ * same size of the GL viewport.
+ *
+ * Use #rdpq_occlusion_get_stats to know how much work was saved.
+ * @{
+ */
+
+/** @brief Size in pixels of a cell of the occlusion buffer (both width and height) */
+#define RDPQ_OCCLUSION_CELL_SIZE        8
+
+/** @brief Size in cells of a tile of the occlusion buffer (both width and height) */
+#define RDPQ_OCCLUSION_TILE_CELLS       4
+
+/** @brief An occlusion buffer (opaque structure) */
+typedef struct rdpq_occlusion_s rdpq_occlusion_t;
+
+/** @brief Statistics of an occlusion buffer, since the last #rdpq_occlusion_clear */
+typedef struct {
+    int tris_tested;        ///< Number of triangles tested
+    int tris_rejected;      ///< Number of triangles rejected because hidden
+    int objects_tested;     ///< Number of objects (boxes) tested
+    int objects_rejected;   ///< Number of objects (boxes) rejected because hidden
+    int pixels_saved;       ///< Estimate of the screen pixels that were not sent to the RDP
+} rdpq_occlusion_stats_t;
+
+/**
+ * @brief Allocate an occlusion buffer
+ *
+ * @param width         Width of the screen area in pixels
+ * @param height        Height of the screen area in pixels
+ * @return              The new occlusion buffer, which is cleared
+ */
+rdpq_occlusion_t* rdpq_occlusion_alloc(int width, int height);
+
+/**
+ * @brief Free an occlusion buffer
+ *
+ * @param occ           The occlusion buffer
+ */
+void rdpq_occlusion_free(rdpq_occlusion_t *occ);
+
+/**
+ * @brief Clear an occlusion buffer and reset its statistics
+ *
+ * This is normally called at the beginning of each frame, before drawing
+ * the occluders.
+ *
+ * @param occ           The occlusion buffer
+ */
+void rdpq_occlusion_clear(rdpq_occlusion_t *occ);
+
+/**
+ * @brief Draw a screen-space triangle into the occlusion buffer as an occluder
+ *
+ * Each vertex is an array of three floats: X and Y in pixels, and the depth
+ * in the 0..1 range. The triangle can have any winding.
+ *
+ * @param occ           The occlusion buffer
+ * @param v1            Vertex 1 (X, Y, Z)
+ * @param v2            Vertex 2 (X, Y, Z)
+ * @param v3            Vertex 3 (X, Y, Z)
+ */
+void rdpq_occlusion_add_triangle(rdpq_occlusion_t *occ, const float *v1, const float *v2, const float *v3);
+
+/**
+ * @brief Draw an indexed mesh into the occlusion buffer as an occluder
+ *
+ * The vertices are transformed by the specified model-view-projection matrix.
+ * Triangles that cross the near plane are skipped, as they cannot be
+ * projected (which is conservative).
+ *
+ * @param occ           The occlusion buffer
+ * @param mvp           Model-view-projection matrix
+ * @param verts         Vertex positions (in object space)
+ * @param indices       Vertex indices, three for each triangle
+ * @param num_indices   Number of indices
+ */
+void rdpq_occlusion_add_mesh(rdpq_occlusion_t *occ, const fm_mat4_t *mvp,
+    const fm_vec3_t *verts, const uint16_t *indices, int num_indices);
+
+/**
+ * @brief Test whether a screen-space rectangle at the specified depth is visible
+ *
+ * This is the basic query used by all other tests. It does not update
+ * the statistics. Parts of the rectangle that are outside of the buffer
+ * are ignored; a rectangle which is completely outside is reported as visible
+ * (clipping it is not a job of the occlusion buffer).
+ *
+ * @param occ           The occlusion buffer
+ * @param x0            Left coordinate in pixels
+ * @param y0            Top coordinate in pixels
+ * @param x1            Right coordinate in pixels
+ * @param y1            Bottom coordinate in pixels
+ * @param zmin          Nearest depth of the geometry within the rectangle
+ * @return true         if the rectangle might be visible
+ * @return false        if the rectangle is hidden by the occluders
+ */
+bool rdpq_occlusion_test_rect(rdpq_occlusion_t *occ, float x0, float y0, float x1, float y1, float zmin);
+
+/**
+ * @brief Test whether a screen-space triangle is visible
+ *
+ * Vertices have the same format of #rdpq_occlusion_add_triangle.
+ *
+ * @param occ           The occlusion buffer
+ * @param v1            Vertex 1 (X, Y, Z)
+ * @param v2            Vertex 2 (X, Y, Z)
+ * @param v3            Vertex 3 (X, Y, Z)
+ * @return true         if the triangle might be visible
+ * @return false        if the triangle is hidden by the occluders
+ */
+bool rdpq_occlusion_test_triangle(rdpq_occlusion_t *occ, const float *v1, const float *v2, const float *v3);
+
+/**
+ * @brief Test whether an object is visible, given its bounding box
+ *
+ * The 8 corners of the box are transformed by the specified model-view-projection
+ * matrix, and the screen-space bounding rectangle is tested. If the box crosses
+ * the near plane, it is always considered visible.
+ *
+ * @param occ           The occlusion buffer
+ * @param mvp           Model-view-projection matrix
+ * @param min           Minimum corner of the box (in object space)
+ * @param max           Maximum corner of the box (in object space)
+ * @return true         if the object might be visible
+ * @return false        if the object is hidden by the occluders
+ */
+bool rdpq_occlusion_test_box(rdpq_occlusion_t *occ, const fm_mat4_t *mvp,
+    const fm_vec3_t *min, const fm_vec3_t *max);
+
+/**
+ * @brief Draw a triangle with #rdpq_triangle, unless it is hidden by the occluders
+ *
+ * This is a drop-in replacement for #rdpq_triangle. The triangle format must
+ * have a depth component (`z_offset >= 0`), which is used for the test.
+ *
+ * @param occ           The occlusion buffer
+ * @param fmt           Format of the triangle (see #rdpq_triangle)
+ * @param v1            Array of components for vertex 1
+ * @param v2            Array of components for vertex 2
+ * @param v3            Array of components for vertex 3
+ * @return true         if the triangle was drawn
+ * @return false        if the triangle was rejected
+ */
+bool rdpq_occlusion_triangle(rdpq_occlusion_t *occ, const rdpq_trifmt_t *fmt,
+    const float *v1, const float *v2, const float *v3);
+
+/**
+ * @brief Get the statistics of the occlusion buffer since the last clear
+ *
+ * @param occ           The occlusion buffer
+ * @return              The statistics
+ */
+rdpq_occlusion_stats_t rdpq_occlusion_get_stats(rdpq_occlusion_t *occ);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -55,6 +55,7 @@ typedef struct {
     int nlines;                      ///< Number of lines of the text
     int nchars;                      ///< Total number of chars in this layout
     int capacity;                    ///< Capacity of the chars array
+    bool arena_allocated;            ///< Allocated from an arena: not freed by #rdpq_paragraph_free
     float x0, y0;                    ///< Alignment offset of the text
     rdpq_paragraph_char_t chars[];   ///< Array of chars
 } rdpq_paragraph_t;
@@ -92,6 +93,8 @@ typedef struct {
  * @param nbytes            Number of bytes in the text to render. On return, the number
  *                          of bytes consumed in the input.
  * @return                  Calculated layout. Free it with #rdpq_paragraph_free when not needed anymore.
+ *                          If an arena is current (see #arena_set_current), the layout is
+ *                          allocated from it.
  */
 rdpq_paragraph_t* rdpq_paragraph_build(const rdpq_textparms_t *parms, uint8_t initial_font_id, 
     const char *utf8_text, int *nbytes);
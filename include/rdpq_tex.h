@@ -166,6 +166,13 @@ int rdpq_tex_upload(rdpq_tile_t tile, const surface_t *tex, const rdpq_texparms_
  * be 8-byte aligned (like all RDP textures), so it can only be used if the
  * rectangle that needs to be loaded respects such constraint as well.
  * 
+ * Block-compressed surfaces (#SURFACE_FLAGS_BLOCKCOMP, created by mksprite
+ * with --compress-blocks) are supported as well: only the lines that cover the
+ * rectangle are decoded into a temporary RGBA16 buffer, which is then loaded into
+ * TMEM and released once the RDP has finished with it. Only the compressed data
+ * stays in RDRAM. Sub-surfaces of a compressed surface cannot be created, so this
+ * function is the only way to load a portion of it. If the upload is recorded in
+ * a rspq block, the decoded lines are kept until the block is freed.
  * 
  * @param tile       Tile descriptor that will be initialized with this texture
  * @param tex        Surface containing the texture to load
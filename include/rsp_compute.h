@@ -0,0 +1,212 @@
+/**
+ * @file rsp_compute.h
+ * @brief RSP compute offload
+ * @ingroup rsp_compute
+ */
+#ifndef __LIBDRAGON_RSP_COMPUTE_H
+#define __LIBDRAGON_RSP_COMPUTE_H
+
+#include <stdint.h>
+#include "rspq.h"
+#include "fgeom.h"
+#include "rsp_compute_constants.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup rsp_compute RSP compute offload
+ * @ingroup rsp
+ * @brief Run data-parallel kernels on the RSP over arrays in RDRAM.
+ *
+ * This module is a thin dispatch layer on top of @ref rspq that allows to
+ * offload simple data-parallel workloads to the RSP. A "kernel" is a small
+ * RSP function that processes a chunk of data in DMEM; the compute driver
+ * takes care of streaming the input arrays from RDRAM into DMEM and the
+ * results back, double-buffering the chunks so that DMA transfers overlap
+ * with the computation.
+ *
+ * A few kernels are built-in (see #rsp_compute_kernel_t) and have
+ * convenience wrappers like #rsp_compute_memcpy or #rsp_compute_transform.
+ * Custom kernels can be written in a user overlay that includes
+ * `rsp_compute.inc` (see the documentation in that file for the kernel ABI)
+ * and run via #rsp_compute_dispatch.
+ *
+ * All the functions in this module are asynchronous: they only enqueue
+ * commands in the RSP queue and return immediately. Use #rsp_compute_fence
+ * and #rsp_compute_fence_wait to know when the results are available. Until
+ * then, the input buffers must not be modified or freed, and the output
+ * buffers must not be accessed by the CPU.
+ *
+ * Buffer requirements:
+ *
+ *   * All buffers must be 8-byte aligned (16-byte aligned is recommended,
+ *     as it avoids partial cache lines on the output).
+ *   * Sizes must be a multiple of 16 bytes.
+ *   * Output buffers can overlap the input buffers only if they are the
+ *     same (in-place processing).
+ *
+ * The RSP is not always faster than the CPU: a kernel that does very little
+ * math per byte (like memcpy) is bound by RDRAM bandwidth on both processors.
+ * The advantage in that case is that the CPU is free to do something else
+ * in the meantime.
+ * @{
+ */
+
+/** @brief Built-in compute kernels */
+typedef enum {
+    RSP_COMPUTE_MEMSET = 0,     ///< Fill with a 32-bit pattern (see #rsp_compute_memset)
+    RSP_COMPUTE_MEMCPY,         ///< Copy (see #rsp_compute_memcpy)
+    RSP_COMPUTE_SAXPY,          ///< a*x+y on int16 arrays (see #rsp_compute_saxpy)
+    RSP_COMPUTE_TRANSFORM,      ///< Matrix transform of vectors (see #rsp_compute_transform)
+} rsp_compute_kernel_t;
+
+/**
+ * @brief A pair of homogeneous vectors in the format used by #rsp_compute_transform.
+ *
+ * Each component is a signed 16.16 fixed point number, split in its integer
+ * and fractional halves. Use #rsp_compute_pack_vec3 and #rsp_compute_unpack_vec4
+ * to convert from/to floating point.
+ */
+typedef struct {
+    int16_t integer[8];         ///< Integer parts (x0,y0,z0,w0,x1,y1,z1,w1)
+    uint16_t fraction[8];       ///< Fractional parts (x0,y0,z0,w0,x1,y1,z1,w1)
+} __attribute__((aligned(16))) rsp_compute_vec4x2_t;
+
+/**
+ * @brief Initialize the RSP compute module.
+ *
+ * This registers the overlay with the built-in kernels. It is not required
+ * to call this function to use #rsp_compute_dispatch with a custom overlay.
+ */
+void rsp_compute_init(void);
+
+/** @brief Deinitialize the RSP compute module */
+void rsp_compute_close(void);
+
+/**
+ * @brief Run a kernel of a compute overlay over an array.
+ *
+ * This function enqueues the execution of a kernel over @p nbytes bytes of
+ * data. The kernel can read up to two input arrays and write one output
+ * array, all of the same size. Data is processed in chunks of
+ * #COMPUTE_CHUNK_SIZE bytes.
+ *
+ * The function takes care of writing back the CPU cache for the inputs
+ * (and the parameters) and invalidating it for the output.
+ *
+ * @param ovl_id        Overlay ID of the compute overlay (as returned by
+ *                      #rspq_overlay_register)
+ * @param kernel        Index of the kernel in the overlay kernel table
+ * @param out           Output array
+ * @param in0           First input array (or NULL)
+ * @param in1           Second input array (or NULL)
+ * @param nbytes        Number of bytes to process (multiple of 16)
+ * @param arg           32-bit scalar argument, available to the kernel
+ *                      in COMPUTE_ARG
+ * @param params        Pointer to #COMPUTE_PARAMS_SIZE bytes of parameters,
+ *                      available to the kernel in COMPUTE_PARAMS (or NULL)
+ */
+void rsp_compute_dispatch(uint32_t ovl_id, int kernel, void *out, const void *in0,
+    const void *in1, int nbytes, uint32_t arg, const void *params);
+
+/**
+ * @brief Create a fence after the compute operations enqueued so far.
+ *
+ * @return A fence that can be waited with #rsp_compute_fence_wait
+ */
+inline rspq_syncpoint_t rsp_compute_fence(void)
+{
+    return rspq_syncpoint_new();
+}
+
+/**
+ * @brief Wait until all the compute operations enqueued before a fence are done.
+ *
+ * After this function returns, the output buffers of those operations can
+ * be accessed by the CPU.
+ *
+ * @param fence         Fence returned by #rsp_compute_fence
+ */
+inline void rsp_compute_fence_wait(rspq_syncpoint_t fence)
+{
+    rspq_syncpoint_wait(fence);
+}
+
+/**
+ * @brief Fill a buffer with a 32-bit pattern, using the RSP.
+ *
+ * @param dst           Destination buffer
+ * @param pattern       32-bit pattern to repeat
+ * @param nbytes        Number of bytes to fill (multiple of 16)
+ */
+void rsp_compute_memset(void *dst, uint32_t pattern, int nbytes);
+
+/**
+ * @brief Copy a buffer, using the RSP.
+ *
+ * @param dst           Destination buffer
+ * @param src           Source buffer
+ * @param nbytes        Number of bytes to copy (multiple of 16)
+ */
+void rsp_compute_memcpy(void *dst, const void *src, int nbytes);
+
+/**
+ * @brief Compute `out = a * x + y` over arrays of signed 16-bit integers.
+ *
+ * The result is saturated to the int16 range. @p a is converted to 16.16
+ * fixed point, so it must be in the range [-32768, 32768).
+ *
+ * @param out           Output array (can be the same as x or y)
+ * @param a             Scale factor
+ * @param x             First input array
+ * @param y             Second input array
+ * @param count         Number of elements (multiple of 8)
+ */
+void rsp_compute_saxpy(int16_t *out, float a, const int16_t *x, const int16_t *y, int count);
+
+/**
+ * @brief Transform an array of vectors by a matrix, using the RSP.
+ *
+ * This is the RSP counterpart of #fm_mat4_transform_vec3. Vectors must
+ * be packed in the fixed point format with #rsp_compute_pack_vec3, and the
+ * matrix converted with #fm_mat4_to_fixed.
+ *
+ * @param out           Output array (can be the same as in)
+ * @param mtx           Transformation matrix
+ * @param in            Input array
+ * @param count         Number of elements of the arrays (each element
+ *                      contains two vectors)
+ */
+void rsp_compute_transform(rsp_compute_vec4x2_t *out, const fm_mat4_fixed_t *mtx,
+    const rsp_compute_vec4x2_t *in, int count);
+
+/**
+ * @brief Convert 3D points into the format used by #rsp_compute_transform.
+ *
+ * The w component is set to 1. If the number of points is odd, the second
+ * vector of the last element is set to zero.
+ *
+ * @param out           Output array (must have room for (count+1)/2 elements)
+ * @param in            Input points
+ * @param count         Number of points
+ */
+void rsp_compute_pack_vec3(rsp_compute_vec4x2_t *out, const fm_vec3_t *in, int count);
+
+/**
+ * @brief Convert vectors from the format used by #rsp_compute_transform.
+ *
+ * @param out           Output vectors
+ * @param in            Input array
+ * @param count         Number of vectors
+ */
+void rsp_compute_unpack_vec4(fm_vec4_t *out, const rsp_compute_vec4x2_t *in, int count);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef __LIBDRAGON_RSP_COMPUTE_CONSTANTS_H
+#define __LIBDRAGON_RSP_COMPUTE_CONSTANTS_H
+
+/** @brief Size of each DMEM chunk processed by a compute kernel (double-buffered) */
+#define COMPUTE_CHUNK_SIZE      256
+
+/** @brief Size of the parameter block DMA'd into DMEM for each dispatch */
+#define COMPUTE_PARAMS_SIZE     64
+
+/** @brief Maximum number of bytes processed by a single RSP command (longer dispatches are split) */
+#define COMPUTE_MAX_CMD_SIZE    0x10000
+
+#endif
@@ -85,6 +85,7 @@ typedef struct sprite_detail_s
 
 #define SPRITE_FLAGS_TEXFORMAT      0x1F    ///< Pixel format of the sprite
 #define SPRITE_FLAGS_OWNEDBUFFER    0x20    ///< Flag specifying that the sprite buffer must be freed by sprite_free
+#define SPRITE_FLAGS_BLOCKCOMP      0x40    ///< RGBA16 images of the sprite are stored as 4x4 compressed blocks (mksprite --compress-blocks)
 #define SPRITE_FLAGS_EXT            0x80    ///< Sprite contains extended information (new format)
 
 
@@ -96,7 +97,8 @@ typedef struct sprite_detail_s
  * uncompressed format.
  * 
  * sprite_load internally uses the asset API (#asset_load), so the sprite file
- * is transparently uncompressed if needed.
+ * is transparently uncompressed if needed. If an arena is current (see
+ * #arena_set_current), the sprite is allocated from it.
  * 
  * @param fn           Filename of the sprite, including filesystem specifier.
  *                     For instance: "rom:/hero.sprite" to load from DFS.
@@ -144,6 +146,10 @@ inline tex_format_t sprite_get_format(sprite_t *sprite) {
  * Notice that no memory allocations or copies are performed:
  * the returned surface will point to the sprite contents.
  * 
+ * If the sprite was created with mksprite --compress-blocks, the surface has
+ * the #SURFACE_FLAGS_BLOCKCOMP flag set: its contents are compressed, and
+ * it can only be drawn via rdpq (eg: #rdpq_tex_upload or #rdpq_tex_blit).
+ * 
  * @param  sprite      The sprite
  * @return             The surface pointing to the sprite
  */
@@ -209,6 +215,61 @@ surface_t sprite_get_detail_pixels(sprite_t *sprite, sprite_detail_t *info, rdpq
  */
 surface_t sprite_get_tile(sprite_t *sprite, int h, int v);
 
+/**
+ * @brief Return the number of sub-images in a sprite generated as atlas sheet.
+ * 
+ * mksprite can pack multiple images into a single sprite (see the `--atlas`
+ * option), so that all of them share the same palette and can be drawn after
+ * a single upload to TMEM. The position of each image in the sheet is stored
+ * in the sprite, in the same order of the input files.
+ * 
+ * @param   sprite      The sprite
+ * @return              Number of sub-images, or 0 if the sprite is not an atlas
+ */
+int sprite_get_atlas_count(sprite_t *sprite);
+
+/**
+ * @brief Find a sub-image of an atlas sheet by name.
+ * 
+ * The name of each sub-image is the basename of the input file, without extension.
+ * 
+ * @param   sprite      The sprite used as atlas sheet
+ * @param   name        Name of the sub-image
+ * @return              Index of the sub-image, or -1 if not found
+ */
+int sprite_get_atlas_index(sprite_t *sprite, const char *name);
+
+/**
+ * @brief Get the position of a sub-image within an atlas sheet.
+ * 
+ * This is useful to draw multiple sub-images with a single upload: upload
+ * the whole sprite once (eg: via #rdpq_sprite_upload), and then draw each
+ * sub-image with #rdpq_texture_rectangle using the returned coordinates
+ * as texture offsets.
+ * 
+ * @param   sprite      The sprite used as atlas sheet
+ * @param   idx         Index of the sub-image
+ * @param   x           If not NULL, filled with the X coordinate in the sheet
+ * @param   y           If not NULL, filled with the Y coordinate in the sheet
+ * @param   width       If not NULL, filled with the width of the sub-image
+ * @param   height      If not NULL, filled with the height of the sub-image
+ * @return              true if the sub-image exists, false otherwise
+ */
+bool sprite_get_atlas_rect(sprite_t *sprite, int idx, int *x, int *y, int *width, int *height);
+
+/** 
+ * @brief Return a surface_t pointing to a sub-image of an atlas sheet.
+ * 
+ * This is the equivalent of #sprite_get_tile for sprites generated
+ * as atlas sheets, where sub-images can have different sizes.
+ * 
+ * @param   sprite      The sprite used as atlas sheet
+ * @param   idx         Index of the sub-image
+ * @return              A surface pointing to the sub-image (or an empty
+ *                      surface if the index is invalid)
+ */
+surface_t sprite_get_atlas_tile(sprite_t *sprite, int idx);
+
 /**
  * @brief Access the sprite palette (if any)
  * 
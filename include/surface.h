@@ -118,6 +118,7 @@ const char* tex_format_name(tex_format_t fmt);
 
 #define SURFACE_FLAGS_TEXFORMAT    0x001F   ///< Pixel format of the surface
 #define SURFACE_FLAGS_OWNEDBUFFER  0x0020   ///< Set if the buffer must be freed
+#define SURFACE_FLAGS_BLOCKCOMP    0x0040   ///< RGBA16 pixels are stored as 4x4 compressed blocks (see #rdpq_tex_upload)
 #define SURFACE_FLAGS_TEXINDEX     0x0F00   ///< Placeholder for rdpq lookup table
 
 /**
@@ -0,0 +1,142 @@
+/**
+ * @file uncached_pool.h
+ * @brief Pooled uncached memory allocator
+ * @ingroup uncached_pool
+ */
+#ifndef __LIBDRAGON_UNCACHED_POOL_H
+#define __LIBDRAGON_UNCACHED_POOL_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @addtogroup uncached_pool
+ * @{
+ */
+
+/** @brief Size of a slab of uncached memory carved by the pool (in bytes) */
+#define UNCACHED_POOL_SLAB_SIZE         (16*1024)
+
+/** @brief Largest allocation served from slabs; bigger ones go to the heap */
+#define UNCACHED_POOL_MAX_CLASS_SIZE    2048
+
+/** @brief An uncached memory pool (opaque) */
+typedef struct uncached_pool_s uncached_pool_t;
+
+/** @brief Statistics about a pool, see #uncached_pool_get_stats */
+typedef struct {
+    int num_slabs;          ///< Number of slabs currently owned by the pool
+    int num_allocs;         ///< Number of live allocations (slab and large)
+    size_t slab_bytes;      ///< Memory reserved by slabs
+    size_t large_bytes;     ///< Memory reserved by large allocations
+    size_t used_bytes;      ///< Memory handed out (rounded to the size class)
+    size_t peak_bytes;      ///< Maximum value ever reached by used_bytes
+} uncached_pool_stats_t;
+
+/**
+ * @brief Create a new uncached memory pool.
+ *
+ * The pool starts empty: slabs are allocated from the heap on demand, one
+ * size class at a time, and are never returned to the heap until the pool
+ * is destroyed with #uncached_pool_free.
+ *
+ * @return The new pool
+ */
+uncached_pool_t *uncached_pool_new(void);
+
+/**
+ * @brief Destroy a pool, releasing all its memory back to the heap.
+ *
+ * All buffers allocated from the pool become invalid. If the pool was
+ * installed as default with #uncached_pool_set_default, it is uninstalled.
+ *
+ * @param pool      Pool to destroy
+ */
+void uncached_pool_free(uncached_pool_t *pool);
+
+/**
+ * @brief Allocate an uncached buffer from a pool.
+ *
+ * Sizes up to #UNCACHED_POOL_MAX_CLASS_SIZE are rounded to a power-of-two size
+ * class and served in O(1) from the class freelist or from a slab. Buffers
+ * of 64 bytes or more are aligned to 64 bytes, smaller ones to 16 bytes.
+ * Bigger sizes are allocated from the heap and tracked by the pool.
+ *
+ * As with #malloc_uncached, the returned pointer is in the uncached segment
+ * and the buffer never shares a cacheline with other data.
+ *
+ * @param pool      Pool to allocate from
+ * @param size      Size of the buffer in bytes
+ * @return Pointer to the buffer (uncached segment), or NULL if out of memory
+ */
+void *uncached_pool_alloc(uncached_pool_t *pool, size_t size);
+
+/**
+ * @brief Allocate an uncached buffer from a pool, with a specific alignment.
+ *
+ * @param pool      Pool to allocate from
+ * @param align     Requested alignment in bytes (power of two)
+ * @param size      Size of the buffer in bytes
+ * @return Pointer to the buffer (uncached segment), or NULL if out of memory
+ *
+ * @see #uncached_pool_alloc
+ */
+void *uncached_pool_alloc_aligned(uncached_pool_t *pool, int align, size_t size);
+
+/**
+ * @brief Return a buffer to the pool it was allocated from.
+ *
+ * @param pool      Pool that owns the buffer
+ * @param ptr       Buffer to release (NULL is ignored)
+ */
+void uncached_pool_release(uncached_pool_t *pool, void *ptr);
+
+/**
+ * @brief Release all allocations of a pool at once.
+ *
+ * This is meant for per-level (or per-frame) arenas: all buffers become
+ * invalid, large allocations are returned to the heap, while slabs are kept
+ * and reused by the following allocations.
+ *
+ * @param pool      Pool to reset
+ */
+void uncached_pool_reset(uncached_pool_t *pool);
+
+/**
+ * @brief Fetch allocation statistics of a pool.
+ *
+ * @param pool      Pool to inspect
+ * @param stats     Filled with the current statistics
+ */
+void uncached_pool_get_stats(uncached_pool_t *pool, uncached_pool_stats_t *stats);
+
+/**
+ * @brief Route #malloc_uncached and #malloc_uncached_aligned through a pool.
+ *
+ * This is the opt-in for the library call sites that allocate uncached
+ * memory (rspq blocks, rdpq buffers, samplebuffers, surfaces, ...): while a
+ * default pool is installed, they are served by it. #free_uncached
+ * recognizes pool buffers and releases them to their pool, so buffers
+ * allocated before or after the pool was installed can be freed freely.
+ *
+ * @param pool      Pool to install, or NULL to go back to the plain heap
+ */
+void uncached_pool_set_default(uncached_pool_t *pool);
+
+/**
+ * @brief Return the pool currently installed by #uncached_pool_set_default
+ *
+ * @return The default pool, or NULL
+ */
+uncached_pool_t *uncached_pool_get_default(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -42,6 +42,15 @@ void gl_unbind_buffer(gl_buffer_object_t *obj, gl_buffer_object_t **binding)
     }
 }
 
+void gl_buffer_free_converted(gl_buffer_object_t *obj)
+{
+    if (obj->converted != NULL) {
+        free(obj->converted);
+        obj->converted = NULL;
+        obj->converted_count = 0;
+    }
+}
+
 void glDeleteBuffersARB(GLsizei n, const GLuint *buffers)
 {
     if (!gl_ensure_no_immediate()) return;
@@ -73,6 +82,8 @@ void glDeleteBuffersARB(GLsizei n, const GLuint *buffers)
 
         // TODO: keep alive until no longer in use
 
+        gl_buffer_free_converted(obj);
+
         if (obj->storage.data != NULL)
         {
             free_uncached(obj->storage.data);
@@ -136,6 +147,7 @@ void glBufferDataARB(GLenum target, GLsizeiptrARB size, const GLvoid *data, GLen
     case GL_DYNAMIC_DRAW_ARB:
     case GL_DYNAMIC_READ_ARB:
     case GL_DYNAMIC_COPY_ARB:
+    case GL_STATIC_DRAW_PRECONVERTED_N64:
         break;
     default:
         gl_set_error(GL_INVALID_ENUM, "%#04lx is not a valid buffer usage", usage);
@@ -152,6 +164,8 @@ void glBufferDataARB(GLenum target, GLsizeiptrARB size, const GLvoid *data, GLen
         return;
     }
 
+    gl_buffer_free_converted(obj);
+
     if (data != NULL) {
         memcpy(obj->storage.data, data, size);
     }
@@ -186,6 +200,7 @@ void glBufferSubDataARB(GLenum target, GLintptrARB offset, GLsizeiptrARB size, c
         return;
     }
 
+    gl_buffer_free_converted(obj);
     memcpy(obj->storage.data + offset, data, size);
 }
 
@@ -240,6 +255,10 @@ GLvoid * glMapBufferARB(GLenum target, GLenum access)
         return NULL;
     }
 
+    if (access != GL_READ_ONLY_ARB) {
+        gl_buffer_free_converted(obj);
+    }
+
     obj->access = access;
     obj->mapped = true;
     obj->pointer = obj->storage.data;
@@ -3,12 +3,13 @@
 
 extern gl_state_t state;
 
+// The W coefficient of the X and Y planes is multiplied by the guard band factor
 static const float clip_planes[CLIPPING_PLANE_COUNT][4] = {
-    { 1, 0, 0, GUARD_BAND_FACTOR },
-    { 0, 1, 0, GUARD_BAND_FACTOR },
+    { 1, 0, 0, 1 },
+    { 0, 1, 0, 1 },
     { 0, 0, 1, 1 },
-    { 1, 0, 0, -GUARD_BAND_FACTOR },
-    { 0, 1, 0, -GUARD_BAND_FACTOR },
+    { 1, 0, 0, -1 },
+    { 0, 1, 0, -1 },
     { 0, 0, 1, -1 },
 };
 
@@ -305,8 +306,8 @@ static void gl_calc_texture_coords(GLfloat *dest, const GLfloat *input, const GL
 static void gl_vertex_calc_clip_code(gl_vtx_t *v)
 {
     GLfloat clip_ref[] = { 
-        v->cs_pos[3] * GUARD_BAND_FACTOR,
-        v->cs_pos[3] * GUARD_BAND_FACTOR,
+        v->cs_pos[3] * state.current_viewport.guard_band,
+        v->cs_pos[3] * state.current_viewport.guard_band,
         v->cs_pos[3]
     };
 
@@ -560,8 +561,12 @@ static void gl_cull_triangle(gl_vtx_t *v0, gl_vtx_t *v1, gl_vtx_t *v2)
     }
 }
 
-static void gl_intersect_line_plane(gl_vtx_t *intersection, const gl_vtx_t *p0, const gl_vtx_t *p1, const float *clip_plane)
+static void gl_intersect_line_plane(gl_vtx_t *intersection, const gl_vtx_t *p0, const gl_vtx_t *p1, uint32_t plane_index)
 {
+    const float *p = clip_planes[plane_index];
+    bool is_guard_band = (plane_index % 3) != 2;
+    const float clip_plane[4] = { p[0], p[1], p[2], is_guard_band ? p[3] * state.current_viewport.guard_band : p[3] };
+
     float d0 = dot_product4(p0->cs_pos, clip_plane);
     float d1 = dot_product4(p1->cs_pos, clip_plane);
     
@@ -627,8 +632,6 @@ static void gl_clip_triangle()
             continue;
         }
 
-        const float *clip_plane = clip_planes[c];
-
         SWAP(in_list, out_list);
         out_list->count = 0;
 
@@ -665,7 +668,7 @@ static void gl_clip_triangle()
                     SWAP(p0, p1);
                 }
 
-                gl_intersect_line_plane(intersection, p0, p1, clip_plane);
+                gl_intersect_line_plane(intersection, p0, p1, c);
 
                 out_list->vertices[out_list->count] = intersection;
                 out_list->count++;
@@ -720,7 +723,7 @@ static void gl_clip_line()
             }
 
             gl_vtx_t *intersection = &vertex_cache[v0_inside ? 1 : 0];
-            gl_intersect_line_plane(intersection, v0, v1, clip_planes[c]);
+            gl_intersect_line_plane(intersection, v0, v1, c);
 
             if (v0_inside) {
                 v1 = intersection;
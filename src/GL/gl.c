@@ -74,6 +74,12 @@ void gl_init()
     server_state->line_width = 1 << 2;
     server_state->polygon_mode = GL_FILL;
 
+    server_state->guard_band[0] = 1;
+    server_state->guard_band[1] = 1;
+    server_state->guard_band[2] = GUARD_BAND_FACTOR;
+    server_state->guard_band[3] = GUARD_BAND_FACTOR;
+    state.current_viewport.guard_band = GUARD_BAND_FACTOR;
+
     server_state->tex_gen.mode[0] = GL_EYE_LINEAR;
     server_state->tex_gen.mode[1] = GL_EYE_LINEAR;
     server_state->tex_gen.mode[2] = GL_EYE_LINEAR;
@@ -176,6 +182,22 @@ void gl_reset_uploaded_texture()
     gl_set_word(GL_UPDATE_NONE, offsetof(gl_server_state_t, uploaded_tex), 0);
 }
 
+/**
+ * @brief Forget the textures resident in TMEM if rdpq loaded something else into it
+ * 
+ * Plain rdpq calls issued within the GL context (eg: #rdpq_tex_upload, sprite blits,
+ * text rendering) overwrite TMEM without GL knowing. rdpq tracks TMEM writes, so this
+ * is checked before each primitive and before running a display list.
+ */
+void gl_check_tmem_changed()
+{
+    if (rdpq_tracking.tmem_changed == 2) {
+        gl_reset_uploaded_texture();
+        state.texture2_dirty = true;
+    }
+    __rdpq_tmem_acknowledge();
+}
+
 void gl_context_begin()
 {
     const surface_t *old_color_buffer = state.color_buffer;
@@ -194,6 +216,12 @@ void gl_context_begin()
     }
 
     gl_reset_uploaded_texture();
+    state.texture2_dirty = true;
+    __rdpq_tmem_acknowledge();
+
+    // Reset the per-frame texture load statistics
+    gl_set_word(GL_UPDATE_NONE, offsetof(gl_server_state_t, tex_loads), 0);
+    gl_set_word(GL_UPDATE_NONE, offsetof(gl_server_state_t, tex_load_bytes), 0);
 }
 
 void gl_context_end()
@@ -221,6 +249,7 @@ void gl_set_flag2(GLenum target, bool value)
     case GL_RDPQ_TEXTURING_N64:
         gl_set_flag_word2(GL_UPDATE_NONE, FLAG2_USE_RDPQ_TEXTURING, value);
         gl_reset_uploaded_texture();
+        state.texture2_dirty = true;
         break;
     case GL_SCISSOR_TEST:
         gl_set_flag(GL_UPDATE_SCISSOR, FLAG_SCISSOR_TEST, value);
@@ -231,6 +260,7 @@ void gl_set_flag2(GLenum target, bool value)
         break;
     case GL_BLEND:
         gl_set_flag(GL_UPDATE_NONE, FLAG_BLEND, value);
+        state.blend = value;
         break;
     case GL_ALPHA_TEST:
         gl_set_flag(GL_UPDATE_NONE, FLAG_ALPHA_TEST, value);
@@ -105,12 +105,16 @@
 #define FLAG2_USE_RDPQ_MATERIAL  (1 << 0)
 #define FLAG2_USE_RDPQ_TEXTURING (1 << 1)
 #define FLAG2_REDUCED_ALIASING   (1 << 2)
+#define FLAG2_TEXTURE2           (1 << 3)
 
 #define TEX_FLAG_COMPLETE       (1 << 0)
 #define TEX_FLAG_UPLOAD_DIRTY   (1 << 1)
 #define TEX_FLAG_FORCE_COMPLETE (1 << 2)
 #define TEX_FLAG_DETAIL         (1 << 3)
 
+// Bits 16..31 of the texture flags contain the number of TMEM bytes loaded by the upload block
+#define TEX_FLAG_LOAD_BYTES_SHIFT 16
+
 #define DITHER_MASK         (SOM_RGBDITHER_MASK | SOM_ALPHADITHER_MASK)
 #define BLEND_MASK          SOM_ZMODE_MASK
 #define DEPTH_TEST_MASK     SOM_Z_COMPARE
@@ -120,7 +124,12 @@
 
 #define LOAD_TILE 7
 
-#define GUARD_BAND_FACTOR 4
+/** @brief Guard band used until a viewport is set */
+#define GUARD_BAND_FACTOR           4
+/** @brief Largest guard band: X and Y in clip space are compared with w multiplied by it, as 16-bit integers */
+#define GUARD_BAND_MAX_FACTOR       8
+/** @brief Largest screen coordinate (in pixels) that a vertex within the guard band can have */
+#define GUARD_BAND_SCREEN_LIMIT     2047
 
 #define ASSERT_INVALID_VTX_ID   0x2001
 
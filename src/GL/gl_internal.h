@@ -11,6 +11,7 @@
 #include "gl_constants.h"
 #include "rspq.h"
 #include "rdpq.h"
+#include "rdpq_tex.h"
 #include "../rdpq/rdpq_internal.h"
 #include "rdpq_tri.h"
 
@@ -159,6 +160,7 @@ typedef struct {
 typedef struct {
     GLfloat scale[3];
     GLfloat offset[3];
+    GLint guard_band;
 } gl_viewport_t;
 
 typedef struct {
@@ -223,6 +225,10 @@ typedef struct {
     surface_t surfaces[MAX_TEXTURE_LEVELS];
     rspq_block_t *blocks[MAX_TEXTURE_LEVELS];
 
+    uint16_t load_bytes[MAX_TEXTURE_LEVELS];
+    uint16_t tmem_bytes[MAX_TEXTURE_LEVELS];    // Bytes used in the lower half of TMEM
+    GLclampf priority;
+
     gl_srv_texture_object_t *srv_object;
 } gl_texture_object_t;
 
@@ -273,12 +279,31 @@ typedef struct {
     uint32_t size;
 } gl_storage_t;
 
+typedef struct {
+    uint32_t offset;
+    GLenum type;
+    uint16_t stride;
+    uint8_t size;
+    bool enabled;
+} gl_vtx_layout_attrib_t;
+
+typedef struct {
+    gl_vtx_layout_attrib_t attribs[ATTRIB_COUNT];
+    int8_t vertex_shift;
+    int8_t texcoord_shift;
+} gl_vtx_layout_t;
+
 typedef struct {
     GLenum usage;
     GLenum access;
     GLvoid *pointer;
     gl_storage_t storage;
     bool mapped;
+
+    uint32_t *converted;
+    uint32_t converted_count;
+    uint32_t converted_words;
+    gl_vtx_layout_t converted_layout;
 } gl_buffer_object_t;
 
 typedef struct {
@@ -364,6 +389,19 @@ typedef struct {
     GLfloat to_float_factor;
 } gl_fixed_precision_t;
 
+/** @brief A display list call recorded by the draw queue, with the state it depends on */
+typedef struct {
+    rspq_block_t *block;
+    gl_matrix_t modelview;
+    gl_texture_object_t *texture;
+    GLenum cull_face_mode;
+    float depth;
+    uint32_t order;
+    uint32_t layer;
+    bool cull_face;
+    bool blend;
+} gl_queued_draw_t;
+
 typedef struct {
     // Pipeline state
 
@@ -371,6 +409,7 @@ typedef struct {
     bool texture_1d;
     bool texture_2d;
     bool depth_test;
+    bool blend;
     bool lighting;
     bool fog;
     bool color_material;
@@ -428,6 +467,14 @@ typedef struct {
     gl_texture_object_t *texture_1d_object;
     gl_texture_object_t *texture_2d_object;
 
+    gl_texture_object_t *texture2_object;
+    rspq_block_t *texture2_block;
+    surface_t texture2_surface;
+    rdpq_texparms_t texture2_parms;
+    GLenum texture2_mode;
+    GLenum tex_env_mode;
+    bool texture2_dirty;
+
     gl_obj_attributes_t current_attributes;
 
     uint8_t prim_size;
@@ -474,6 +521,12 @@ typedef struct {
     GLuint list_base;
     GLuint current_list;
 
+    bool draw_queue_active;
+    gl_queued_draw_t *draw_queue;
+    uint32_t draw_queue_count;
+    uint32_t draw_queue_capacity;
+    GLint draw_queue_stats[3];
+
     gl_buffer_object_t *array_buffer;
     gl_buffer_object_t *element_array_buffer;
 
@@ -537,6 +590,7 @@ typedef struct {
     uint16_t matrix_mode;
     uint16_t tri_cmd;
     uint8_t tri_cull[2];
+    uint16_t guard_band[4];
 
     gl_srv_texture_object_t bound_textures[2];
     uint16_t scissor_rect[4];
@@ -545,6 +599,9 @@ typedef struct {
     uint32_t flags2;
     uint32_t texture_ids[2];
     uint32_t uploaded_tex;
+    uint32_t tex_loads;
+    uint32_t tex_load_bytes;
+    uint32_t tex2_combiner[2];
     uint32_t clear_color;
     uint32_t clear_depth;
     uint32_t palette_ptr;
@@ -584,6 +641,10 @@ void gl_matrix_mult4x2(GLfloat *d, const gl_matrix_t *m, const GLfloat *v);
 void gl_perform_lighting(GLfloat *color, const GLfloat *input, const GLfloat *v, const GLfloat *n, const gl_material_t *material);
 
 gl_texture_object_t * gl_get_active_texture();
+void gl_texture_get_load_stats(uint32_t *stats);
+void gl_update_texture2_combiner();
+void gl_texture2_load();
+void gl_check_tmem_changed();
 
 void gl_cross(GLfloat* p, const GLfloat* a, const GLfloat* b);
 float dot_product3(const float *a, const float *b);
@@ -595,6 +656,8 @@ bool gl_storage_alloc(gl_storage_t *storage, uint32_t size);
 void gl_storage_free(gl_storage_t *storage);
 bool gl_storage_resize(gl_storage_t *storage, uint32_t new_size);
 
+void gl_buffer_free_converted(gl_buffer_object_t *obj);
+
 void set_can_use_rsp_dirty();
 
 void gl_update_array_pointers(gl_array_object_t *obj);
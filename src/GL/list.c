@@ -1,8 +1,17 @@
 #include "gl_internal.h"
 #include "rspq.h"
+#include <stdlib.h>
+#include <string.h>
 
 #define EMPTY_LIST ((rspq_block_t*)1)
 
+/**
+ * Opaque draws in the draw queue are split into this many layers by distance.
+ * Layers are drawn front to back, and draws are sorted by state within each layer:
+ * this is a compromise between reducing overdraw and reducing state changes.
+ */
+#define DRAW_QUEUE_DEPTH_LAYERS     4
+
 extern gl_state_t state;
 
 typedef GLuint (*read_list_id_func)(const GLvoid*, GLsizei);
@@ -34,6 +43,10 @@ void gl_list_close()
     }
 
     obj_map_free(&state.list_objects);
+
+    free(state.draw_queue);
+    state.draw_queue = NULL;
+    state.draw_queue_capacity = 0;
 }
 
 void glNewList(GLuint n, GLenum mode)
@@ -61,6 +74,11 @@ void glNewList(GLuint n, GLenum mode)
         return;
     }
 
+    if (state.draw_queue_active) {
+        gl_set_error(GL_INVALID_OPERATION, "Display lists cannot be recorded while a draw queue is active");
+        return;
+    }
+
     state.current_list = n;
 
     rspq_block_begin();
@@ -83,6 +101,179 @@ void glEndList(void)
     state.current_list = 0;
 }
 
+/** @brief Take a snapshot of the state that is restored for each queued draw */
+static void gl_draw_queue_snapshot(gl_queued_draw_t *draw)
+{
+    draw->modelview = *gl_matrix_stack_get_matrix(&state.modelview_stack);
+    draw->texture = state.texture_2d ? state.texture_2d_object : NULL;
+    draw->cull_face = state.cull_face;
+    draw->cull_face_mode = state.cull_face_mode;
+    draw->blend = state.blend;
+}
+
+static void gl_draw_queue_push(rspq_block_t *block)
+{
+    if (state.draw_queue_count == state.draw_queue_capacity) {
+        state.draw_queue_capacity = MAX(state.draw_queue_capacity * 2, 32);
+        state.draw_queue = realloc(state.draw_queue, state.draw_queue_capacity * sizeof(gl_queued_draw_t));
+    }
+
+    gl_queued_draw_t *draw = &state.draw_queue[state.draw_queue_count];
+    gl_draw_queue_snapshot(draw);
+    draw->block = block;
+    draw->order = state.draw_queue_count++;
+    // Distance of the origin of the object from the camera (which looks towards -Z)
+    draw->depth = -draw->modelview.m[3][2];
+}
+
+static int gl_queued_draw_compare(const void *a, const void *b)
+{
+    const gl_queued_draw_t *da = a, *db = b;
+
+    // Transparent draws go after all opaque draws, back to front
+    if (da->blend != db->blend) return da->blend ? 1 : -1;
+    if (da->blend) {
+        if (da->depth != db->depth) return da->depth > db->depth ? -1 : 1;
+        return da->order < db->order ? -1 : 1;
+    }
+
+    // Opaque draws are sorted by layer (front to back), then by state, then front to back
+    if (da->layer != db->layer) return da->layer < db->layer ? -1 : 1;
+    if (da->texture != db->texture) {
+        // Textures with higher priority go last, so that they remain resident in TMEM
+        // after the queue (see glPrioritizeTextures)
+        if (da->texture && db->texture && da->texture->priority != db->texture->priority)
+            return da->texture->priority < db->texture->priority ? -1 : 1;
+        return (uintptr_t)da->texture < (uintptr_t)db->texture ? -1 : 1;
+    }
+    if (da->cull_face != db->cull_face) return da->cull_face ? 1 : -1;
+    if (da->cull_face_mode != db->cull_face_mode) return da->cull_face_mode < db->cull_face_mode ? -1 : 1;
+    if (da->depth != db->depth) return da->depth < db->depth ? -1 : 1;
+    return da->order < db->order ? -1 : 1;
+}
+
+/** @brief Apply the state of a queued draw, and return the number of state changes */
+static int gl_draw_queue_apply(const gl_queued_draw_t *prev, const gl_queued_draw_t *next, bool dry_run)
+{
+    int changes = 0;
+
+    if (next->texture != prev->texture) {
+        if (!dry_run) {
+            if ((next->texture != NULL) != (prev->texture != NULL))
+                (next->texture ? glEnable : glDisable)(GL_TEXTURE_2D);
+            if (next->texture)
+                glBindTexture(GL_TEXTURE_2D, next->texture == &state.default_textures[1] ? 0 : (GLuint)next->texture);
+        }
+        changes++;
+    }
+
+    if (next->cull_face != prev->cull_face) {
+        if (!dry_run) (next->cull_face ? glEnable : glDisable)(GL_CULL_FACE);
+        changes++;
+    }
+
+    if (next->cull_face && next->cull_face_mode != prev->cull_face_mode) {
+        if (!dry_run) glCullFace(next->cull_face_mode);
+        changes++;
+    }
+
+    if (next->blend != prev->blend) {
+        if (!dry_run) (next->blend ? glEnable : glDisable)(GL_BLEND);
+        changes++;
+    }
+
+    return changes;
+}
+
+void glBeginDrawQueueN64(void)
+{
+    if (!gl_ensure_no_immediate()) return;
+
+    if (state.current_list != 0) {
+        gl_set_error(GL_INVALID_OPERATION, "A draw queue cannot be started while recording a display list");
+        return;
+    }
+
+    if (state.draw_queue_active) {
+        gl_set_error(GL_INVALID_OPERATION, "A draw queue is already active");
+        return;
+    }
+
+    state.draw_queue_active = true;
+    state.draw_queue_count = 0;
+}
+
+void glEndDrawQueueN64(void)
+{
+    if (!gl_ensure_no_immediate()) return;
+
+    if (!state.draw_queue_active) {
+        gl_set_error(GL_INVALID_OPERATION, "No draw queue is active");
+        return;
+    }
+
+    state.draw_queue_active = false;
+
+    gl_queued_draw_t *draws = state.draw_queue;
+    uint32_t count = state.draw_queue_count;
+
+    // Save the current state, so that it can be restored after the queue is submitted
+    gl_queued_draw_t saved;
+    gl_draw_queue_snapshot(&saved);
+    gl_texture_object_t *saved_texture = state.texture_2d_object;
+    GLenum saved_matrix_mode = state.matrix_mode;
+
+    // Number of state changes if the draws were submitted in API order
+    int unsorted_changes = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        unsorted_changes += gl_draw_queue_apply(i > 0 ? &draws[i-1] : &saved, &draws[i], true);
+    }
+
+    // Assign opaque draws to the depth layers, spread over their range of distances
+    float min_depth = INFINITY, max_depth = -INFINITY;
+    for (uint32_t i = 0; i < count; i++) {
+        if (draws[i].blend) continue;
+        min_depth = MIN(min_depth, draws[i].depth);
+        max_depth = MAX(max_depth, draws[i].depth);
+    }
+    float layer_scale = max_depth > min_depth ? DRAW_QUEUE_DEPTH_LAYERS / (max_depth - min_depth) : 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (draws[i].blend) continue;
+        draws[i].layer = MIN((uint32_t)((draws[i].depth - min_depth) * layer_scale), DRAW_QUEUE_DEPTH_LAYERS - 1);
+    }
+
+    qsort(draws, count, sizeof(gl_queued_draw_t), gl_queued_draw_compare);
+
+    if (saved_matrix_mode != GL_MODELVIEW) glMatrixMode(GL_MODELVIEW);
+
+    gl_check_tmem_changed();
+
+    int changes = 0;
+    const gl_queued_draw_t *prev = &saved;
+    for (uint32_t i = 0; i < count; i++) {
+        changes += gl_draw_queue_apply(prev, &draws[i], false);
+        if (memcmp(&draws[i].modelview, &prev->modelview, sizeof(gl_matrix_t)) != 0) {
+            glLoadMatrixf(draws[i].modelview.m[0]);
+        }
+        rspq_block_run(draws[i].block);
+        prev = &draws[i];
+    }
+
+    // Restore the state
+    gl_draw_queue_apply(prev, &saved, false);
+    if (state.texture_2d_object != saved_texture) {
+        glBindTexture(GL_TEXTURE_2D, saved_texture == &state.default_textures[1] ? 0 : (GLuint)saved_texture);
+    }
+    if (memcmp(&saved.modelview, &prev->modelview, sizeof(gl_matrix_t)) != 0) {
+        glLoadMatrixf(saved.modelview.m[0]);
+    }
+    if (saved_matrix_mode != GL_MODELVIEW) glMatrixMode(saved_matrix_mode);
+
+    state.draw_queue_stats[0] = count;
+    state.draw_queue_stats[1] = changes;
+    state.draw_queue_stats[2] = unsorted_changes;
+}
+
 void glCallList(GLuint n)
 {
     // The spec allows glCallList in immediate mode, but our current architecture doesn't allow for this.
@@ -91,9 +282,16 @@ void glCallList(GLuint n)
 
     rspq_block_t *block = obj_map_get(&state.list_objects, n);
     // Silently ignore NULL and EMPTY_LIST
-    if (is_non_empty_list(block)) {
-        rspq_block_run(block);
+    if (!is_non_empty_list(block)) return;
+
+    if (state.draw_queue_active) {
+        gl_draw_queue_push(block);
+        return;
     }
+
+    // Primitives in the list do not know what was loaded in TMEM before it runs
+    gl_check_tmem_changed();
+    rspq_block_run(block);
 }
 
 GLuint gl_get_list_name_byte(const GLvoid *lists, GLsizei n)
@@ -1,6 +1,9 @@
 #include "gl_internal.h"
+#include "fgeom.h"
 #include <string.h>
 
+_Static_assert(sizeof(gl_matrix_t) == sizeof(fm_mat4_t), "gl_matrix_t must match fm_mat4_t");
+
 extern gl_state_t state;
 
 void gl_matrix_init()
@@ -80,10 +83,7 @@ void gl_matrix_mult4x2(GLfloat *d, const gl_matrix_t *m, const GLfloat *v)
 
 void gl_matrix_mult_full(gl_matrix_t *d, const gl_matrix_t *l, const gl_matrix_t *r)
 {
-    gl_matrix_mult(d->m[0], l, r->m[0]);
-    gl_matrix_mult(d->m[1], l, r->m[1]);
-    gl_matrix_mult(d->m[2], l, r->m[2]);
-    gl_matrix_mult(d->m[3], l, r->m[3]);
+    fm_mat4_mul((fm_mat4_t*)d, (const fm_mat4_t*)l, (const fm_mat4_t*)r);
 }
 
 void gl_update_matrix_target(gl_matrix_target_t *target)
@@ -165,29 +165,16 @@ void glCurrentPaletteMatrixARB(GLint index)
     gl_set_palette_ptr(state.matrix_palette + index);
 }
 
-static inline void write_shorts(rspq_write_t *w, const uint16_t *s, uint32_t count)
-{
-    for (uint32_t i = 0; i < count; i += 2)
-    {
-        uint32_t packed = ((uint32_t)s[i] << 16) | (uint32_t)s[i+1];
-        rspq_write_arg(w, packed);
-    }
-}
-
 static inline void gl_matrix_write(rspq_write_t *w, const GLfloat *m)
 {
-    uint16_t integer[16];
-    uint16_t fraction[16];
-
-    for (uint32_t i = 0; i < 16; i++)
-    {
-        int32_t fixed = m[i] * (1<<16);
-        integer[i] = (uint16_t)((fixed & 0xFFFF0000) >> 16);
-        fraction[i] = (uint16_t)(fixed & 0x0000FFFF);
-    }
-
-    write_shorts(w, integer, 16);
-    write_shorts(w, fraction, 16);
+    // The fixed point layout (all integer parts, then all fractional parts)
+    // is exactly what the ucode expects, so it can be written as-is.
+    fm_mat4_fixed_t fixed;
+    fm_mat4_to_fixed(&fixed, (const fm_mat4_t*)m);
+
+    const uint32_t *words = (const uint32_t*)&fixed;
+    for (uint32_t i = 0; i < sizeof(fixed) / 4; i++)
+        rspq_write_arg(w, words[i]);
 }
 
 static inline void gl_matrix_load(const GLfloat *m, bool multiply)
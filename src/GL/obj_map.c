@@ -1,6 +1,16 @@
 /**
- * This is a very simple hash map that uses open adressing (linear probing).
- * The hash function is the identity for now, since it uses integer keys.
+ * This is a hash map with integer keys, optimized for GL object names.
+ *
+ * GL names are usually allocated sequentially starting from 1, so small keys
+ * are stored in a dense array indexed directly by the key. The array grows
+ * (up to OBJ_MAP_DENSE_MAX_CAPACITY) as long as it stays at least 1/4 full.
+ *
+ * All other keys go into a hash table with open addressing, using Robin Hood
+ * linear probing: on insertion, an entry that is closer to its home slot gives
+ * its place to the one being inserted, which keeps probe sequences short and
+ * allows lookups of missing keys to stop early. Removal shifts the following
+ * entries back, so there are no tombstones that would slow down lookups after
+ * many deletions.
  */
 
 #include "obj_map.h"
@@ -8,16 +18,31 @@
 #include <malloc.h>
 #include <debug.h>
 #include <stdlib.h>
+#include <string.h>
 
-#define OBJ_MAP_MIN_CAPACITY     32
-#define OBJ_MAP_DELETED_KEY      0xFFFFFFFF
+#define OBJ_MAP_MIN_CAPACITY            32
+#define OBJ_MAP_DENSE_MAX_CAPACITY      (1 << 16)
+
+static inline uint32_t obj_map_home(const obj_map_t *map, uint32_t key)
+{
+    // Fibonacci hashing: the top bits of the product are well mixed even for strided keys
+    return (key * 2654435769u) >> (__builtin_clz(map->capacity) + 1);
+}
+
+static inline uint32_t obj_map_probe_distance(const obj_map_t *map, uint32_t key, uint32_t index)
+{
+    return (index - obj_map_home(map, key)) & (map->capacity - 1);
+}
 
 void obj_map_new(obj_map_t *map)
 {
     assertf(map->entries == NULL, "Map has not been freed!");
 
+    map->dense = calloc(OBJ_MAP_MIN_CAPACITY, sizeof(void*));
+    map->dense_capacity = OBJ_MAP_MIN_CAPACITY;
     map->entries = calloc(OBJ_MAP_MIN_CAPACITY, sizeof(obj_map_entry_t));
     map->capacity = OBJ_MAP_MIN_CAPACITY;
+    map->sparse_count = 0;
     map->count = 0;
 }
 
@@ -25,84 +50,144 @@ void obj_map_free(obj_map_t *map)
 {
     assertf(map->entries != NULL, "Map is not initialized!");
 
+    free(map->dense);
+    map->dense = NULL;
     free(map->entries);
     map->entries = NULL;
 }
 
-obj_map_entry_t * obj_map_find_entry(const obj_map_t *map, uint32_t key)
+static obj_map_entry_t * obj_map_find_entry(const obj_map_t *map, uint32_t key)
 {
-    uint32_t mask = (map->capacity - 1);
+    uint32_t mask = map->capacity - 1;
+    uint32_t index = obj_map_home(map, key);
 
-    for (uint32_t i = 0; i < map->capacity; i++) {
-        obj_map_entry_t *entry = &map->entries[(key + i) & mask];
+    for (uint32_t dist = 0; dist < map->capacity; dist++) {
+        obj_map_entry_t *entry = &map->entries[index];
+
+        if (entry->value == NULL) {
+            return NULL;
+        }
 
         if (entry->key == key) {
             return entry;
         }
 
-        if (entry->value == NULL && entry->key != OBJ_MAP_DELETED_KEY) {
-            // Stop probing when unused entry is found.
-            // However, keep searching if the entry has been deleted
-            break;
+        if (obj_map_probe_distance(map, entry->key, index) < dist) {
+            // The key would have displaced this entry if it was present
+            return NULL;
         }
+
+        index = (index + 1) & mask;
     }
 
     return NULL;
 }
 
-void * obj_map_set_without_expanding(obj_map_t *map, uint32_t key, void *value)
+static void * obj_map_sparse_set(obj_map_t *map, uint32_t key, void *value)
 {
-    uint32_t mask = (map->capacity - 1);
+    uint32_t mask = map->capacity - 1;
+    uint32_t index = obj_map_home(map, key);
+    obj_map_entry_t cur = { .key = key, .value = value };
 
-    for (uint32_t i = 0; i < map->capacity; i++) {
-        obj_map_entry_t *e = &map->entries[(key + i) & mask];
+    for (uint32_t dist = 0; dist < map->capacity; dist++) {
+        obj_map_entry_t *e = &map->entries[index];
 
         if (e->value == NULL) {
-            // Entry is unused or has been deleted
-            // -> New entry is added
-            e->key = key;
-            e->value = value;
-            map->count++;
+            // Unused entry -> New entry is added
+            *e = cur;
+            map->sparse_count++;
             return NULL;
         }
 
-        if (e->key == key) {
-            // Key is already present
+        if (e->key == cur.key) {
+            // Key is already present (this cannot happen anymore after the first swap)
             // -> Value is changed, but no new entry is added
             void *old_value = e->value;
-            e->value = value;
+            e->value = cur.value;
             return old_value;
         }
+
+        uint32_t e_dist = obj_map_probe_distance(map, e->key, index);
+        if (e_dist < dist) {
+            // Take the place of the entry closer to its home, and continue inserting that one
+            obj_map_entry_t tmp = *e;
+            *e = cur;
+            cur = tmp;
+            dist = e_dist;
+        }
+
+        index = (index + 1) & mask;
     }
 
     assertf(0, "Map is full!");
     abort();
 }
 
-void obj_map_expand(obj_map_t *map)
+static void obj_map_sparse_remove_at(obj_map_t *map, obj_map_entry_t *entry)
+{
+    uint32_t mask = map->capacity - 1;
+    uint32_t index = entry - map->entries;
+
+    // Shift back the following entries, until one that is already in its home slot
+    for (;;) {
+        uint32_t next = (index + 1) & mask;
+        obj_map_entry_t *n = &map->entries[next];
+        if (n->value == NULL || obj_map_probe_distance(map, n->key, next) == 0) {
+            break;
+        }
+        map->entries[index] = *n;
+        index = next;
+    }
+
+    map->entries[index].value = NULL;
+    map->sparse_count--;
+}
+
+static void obj_map_sparse_expand(obj_map_t *map)
 {
     obj_map_entry_t *old_entries = map->entries;
     uint32_t old_capacity = map->capacity;
 
     map->capacity = old_capacity << 1;
     map->entries = calloc(map->capacity, sizeof(obj_map_entry_t));
-    map->count = 0;
+    map->sparse_count = 0;
 
     // Re-populate the map with all used entries
     for (uint32_t i = 0; i < old_capacity; i++) {
         obj_map_entry_t *entry = &old_entries[i];
         if (entry->value != NULL) {
-            obj_map_set_without_expanding(map, entry->key, entry->value);
+            obj_map_sparse_set(map, entry->key, entry->value);
         }
     }
 
     free(old_entries);
 }
 
+static void obj_map_dense_expand(obj_map_t *map, uint32_t new_capacity)
+{
+    map->dense = realloc(map->dense, new_capacity * sizeof(void*));
+    memset(map->dense + map->dense_capacity, 0, (new_capacity - map->dense_capacity) * sizeof(void*));
+    map->dense_capacity = new_capacity;
+
+    // Move the keys that now fall in the dense range out of the hash table
+    for (uint32_t i = 0; i < map->capacity; i++) {
+        obj_map_entry_t *entry = &map->entries[i];
+        while (entry->value != NULL && entry->key < new_capacity) {
+            map->dense[entry->key] = entry->value;
+            // This shifts the next entry into the current slot, so check it again
+            obj_map_sparse_remove_at(map, entry);
+        }
+    }
+}
+
 void * obj_map_get(const obj_map_t *map, uint32_t key)
 {
     assertf(map->entries != NULL, "Map is not initialized!");
 
+    if (key < map->dense_capacity) {
+        return map->dense[key];
+    }
+
     obj_map_entry_t *entry = obj_map_find_entry(map, key);
     return entry == NULL ? NULL : entry->value;
 }
@@ -112,25 +197,51 @@ void * obj_map_set(obj_map_t *map, uint32_t key, void *value)
     assertf(map->entries != NULL, "Map is not initialized!");
     assertf(value != NULL, "Can't insert NULL into map!");
 
-    if (map->count * 2 > map->capacity) {
-        // If more than half the capacity is used, expand the map
-        obj_map_expand(map);
+    if (key >= map->dense_capacity && key < OBJ_MAP_DENSE_MAX_CAPACITY) {
+        // Grow the dense array only if it would be at least 1/4 full
+        uint32_t new_capacity = map->dense_capacity;
+        while (new_capacity <= key) new_capacity <<= 1;
+        if (new_capacity <= (map->count + 1) * 4) {
+            obj_map_dense_expand(map, new_capacity);
+        }
+    }
+
+    if (key < map->dense_capacity) {
+        void *old_value = map->dense[key];
+        map->dense[key] = value;
+        if (old_value == NULL) map->count++;
+        return old_value;
     }
 
-    return obj_map_set_without_expanding(map, key, value);
+    if ((map->sparse_count + 1) * 2 > map->capacity) {
+        // If more than half the capacity would be used, expand the map
+        obj_map_sparse_expand(map);
+    }
+
+    uint32_t old_count = map->sparse_count;
+    void *old_value = obj_map_sparse_set(map, key, value);
+    map->count += map->sparse_count - old_count;
+    return old_value;
 }
 
 void * obj_map_remove(obj_map_t *map, uint32_t key)
 {
     assertf(map->entries != NULL, "Map is not initialized!");
 
+    if (key < map->dense_capacity) {
+        void *v = map->dense[key];
+        if (v != NULL) {
+            map->dense[key] = NULL;
+            map->count--;
+        }
+        return v;
+    }
+
     obj_map_entry_t *entry = obj_map_find_entry(map, key);
 
     if (entry != NULL) {
         void *v = entry->value;
-        entry->value = NULL;
-        // Mark the entry as deleted with magic value
-        entry->key = OBJ_MAP_DELETED_KEY;
+        obj_map_sparse_remove_at(map, entry);
         map->count--;
         return v;
     }
@@ -152,10 +263,24 @@ bool obj_map_iterator_next(obj_map_iter_t *iter)
 {
     assertf(iter->_map != NULL, "Map iterator is not initialized!");
 
+    obj_map_t *map = iter->_map;
     uint32_t cur_index = iter->_index;
 
-    while (cur_index < iter->_map->capacity) {
-        obj_map_entry_t *cur_entry = &iter->_map->entries[cur_index];
+    // The dense array comes first, then the hash table
+    while (cur_index < map->dense_capacity) {
+        void *value = map->dense[cur_index];
+        cur_index++;
+
+        if (value != NULL) {
+            iter->key = cur_index - 1;
+            iter->value = value;
+            iter->_index = cur_index;
+            return true;
+        }
+    }
+
+    while (cur_index < map->dense_capacity + map->capacity) {
+        obj_map_entry_t *cur_entry = &map->entries[cur_index - map->dense_capacity];
         cur_index++;
 
         if (cur_entry->value != NULL) {
@@ -166,5 +291,6 @@ bool obj_map_iterator_next(obj_map_iter_t *iter)
         }
     }
 
+    iter->_index = cur_index;
     return false;
 }
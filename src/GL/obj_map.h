@@ -11,8 +11,15 @@ typedef struct {
 } obj_map_entry_t;
 
 typedef struct {
+    // Small keys (GL names are allocated sequentially) index this array directly
+    void **dense;
+    uint32_t dense_capacity;
+
+    // All other keys are stored in a hash table
     obj_map_entry_t *entries;
     uint32_t capacity;
+    uint32_t sparse_count;
+
     uint32_t count;
 } obj_map_t;
 
@@ -8,6 +8,7 @@
 #include "../rdpq/rdpq_internal.h"
 #include <malloc.h>
 #include <string.h>
+#include <math.h>
 
 _Static_assert(((RDPQ_CMD_TRI << 8) | (FLAG_DEPTH_TEST << TRICMD_ATTR_SHIFT_Z)) == (RDPQ_CMD_TRI_ZBUF << 8));
 _Static_assert(((RDPQ_CMD_TRI << 8) | (FLAG_TEXTURE_ACTIVE >> TRICMD_ATTR_SHIFT_TEX)) == (RDPQ_CMD_TRI_TEX << 8));
@@ -207,9 +208,14 @@ bool gl_begin(GLenum mode)
 
     gl_reset_vertex_cache();
 
+    gl_check_tmem_changed();
+
     __rdpq_autosync_change(AUTOSYNC_PIPE | AUTOSYNC_TILES | AUTOSYNC_TMEM(0));
 
+    gl_texture2_load();
     gl_pre_init_pipe(mode);
+    // The TMEM loads above are GL's own
+    __rdpq_tmem_acknowledge();
 
     // FIXME: This is pessimistically marking everything as used, even if textures are turned off
     //        CAUTION: texture state is owned by the RSP currently, so how can we determine this?
@@ -520,6 +526,74 @@ void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indic
     gl_end();
 }
 
+void glDrawElementsInstancedN64(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices, GLsizei instancecount, const GLfloat *matrices)
+{
+    if (!gl_ensure_no_immediate()) return;
+
+    if (instancecount < 0) {
+        gl_set_error(GL_INVALID_VALUE, "Instance count must not be negative");
+        return;
+    }
+
+    if (count == 0 || instancecount == 0) {
+        return;
+    }
+
+    // Each instance pushes its matrix onto the modelview stack: check it has room
+    // for it up front, so that a failed push does not corrupt the caller's matrices.
+    if (state.modelview_stack.cur_depth + 1 >= state.modelview_stack.size) {
+        gl_set_error(GL_STACK_OVERFLOW, "The modelview matrix stack has already reached the maximum depth of %ld", state.modelview_stack.size);
+        return;
+    }
+
+    GLenum matrix_mode = state.matrix_mode;
+    if (matrix_mode != GL_MODELVIEW) {
+        glMatrixMode(GL_MODELVIEW);
+    }
+
+    // The first instance is drawn normally, but recorded into a block. If it went
+    // through the RSP pipeline, the block is independent from the modelview matrix
+    // (which is applied by the RSP), so the other instances just need to load their
+    // matrix and run it again. Blocks cannot be recorded while another one is being
+    // recorded (eg: a display list), so in that case all instances are drawn normally.
+    glPushMatrix();
+    glMultMatrixf(matrices);
+
+    rspq_block_t *block = NULL;
+    if (!rspq_in_block()) {
+        gl_check_tmem_changed();
+        rspq_block_begin();
+        glDrawElements(mode, count, type, indices);
+        block = rspq_block_end();
+        rspq_block_run(block);
+    } else {
+        glDrawElements(mode, count, type, indices);
+    }
+
+    bool replay = block != NULL && state.current_pipeline == &gl_rsp_pipeline;
+    glPopMatrix();
+
+    for (GLsizei i = 1; i < instancecount; i++)
+    {
+        glPushMatrix();
+        glMultMatrixf(matrices + i*16);
+        if (replay) {
+            rspq_block_run(block);
+        } else {
+            glDrawElements(mode, count, type, indices);
+        }
+        glPopMatrix();
+    }
+
+    if (block != NULL) {
+        rdpq_call_deferred((void (*)(void*))rspq_block_free, block);
+    }
+
+    if (matrix_mode != GL_MODELVIEW) {
+        glMatrixMode(matrix_mode);
+    }
+}
+
 void glArrayElement(GLint i)
 {
     // Calling glArrayElement while the vertex array is enabled has, among other things,
@@ -839,6 +913,29 @@ void glDepthRange(GLclampd n, GLclampd f)
         state.current_viewport.offset[2] * 4);
 }
 
+/**
+ * @brief Calculate the largest guard band for a viewport
+ * 
+ * Triangles are clipped against the X and Y planes only when they exceed the guard band
+ * (that is, the viewport scaled by this factor), and the RDP scissor takes care of the rest.
+ * A vertex on the border of the guard band must still have screen coordinates that the
+ * triangle setup and the RDP can handle.
+ */
+static GLint gl_calc_guard_band(const gl_viewport_t *viewport)
+{
+    float factor = GUARD_BAND_MAX_FACTOR;
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        float scale = fabsf(viewport->scale[i]);
+        if (scale > 0.0f) {
+            factor = MIN(factor, (GUARD_BAND_SCREEN_LIMIT - fabsf(viewport->offset[i])) / scale);
+        }
+    }
+
+    return MAX((GLint)factor, 1);
+}
+
 void glViewport(GLint x, GLint y, GLsizei w, GLsizei h)
 {
     if (!gl_ensure_no_immediate()) return;
@@ -868,6 +965,11 @@ void glViewport(GLint x, GLint y, GLsizei w, GLsizei h)
     gl_set_long(GL_UPDATE_NONE, 
         offsetof(gl_server_state_t, viewport_offset), 
         ((uint64_t)offset_x << 48) | ((uint64_t)offset_y << 32) | ((uint64_t)offset_z << 16));
+
+    state.current_viewport.guard_band = gl_calc_guard_band(&state.current_viewport);
+    gl_set_long(GL_UPDATE_NONE, 
+        offsetof(gl_server_state_t, guard_band), 
+        (1ull << 48) | (1ull << 32) | ((uint64_t)state.current_viewport.guard_band << 16) | state.current_viewport.guard_band);
 }
 
 gl_tex_gen_t *gl_get_tex_gen(GLenum coord)
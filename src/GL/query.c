@@ -281,6 +281,22 @@ void glGetIntegerv(GLenum value, GLint *data)
     case GL_TEXTURE_COORD_HALF_FIXED_PRECISION_N64:
         data[0] = state.texcoord_halfx_precision.precision;
         break;
+    case GL_DRAW_QUEUE_DRAWS_N64:
+    case GL_DRAW_QUEUE_STATE_CHANGES_N64:
+    case GL_DRAW_QUEUE_UNSORTED_STATE_CHANGES_N64:
+        data[0] = state.draw_queue_stats[value - GL_DRAW_QUEUE_DRAWS_N64];
+        break;
+    case GL_SECONDARY_TEXTURE_BINDING_N64:
+        data[0] = (GLint)state.texture2_object;
+        break;
+    case GL_TEXTURE_LOADS_N64:
+    case GL_TEXTURE_LOAD_BYTES_N64:
+        {
+            uint32_t stats[2];
+            gl_texture_get_load_stats(stats);
+            data[0] = stats[value - GL_TEXTURE_LOADS_N64];
+        }
+        break;
     default:
         gl_set_error(GL_INVALID_ENUM, "%#04lx cannot be queried with this function", value);
         break;
@@ -328,7 +344,12 @@ static const char *extensions = "GL_ARB_multisample "
                                 "GL_N64_surface_image "
                                 "GL_N64_half_fixed_point "
                                 "GL_N64_reduced_aliasing "
-                                "GL_N64_interpenetrating";
+                                "GL_N64_interpenetrating "
+                                "GL_N64_draw_queue "
+                                "GL_N64_texture_load_stats "
+                                "GL_N64_secondary_texture "
+                                "GL_N64_preconverted_buffer "
+                                "GL_N64_instanced_draw";
 
 GLubyte *glGetString(GLenum name)
 {
@@ -355,6 +355,8 @@ void glTexEnvi(GLenum target, GLenum pname, GLint param)
     case GL_MODULATE:
     case GL_REPLACE:
         gl_set_short(GL_UPDATE_NONE, offsetof(gl_server_state_t, tex_env_mode), (uint16_t)param);
+        state.tex_env_mode = param;
+        gl_update_texture2_combiner();
         break;
     case GL_DECAL:
     case GL_BLEND:
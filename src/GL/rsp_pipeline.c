@@ -1,4 +1,6 @@
 #include <limits.h>
+#include <malloc.h>
+#include <string.h>
 
 #include "gl_internal.h"
 #include "gl_rsp_asm.h"
@@ -325,6 +327,120 @@ static void draw_vertex_from_arrays(const gl_array_t *arrays, uint32_t id, uint3
     submit_vertex(cache_index);
 }
 
+static void draw_vertex_preconverted(const gl_buffer_object_t *buffer, const gl_array_t *arrays, uint32_t id, uint32_t index)
+{
+    uint8_t cache_index;
+    if (gl_get_cache_index(id, &cache_index))
+    {
+        if (index < buffer->converted_count) {
+            const uint32_t *src = buffer->converted + index * buffer->converted_words;
+
+            rspq_write_t w = rspq_write_begin(glp_overlay_id, GLP_CMD_SET_PRIM_VTX, vtx_cmd_size>>2);
+            rspq_write_arg(&w, cache_index * PRIM_VTX_SIZE);
+            for (uint32_t i = 0; i < buffer->converted_words; i++) rspq_write_arg(&w, src[i]);
+            rspq_write_end(&w);
+        } else {
+            write_vertex_from_arrays(arrays, index, cache_index);
+        }
+    }
+
+    submit_vertex(cache_index);
+}
+
+static void gl_buffer_convert(gl_buffer_object_t *buffer, const gl_array_t *arrays, uint32_t vtx_size)
+{
+    gl_buffer_free_converted(buffer);
+
+    // Only convert the vertices for which all enabled attributes are within the buffer
+    uint32_t count = UINT32_MAX;
+    for (uint32_t i = 0; i < ATTRIB_COUNT; i++)
+    {
+        const gl_array_t *array = &arrays[i];
+        if (!array->enabled) {
+            continue;
+        }
+
+        uint32_t offset = (uint32_t)array->pointer;
+        uint32_t elem_size = array->size * gl_get_type_size(array->type);
+        if (offset + elem_size > buffer->storage.size) {
+            return;
+        }
+
+        count = MIN(count, (buffer->storage.size - offset - elem_size) / array->final_stride + 1);
+    }
+
+    // The payload of SET_PRIM_VTX after the first word, which contains the cache index
+    uint32_t words = (vtx_size - 4) >> 2;
+    uint32_t *converted = malloc(count * words * sizeof(uint32_t));
+    if (converted == NULL) {
+        // Not fatal: the vertices will be converted at every draw as usual
+        return;
+    }
+
+    for (uint32_t v = 0; v < count; v++)
+    {
+        gl_cmd_stream_t s = { .w = { .pointer = converted + v * words } };
+
+        for (uint32_t i = 0; i < ATTRIB_COUNT; i++)
+        {
+            const gl_array_t *array = &arrays[i];
+            if (array->enabled) {
+                array->rsp_read_func(&s, gl_get_attrib_element(array, v), array->size);
+            }
+        }
+
+        if (s.buffer_head > 0) {
+            gl_cmd_stream_commit(&s);
+        }
+    }
+
+    buffer->converted = converted;
+    buffer->converted_count = count;
+    buffer->converted_words = words;
+}
+
+static const gl_buffer_object_t * gl_get_preconverted_buffer(const gl_array_t *arrays)
+{
+    gl_buffer_object_t *buffer = arrays[ATTRIB_VERTEX].binding;
+    if (buffer == NULL || buffer->usage != GL_STATIC_DRAW_PRECONVERTED_N64 || buffer->mapped) {
+        return NULL;
+    }
+
+    gl_vtx_layout_t layout;
+    memset(&layout, 0, sizeof(layout));
+
+    for (uint32_t i = 0; i < ATTRIB_COUNT; i++)
+    {
+        const gl_array_t *array = &arrays[i];
+        if (!array->enabled) {
+            continue;
+        }
+
+        if (array->binding != buffer) {
+            return NULL;
+        }
+
+        layout.attribs[i] = (gl_vtx_layout_attrib_t) {
+            .offset = (uint32_t)array->pointer,
+            .type = array->type,
+            .stride = array->final_stride,
+            .size = array->size,
+            .enabled = true,
+        };
+    }
+
+    // Fixed point attributes are converted according to the current precision
+    layout.vertex_shift = state.vertex_halfx_precision.shift_amount;
+    layout.texcoord_shift = state.texcoord_halfx_precision.shift_amount;
+
+    if (buffer->converted == NULL || memcmp(&layout, &buffer->converted_layout, sizeof(layout)) != 0) {
+        gl_buffer_convert(buffer, arrays, vtx_cmd_size);
+        buffer->converted_layout = layout;
+    }
+
+    return buffer->converted != NULL ? buffer : NULL;
+}
+
 static void gl_asm_vtx_loader(const gl_array_t *arrays)
 {
     extern uint8_t rsp_gl_pipeline_text_start[];
@@ -541,9 +657,11 @@ static void gl_rsp_draw_arrays(uint32_t first, uint32_t count)
 {
     if (state.array_object->arrays[ATTRIB_VERTEX].enabled) {
         gl_prepare_vtx_cmd(state.array_object->arrays);
+        const gl_buffer_object_t *buffer = gl_get_preconverted_buffer(state.array_object->arrays);
         for (uint32_t i = 0; i < count; i++)
         {
-            draw_vertex_from_arrays(state.array_object->arrays, next_prim_id(), first + i);
+            if (buffer) draw_vertex_preconverted(buffer, state.array_object->arrays, next_prim_id(), first + i);
+            else draw_vertex_from_arrays(state.array_object->arrays, next_prim_id(), first + i);
         }
     }
 
@@ -556,10 +674,12 @@ static void gl_rsp_draw_elements(uint32_t count, const void* indices, read_index
 
     if (state.array_object->arrays[ATTRIB_VERTEX].enabled) {
         gl_prepare_vtx_cmd(state.array_object->arrays);
+        const gl_buffer_object_t *buffer = gl_get_preconverted_buffer(state.array_object->arrays);
         for (uint32_t i = 0; i < count; i++)
         {
             uint32_t index = read_index(indices, i);
-            draw_vertex_from_arrays(state.array_object->arrays, index, index);
+            if (buffer) draw_vertex_preconverted(buffer, state.array_object->arrays, index, index);
+            else draw_vertex_from_arrays(state.array_object->arrays, index, index);
         }
     }
 
@@ -23,6 +23,7 @@ extern gl_state_t state;
 inline void texture_get_texparms(gl_texture_object_t *obj, GLint level, rdpq_texparms_t *parms);
 
 void gl_texture_set_min_filter(gl_texture_object_t *obj, uint32_t offset, GLenum param);
+static void gl_init_conversion_tables(void);
 
 void gl_init_texture_object(gl_texture_object_t *obj)
 {
@@ -41,6 +42,7 @@ void gl_init_texture_object(gl_texture_object_t *obj)
     *obj = (gl_texture_object_t) {
         .wrap_s = GL_REPEAT,
         .wrap_t = GL_REPEAT,
+        .priority = 1.0f,
         .srv_object = srv_obj,
     };
 }
@@ -59,6 +61,8 @@ void texture_image_free_safe(gl_texture_object_t *obj, uint32_t level)
         rdpq_call_deferred((void (*)(void*))rspq_block_free, obj->blocks[level]);
         obj->blocks[level] = NULL;
     }
+    obj->load_bytes[level] = 0;
+    obj->tmem_bytes[level] = 0;
 
     surface_free_safe(&obj->surfaces[level]);
 }
@@ -107,10 +111,16 @@ void gl_texture_init()
 
     state.texture_1d_object = &state.default_textures[0];
     state.texture_2d_object = &state.default_textures[1];
+
+    gl_init_conversion_tables();
 }
 
 void gl_texture_close()
 {
+    if (state.texture2_block != NULL) {
+        rspq_block_free(state.texture2_block);
+    }
+
     gl_cleanup_texture_object(&state.default_textures[0]);
     gl_cleanup_texture_object(&state.default_textures[1]);
 
@@ -218,10 +228,33 @@ inline bool texture_is_default(gl_texture_object_t *obj)
     return (obj->flags & TEX_IS_DEFAULT) != 0;
 }
 
-void gl_texture_set_upload_block(uint32_t offset, int level, int width, int height, tex_format_t fmt, rspq_block_t *texup_block)
+/** @brief Number of TMEM bytes occupied by a surface (rows are padded to 8 bytes) */
+static uint32_t gl_surface_tmem_bytes(const surface_t *surface)
+{
+    return ROUND_UP(TEX_FORMAT_PIX2BYTES(surface_get_format(surface), surface->width), 8) * surface->height;
+}
+
+/** @brief Number of bytes occupied by a surface in the lower half of TMEM (RGBA32 is split between the two halves) */
+static uint32_t gl_surface_tmem_low_bytes(const surface_t *surface)
+{
+    tex_format_t fmt = surface_get_format(surface);
+    uint32_t row_bytes = fmt == FMT_RGBA32 ? surface->width * 2 : TEX_FORMAT_PIX2BYTES(fmt, surface->width);
+    return ROUND_UP(row_bytes, 8) * surface->height;
+}
+
+void gl_texture_set_upload_block(gl_texture_object_t *obj, uint32_t offset, int level, int width, int height, tex_format_t fmt, rspq_block_t *texup_block, uint32_t load_bytes, uint32_t tmem_bytes)
 {
     assertf(texup_block->nesting_level == 0, "texture loader: nesting level is %ld", texup_block->nesting_level);
 
+    obj->tmem_bytes[level] = tmem_bytes;
+
+    // Keep the total size of all levels in the upper half of the flags,
+    // so that the RSP can account for the loaded bytes.
+    obj->load_bytes[level] = load_bytes;
+    uint32_t total_bytes = 0;
+    for (uint32_t i = 0; i < MAX_TEXTURE_LEVELS; i++) total_bytes += obj->load_bytes[i];
+    gl_set_short(GL_UPDATE_NONE, offset + TEXTURE_FLAGS_OFFSET, total_bytes);
+
     uint32_t img_offset = offset + level * sizeof(gl_texture_image_t);
     gl_set_word (GL_UPDATE_NONE, img_offset + IMAGE_WIDTH_OFFSET,           (width << 16) | height);
     gl_set_short(GL_UPDATE_NONE, img_offset + IMAGE_INTERNAL_FORMAT_OFFSET, fmt);
@@ -277,14 +310,28 @@ void glSpriteTextureN64(GLenum target, sprite_t *sprite, rdpq_texparms_t *texpar
     gl_texture_set_min_filter(obj, offset, min_filter);
 
     // Set detail mode
-    surface_t detailsurf = sprite_get_detail_pixels(sprite, NULL, NULL);
+    sprite_detail_t detail;
+    surface_t detailsurf = sprite_get_detail_pixels(sprite, &detail, NULL);
     bool use_detail = detailsurf.buffer != NULL;
     gl_set_flag_raw(GL_UPDATE_NONE, offset + TEXTURE_FLAGS_OFFSET, TEX_FLAG_DETAIL, use_detail);
 
     // Mark texture as complete because sprites are complete by definition
     gl_set_flag_raw(GL_UPDATE_NONE, offset + TEXTURE_FLAGS_OFFSET, TEX_FLAG_COMPLETE, true);
 
-    gl_texture_set_upload_block(offset, 0, sprite->width, sprite->height, sprite_get_format(sprite), texup_block);
+    // Count all the surfaces loaded by the upload block: main image, mipmaps and detail texture
+    uint32_t load_bytes = 0, tmem_bytes = 0;
+    for (int i = 0; i < MAX_TEXTURE_LEVELS; i++) {
+        surface_t surf = sprite_get_lod_pixels(sprite, i);
+        if (!surf.buffer) break;
+        load_bytes += gl_surface_tmem_bytes(&surf);
+        tmem_bytes += gl_surface_tmem_low_bytes(&surf);
+    }
+    if (use_detail && !detail.use_main_tex) {
+        load_bytes += gl_surface_tmem_bytes(&detailsurf);
+        tmem_bytes += gl_surface_tmem_low_bytes(&detailsurf);
+    }
+
+    gl_texture_set_upload_block(obj, offset, 0, sprite->width, sprite->height, sprite_get_format(sprite), texup_block, load_bytes, tmem_bytes);
 }
 
 void gl_surface_image(gl_texture_object_t *obj, uint32_t offset, GLint level, surface_t *surface, rdpq_texparms_t *parms)
@@ -303,7 +350,7 @@ void gl_surface_image(gl_texture_object_t *obj, uint32_t offset, GLint level, su
     rdpq_tlut_t tlut_mode = rdpq_tlut_from_format(surface_get_format(surface));
     gl_set_byte(GL_UPDATE_NONE, offset + TEXTURE_TLUT_MODE_OFFSET, tlut_mode);
 
-    gl_texture_set_upload_block(offset, level, surface->width, surface->height, surface_get_format(surface), texup_block);
+    gl_texture_set_upload_block(obj, offset, level, surface->width, surface->height, surface_get_format(surface), texup_block, gl_surface_tmem_bytes(surface), gl_surface_tmem_low_bytes(surface));
     gl_update_texture_completeness(offset);
 }
 
@@ -454,7 +501,7 @@ void glTexParameteri(GLenum target, GLenum pname, GLint param)
         gl_texture_set_mag_filter(offset, param);
         break;
     case GL_TEXTURE_PRIORITY:
-        // Ignored
+        obj->priority = CLAMP01(param);
         break;
     default:
         gl_set_error(GL_INVALID_ENUM, "%#04lx is not a valid parameter name for this function", pname);
@@ -487,7 +534,7 @@ void glTexParameterf(GLenum target, GLenum pname, GLfloat param)
         gl_texture_set_mag_filter(offset, param);
         break;
     case GL_TEXTURE_PRIORITY:
-        // Ignored
+        obj->priority = CLAMP01(param);
         break;
     default:
         gl_set_error(GL_INVALID_ENUM, "%#04lx is not a valid parameter name for this function", pname);
@@ -523,7 +570,7 @@ void glTexParameteriv(GLenum target, GLenum pname, const GLint *params)
         assertf(0, "Texture border color is not supported!");
         break;
     case GL_TEXTURE_PRIORITY:
-        // Ignored
+        obj->priority = CLAMP01(params[0]);
         break;
     default:
         gl_set_error(GL_INVALID_ENUM, "%#04lx is not a valid parameter name for this function", pname);
@@ -559,7 +606,7 @@ void glTexParameterfv(GLenum target, GLenum pname, const GLfloat *params)
         assertf(0, "Texture border color is not supported!");
         break;
     case GL_TEXTURE_PRIORITY:
-        // Ignored
+        obj->priority = CLAMP01(params[0]);
         break;
     default:
         gl_set_error(GL_INVALID_ENUM, "%#04lx is not a valid parameter name for this function", pname);
@@ -662,6 +709,10 @@ void glDeleteTextures(GLsizei n, const GLuint *textures)
             glBindTexture(GL_TEXTURE_2D, 0);
         }
 
+        if (obj == state.texture2_object) {
+            glSecondaryTextureN64(0, GL_MODULATE, NULL);
+        }
+
         rdpq_call_deferred((void (*)(void*))texture_free, obj);
     }
 }
@@ -936,6 +987,95 @@ bool gl_do_formats_match(GLint dst_fmt, GLenum src_fmt, GLenum src_type)
     return false;
 }
 
+/** @brief Conversion table from 8-bit to 5-bit color components (rounded like the generic path) */
+static uint8_t u8_to_u5[256];
+/** @brief Conversion table from 8-bit to 4-bit color components (rounded like the generic path) */
+static uint8_t u8_to_u4[256];
+
+static void gl_init_conversion_tables(void)
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        u8_to_u5[i] = (i * 0x1F + 0x7F) / 0xFF;
+        u8_to_u4[i] = (i * 0xF + 0x7F) / 0xFF;
+    }
+}
+
+// Fast paths for the common case of unsigned byte source data with no pixel transfer operations.
+// Each function converts one row; the source components are expanded to RGBA like the generic path does.
+
+#define FAST_FETCH_1(s, p) p[0] = p[1] = p[2] = s[0], p[3] = 0xFF
+#define FAST_FETCH_2(s, p) p[0] = p[1] = p[2] = s[0], p[3] = s[1]
+#define FAST_FETCH_3(s, p) p[0] = s[0], p[1] = s[1], p[2] = s[2], p[3] = 0xFF
+#define FAST_FETCH_4(s, p) p[0] = s[0], p[1] = s[1], p[2] = s[2], p[3] = s[3]
+
+#define DEFINE_FAST_ROW(name, n, pack) \
+    static void gl_fast_row_##name##_##n(GLvoid *dest, uint32_t x, const GLubyte *src, uint32_t width) \
+    { \
+        for (uint32_t c = 0; c < width; c++, x++, src += n) \
+        { \
+            uint32_t p[4]; \
+            FAST_FETCH_##n(src, p); \
+            pack; \
+        } \
+    }
+
+#define DEFINE_FAST_ROWS(name, pack) \
+    DEFINE_FAST_ROW(name, 1, pack) \
+    DEFINE_FAST_ROW(name, 2, pack) \
+    DEFINE_FAST_ROW(name, 3, pack) \
+    DEFINE_FAST_ROW(name, 4, pack)
+
+DEFINE_FAST_ROWS(rgb5a1, ((GLushort*)dest)[x] = (u8_to_u5[p[0]] << 11) | (u8_to_u5[p[1]] << 6) | (u8_to_u5[p[2]] << 1) | (p[3] >> 7))
+DEFINE_FAST_ROWS(rgba8, ((GLuint*)dest)[x] = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3])
+DEFINE_FAST_ROWS(luminance4_alpha4, ((GLubyte*)dest)[x] = (u8_to_u4[p[0]] << 4) | u8_to_u4[p[3]])
+DEFINE_FAST_ROWS(luminance8_alpha8, ((GLushort*)dest)[x] = (p[0] << 8) | p[3])
+DEFINE_FAST_ROWS(intensity4, GLubyte *d = (GLubyte*)dest + x/2; *d = (x & 1) ? ((*d & 0xF0) | u8_to_u4[p[0]]) : ((*d & 0xF) | (u8_to_u4[p[0]] << 4)))
+DEFINE_FAST_ROWS(intensity8, ((GLubyte*)dest)[x] = p[0])
+
+typedef void (*gl_fast_row_func)(GLvoid*,uint32_t,const GLubyte*,uint32_t);
+
+#define FAST_ROWS(name) { gl_fast_row_##name##_1, gl_fast_row_##name##_2, gl_fast_row_##name##_3, gl_fast_row_##name##_4 }
+
+static const gl_fast_row_func gl_fast_rows[][4] = {
+    FAST_ROWS(rgb5a1),
+    FAST_ROWS(rgba8),
+    FAST_ROWS(luminance4_alpha4),
+    FAST_ROWS(luminance8_alpha8),
+    FAST_ROWS(intensity4),
+    FAST_ROWS(intensity8),
+};
+
+static gl_fast_row_func gl_get_fast_row_func(GLenum dest_format, GLenum format, GLenum type)
+{
+    if (type != GL_UNSIGNED_BYTE || !state.transfer_is_noop) {
+        return NULL;
+    }
+
+    // Formats that select single components (GL_RED, GL_ALPHA, etc.) are left to the generic path
+    uint32_t num_elements;
+    switch (format) {
+    case GL_LUMINANCE:          num_elements = 1; break;
+    case GL_LUMINANCE_ALPHA:    num_elements = 2; break;
+    case GL_RGB:                num_elements = 3; break;
+    case GL_RGBA:               num_elements = 4; break;
+    default:                    return NULL;
+    }
+
+    uint32_t dest_index;
+    switch (dest_format) {
+    case GL_RGB5_A1:            dest_index = 0; break;
+    case GL_RGBA8:              dest_index = 1; break;
+    case GL_LUMINANCE4_ALPHA4:  dest_index = 2; break;
+    case GL_LUMINANCE8_ALPHA8:  dest_index = 3; break;
+    case GL_INTENSITY4:         dest_index = 4; break;
+    case GL_INTENSITY8:         dest_index = 5; break;
+    default:                    return NULL;
+    }
+
+    return gl_fast_rows[dest_index][num_elements - 1];
+}
+
 void gl_transfer_pixels(GLvoid *dest, GLenum dest_format, GLsizei dest_stride, GLsizei width, GLsizei height, uint32_t num_elements, GLenum format, GLenum type, uint32_t xoffset, const GLvoid *data)
 {
     uint32_t src_pixel_size;
@@ -1044,11 +1184,14 @@ void gl_transfer_pixels(GLvoid *dest, GLenum dest_format, GLsizei dest_stride, G
 
     bool formats_match = gl_do_formats_match(dest_format, format, type);
     bool can_mempcy = formats_match && state.transfer_is_noop;
+    gl_fast_row_func fast_row_func = can_mempcy ? NULL : gl_get_fast_row_func(dest_format, format, type);
 
     for (uint32_t r = 0; r < height; r++)
     {
         if (can_mempcy) {
             memcpy(dest_ptr + TEX_FORMAT_PIX2BYTES(dest_tex_fmt, xoffset), src_ptr, TEX_FORMAT_PIX2BYTES(dest_tex_fmt, width));
+        } else if (fast_row_func) {
+            fast_row_func(dest_ptr, xoffset, src_ptr, width);
         } else {
             for (uint32_t c = 0; c < width; c++)
             {
@@ -1280,14 +1423,232 @@ void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei widt
     gl_tex_image(target, level, internalformat, width, height, border, format, type, data);
 }
 
-GLboolean glAreTexturesResident(GLsizei n, const GLuint *textures, const GLboolean *residences)
+/**
+ * @brief Fetch the TMEM residency state from the RSP
+ * 
+ * Returns the ID of the texture currently loaded in TMEM (or 0 if none), the number
+ * of texture loads and the number of loaded bytes since the beginning of the frame.
+ */
+static void gl_texture_fetch_residency(uint32_t *stats)
+{
+    // DMA transfers must be 8-byte aligned, so start from the ID of the bound 2D texture
+    _Static_assert((offsetof(gl_server_state_t, texture_ids[1]) & 0x7) == 0, "Texture IDs must be aligned to 8 bytes in server state");
+    _Static_assert(offsetof(gl_server_state_t, tex_load_bytes) - offsetof(gl_server_state_t, texture_ids[1]) == 12, "Unexpected layout of texture residency state");
+
+    uint32_t buf[4] __attribute__((aligned(16)));
+    data_cache_hit_writeback_invalidate(buf, sizeof(buf));
+    gl_get_value(buf, offsetof(gl_server_state_t, texture_ids[1]), sizeof(buf));
+    rspq_wait();
+
+    uint32_t *ubuf = UncachedAddr(buf);
+    for (int i = 0; i < 3; i++) stats[i] = ubuf[i+1];
+}
+
+void gl_texture_get_load_stats(uint32_t *stats)
+{
+    uint32_t residency[3];
+    gl_texture_fetch_residency(residency);
+    stats[0] = residency[1];
+    stats[1] = residency[2];
+}
+
+GLboolean glAreTexturesResident(GLsizei n, const GLuint *textures, GLboolean *residences)
 {
+    if (!gl_ensure_no_immediate()) return GL_FALSE;
+
+    if (n < 0) {
+        gl_set_error(GL_INVALID_VALUE, "Number of textures must not be negative");
+        return GL_FALSE;
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (textures[i] == 0 || !is_valid_object_id(textures[i])) {
+            gl_set_error(GL_INVALID_VALUE, "Not a valid texture object: %#lx", textures[i]);
+            return GL_FALSE;
+        }
+    }
+
+    // TMEM is used by a single texture at a time (with all its mipmaps), so the only
+    // resident texture is the one that was loaded by the last textured primitive,
+    // unless rdpq overwrote TMEM since then.
+    gl_check_tmem_changed();
+    uint32_t residency[3];
+    gl_texture_fetch_residency(residency);
+
+    bool all_resident = true;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        gl_texture_object_t *obj = (gl_texture_object_t*)textures[i];
+        if (PhysicalAddr(obj->srv_object) != residency[0]) {
+            all_resident = false;
+            break;
+        }
+    }
+
+    if (all_resident) {
+        return GL_TRUE;
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        gl_texture_object_t *obj = (gl_texture_object_t*)textures[i];
+        residences[i] = PhysicalAddr(obj->srv_object) == residency[0];
+    }
     return GL_FALSE;
 }
 
 void glPrioritizeTextures(GLsizei n, const GLuint *textures, const GLclampf *priorities)
 {
-    // Priorities are ignored
+    if (!gl_ensure_no_immediate()) return;
+
+    if (n < 0) {
+        gl_set_error(GL_INVALID_VALUE, "Number of textures must not be negative");
+        return;
+    }
+
+    // Priorities are used by the draw queue (see glEndDrawQueueN64) to decide the order of
+    // the texture batches, so that the texture with the highest priority stays resident.
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (textures[i] == 0) continue;
+        assertf(is_valid_object_id(textures[i]),
+            "Not a valid texture object: %#lx. Make sure to allocate IDs via glGenTextures", textures[i]);
+
+        gl_texture_object_t *obj = (gl_texture_object_t*)textures[i];
+        obj->priority = CLAMP01(priorities[i]);
+    }
+}
+
+void gl_update_texture2_combiner()
+{
+    // Cycle 0 combines the two textures, cycle 1 applies the texture environment
+    // of the primary texture.
+    #define TEX2_COMBINER(rgb, alpha) \
+        RDPQ_COMBINER2(rgb, alpha, (COMBINED, 0, SHADE, 0), (COMBINED, 0, SHADE, 0)), \
+        RDPQ_COMBINER2(rgb, alpha, (0, 0, 0, COMBINED), (0, 0, 0, COMBINED))
+
+    static const rdpq_combiner_t combiners[3][2] = {
+        { TEX2_COMBINER((TEX1, 0, TEX0, 0),           (TEX1, 0, TEX0, 0)) },  // GL_MODULATE
+        { TEX2_COMBINER((TEX1, TEX0, TEX1_ALPHA, TEX0), (0, 0, 0, TEX0)) },   // GL_DECAL
+        { TEX2_COMBINER((ONE, 0, TEX0, TEX1),          (0, 0, 0, TEX0)) },    // GL_ADD
+    };
+
+    #undef TEX2_COMBINER
+
+    int mode;
+    switch (state.texture2_mode) {
+    case GL_DECAL:  mode = 1; break;
+    case GL_ADD:    mode = 2; break;
+    default:        mode = 0; break;
+    }
+
+    rdpq_combiner_t comb = combiners[mode][state.tex_env_mode == GL_REPLACE];
+    gl_set_long(GL_UPDATE_NONE, offsetof(gl_server_state_t, tex2_combiner), comb);
+}
+
+void gl_texture2_load()
+{
+    if (state.texture2_block == NULL) return;
+
+    gl_texture_object_t *primary = gl_get_active_texture();
+    if (primary != NULL) {
+        uint32_t primary_bytes = 0;
+        for (uint32_t i = 0; i < MAX_TEXTURE_LEVELS; i++) primary_bytes += primary->tmem_bytes[i];
+        assertf(primary_bytes <= state.texture2_parms.tmem_addr,
+            "The primary texture (%ld bytes of TMEM) overlaps the secondary texture (at TMEM address %d)",
+            primary_bytes, state.texture2_parms.tmem_addr);
+    }
+
+    if (state.current_list != 0) {
+        // Display lists must always load it, because TMEM might have been overwritten
+        // by the time they run. The upload is recorded inline instead of calling the
+        // block, because the block is freed when the secondary texture changes, while
+        // the list can still be called afterwards.
+        rdpq_tex_upload(TILE1, &state.texture2_surface, &state.texture2_parms);
+        return;
+    }
+
+    // Nothing else writes the TMEM area of the secondary texture (as long as
+    // the primary texture fits below it), so it is loaded only once.
+    if (!state.texture2_dirty) return;
+
+    rspq_block_run(state.texture2_block);
+    state.texture2_dirty = false;
+}
+
+static void gl_texture2_free_block()
+{
+    if (state.texture2_block != NULL) {
+        rdpq_call_deferred((void (*)(void*))rspq_block_free, state.texture2_block);
+        state.texture2_block = NULL;
+    }
+}
+
+void glSecondaryTextureN64(GLuint texture, GLenum mode, rdpq_texparms_t *texparms)
+{
+    gl_assert_no_display_list();
+    if (!gl_ensure_no_immediate()) return;
+    assertf(texture == 0 || is_valid_object_id(texture),
+        "Not a valid texture object: %#lx. Make sure to allocate IDs via glGenTextures", texture);
+
+    switch (mode) {
+    case GL_MODULATE:
+    case GL_DECAL:
+    case GL_ADD:
+        break;
+    default:
+        gl_set_error(GL_INVALID_ENUM, "%#04lx is not a valid secondary texture mode", mode);
+        return;
+    }
+
+    if (texture == 0) {
+        gl_texture2_free_block();
+        state.texture2_object = NULL;
+        gl_set_flag_word2(GL_UPDATE_NONE, FLAG2_TEXTURE2, false);
+        return;
+    }
+
+    gl_texture_object_t *obj = (gl_texture_object_t*)texture;
+    surface_t surf = texture_is_sprite(obj) ? sprite_get_pixels(obj->sprite) : obj->surfaces[0];
+    if (surf.buffer == NULL) {
+        gl_set_error(GL_INVALID_OPERATION, "Secondary texture has no image");
+        return;
+    }
+
+    tex_format_t fmt = surface_get_format(&surf);
+    assertf(fmt != FMT_CI4 && fmt != FMT_CI8, "CI textures are not supported as secondary textures");
+
+    // The secondary texture is placed at the end of the lower half of TMEM, so that
+    // it does not conflict with palettes and with the upper half of RGBA32 textures.
+    uint32_t tmem_bytes = gl_surface_tmem_low_bytes(&surf);
+    if (tmem_bytes > 2048) {
+        gl_set_error(GL_INVALID_VALUE, "Secondary texture is too big (%ld bytes of TMEM, max 2048)", tmem_bytes);
+        return;
+    }
+
+    rdpq_texparms_t parms;
+    if (texparms != NULL) {
+        parms = *texparms;
+    } else {
+        texture_get_texparms(obj, 0, &parms);
+    }
+    parms.tmem_addr = 2048 - tmem_bytes;
+
+    // The RDP samples the second texture from the tile after the one of the
+    // triangle, with the same texture coordinates.
+    gl_texture2_free_block();
+    rspq_block_begin();
+        rdpq_tex_upload(TILE1, &surf, &parms);
+    state.texture2_block = rspq_block_end();
+
+    state.texture2_surface = surf;
+    state.texture2_parms = parms;
+    state.texture2_object = obj;
+    state.texture2_mode = mode;
+    state.texture2_dirty = true;
+    gl_update_texture2_combiner();
+    gl_set_flag_word2(GL_UPDATE_NONE, FLAG2_TEXTURE2, true);
 }
 
 /*
@@ -0,0 +1,170 @@
+/**
+ * @file arena.c
+ * @brief Arena (linear) memory allocator
+ * @ingroup arena
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include "arena.h"
+#include "debug.h"
+#include "utils.h"
+
+/**
+ * @defgroup arena Arena allocator
+ * @ingroup lowlevel
+ * @brief Linear allocator with bulk release, for per-frame and per-level data.
+ *
+ * An arena reserves big chunks of memory from the heap and serves allocations
+ * by bumping a pointer within them. Allocations cannot be freed one by one:
+ * all of them are released at once with #arena_reset, or back to a previous
+ * position with #arena_rewind. Chunks are kept across resets, so that after
+ * the first frame (or level), an arena stops interacting with the heap
+ * at all: this avoids the heap fragmentation that builds up during long
+ * sessions with many different allocation sizes and lifetimes.
+ *
+ * Library loaders (#asset_load, #sprite_load, #rdpq_paragraph_build,
+ * #model64_load) can be redirected to an arena via #arena_set_current.
+ * @{
+ */
+
+/** @brief A chunk of memory reserved from the heap */
+struct arena_chunk_s {
+    arena_chunk_t *next;        ///< Next chunk
+    size_t size;                ///< Size of the data area
+    size_t offset;              ///< Offset of the first free byte in the data area
+    uint32_t padding;           ///< Pad the header to 16 bytes
+    uint8_t data[] __attribute__((aligned(16)));  ///< Data area
+};
+
+/** @brief Arena currently used by library loaders */
+static arena_t *cur_arena = NULL;
+
+void arena_init(arena_t *arena, size_t chunk_size)
+{
+    memset(arena, 0, sizeof(arena_t));
+    arena->chunk_size = chunk_size ? chunk_size : ARENA_DEFAULT_CHUNK_SIZE;
+}
+
+void arena_close(arena_t *arena)
+{
+    arena_chunk_t *chunk = arena->first;
+    while (chunk) {
+        arena_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    if (cur_arena == arena)
+        cur_arena = NULL;
+    arena->first = arena->cur = NULL;
+    arena->reserved = arena->used = 0;
+}
+
+/** @brief Reserve a new chunk and append it to the arena */
+static arena_chunk_t *chunk_new(arena_t *arena, size_t size)
+{
+    arena_chunk_t *chunk = memalign(16, sizeof(arena_chunk_t) + size);
+    if (!chunk) return NULL;
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->offset = 0;
+
+    if (arena->cur) {
+        // Allocations only move forward in the list, so the new chunk goes
+        // at the end (skipped chunks, if any, get reused after a reset).
+        arena_chunk_t *last = arena->cur;
+        while (last->next) last = last->next;
+        last->next = chunk;
+    } else {
+        arena->first = chunk;
+    }
+    arena->reserved += sizeof(arena_chunk_t) + size;
+    return chunk;
+}
+
+void *arena_alloc(arena_t *arena, size_t size, size_t align)
+{
+    assertf(align && (align & (align-1)) == 0, "alignment must be a power of two: %d", (int)align);
+
+    // Chunks following the current one are empty (see #arena_rewind), so we
+    // can walk forward until we find room.
+    arena_chunk_t *chunk = arena->cur;
+    size_t offset = 0;
+    while (chunk) {
+        offset = ROUND_UP((uintptr_t)chunk->data + chunk->offset, align) - (uintptr_t)chunk->data;
+        if (offset + size <= chunk->size)
+            break;
+        chunk = chunk->next;
+    }
+
+    if (!chunk) {
+        // The data area is 16-byte aligned, so bigger alignments might
+        // require some extra room.
+        size_t extra = align > 16 ? align - 16 : 0;
+        chunk = chunk_new(arena, MAX(arena->chunk_size, size + extra));
+        if (!chunk) return NULL;
+        offset = ROUND_UP((uintptr_t)chunk->data, align) - (uintptr_t)chunk->data;
+    }
+
+    arena->cur = chunk;
+    chunk->offset = offset + size;
+    arena->used += size;
+    if (arena->used > arena->peak)
+        arena->peak = arena->used;
+    return chunk->data + offset;
+}
+
+void arena_reset(arena_t *arena)
+{
+    for (arena_chunk_t *chunk = arena->first; chunk; chunk = chunk->next)
+        chunk->offset = 0;
+    arena->cur = arena->first;
+    arena->used = 0;
+}
+
+arena_mark_t arena_mark(arena_t *arena)
+{
+    return (arena_mark_t){
+        .chunk = arena->cur,
+        .offset = arena->cur ? arena->cur->offset : 0,
+        .used = arena->used,
+    };
+}
+
+void arena_rewind(arena_t *arena, arena_mark_t mark)
+{
+    if (!mark.chunk) {
+        arena_reset(arena);
+        return;
+    }
+
+    mark.chunk->offset = mark.offset;
+    for (arena_chunk_t *chunk = mark.chunk->next; chunk; chunk = chunk->next)
+        chunk->offset = 0;
+    arena->cur = mark.chunk;
+    arena->used = mark.used;
+}
+
+bool arena_contains(arena_t *arena, const void *ptr)
+{
+    for (arena_chunk_t *chunk = arena->first; chunk; chunk = chunk->next) {
+        if ((const uint8_t*)ptr >= chunk->data && (const uint8_t*)ptr < chunk->data + chunk->size)
+            return true;
+    }
+    return false;
+}
+
+arena_t *arena_set_current(arena_t *arena)
+{
+    arena_t *prev = cur_arena;
+    cur_arena = arena;
+    return prev;
+}
+
+arena_t *arena_get_current(void)
+{
+    return cur_arena;
+}
+
+/** @} */
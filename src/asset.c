@@ -13,13 +13,29 @@
 #include "n64sys.h"
 #include "dma.h"
 #include "dragonfs.h"
+#include "arena.h"
 #else
 #include <stdlib.h>
 #include <assert.h>
 #define memalign(a, b) malloc(b)
 #define assertf(x, ...) assert(x)
+#define arena_get_current() NULL
+#define arena_alloc(arena, size, align) NULL
 #endif
 
+/**
+ * @brief Allocate the buffer for a loaded asset.
+ * 
+ * The buffer is 16-byte aligned, and is taken from the current arena if
+ * one was installed via #arena_set_current.
+ */
+static void *asset_buf_alloc(int size)
+{
+    if (arena_get_current())
+        return arena_alloc(arena_get_current(), size, 16);
+    return memalign(16, size);
+}
+
 FILE *must_fopen(const char *fn)
 {
     FILE *f = fopen(fn, "rb");
@@ -70,7 +86,7 @@ void *asset_load(const char *fn, int *sz)
         switch (header.algo) {
         case 2: {
             size = header.orig_size;
-            s = memalign(16, size);
+            s = asset_buf_alloc(size);
             assertf(s, "asset_load: out of memory");
             int n = decompress_lz5h_full(f, s, size); (void)n;
             assertf(n == size, "asset: decompression error on file %s: corrupted? (%d/%d)", fn, n, size);
@@ -88,7 +104,7 @@ void *asset_load(const char *fn, int *sz)
                 bufsize += 16 - (bufsize & 15);
             }
 
-            s = memalign(16, bufsize);
+            s = asset_buf_alloc(bufsize);
             assertf(s, "asset_load: out of memory");
             int n;
 
@@ -119,8 +135,10 @@ void *asset_load(const char *fn, int *sz)
                 n = decompress_lz4_full_mem(s+cmp_offset, header.cmp_size, s, size, false); (void)n;
             }
             assertf(n == size, "asset: decompression error on file %s: corrupted? (%d/%d)", fn, n, size);
-            void *ptr = realloc(s, size); (void)ptr;
-            assertf(s == ptr, "asset: realloc moved the buffer"); // guaranteed by newlib
+            if (!arena_get_current()) {
+                void *ptr = realloc(s, size); (void)ptr;
+                assertf(s == ptr, "asset: realloc moved the buffer"); // guaranteed by newlib
+            }
         }   break;
         default:
             assertf(0, "asset: unsupported compression algorithm: %d", header.algo);
@@ -133,7 +151,7 @@ void *asset_load(const char *fn, int *sz)
         // matters, at least we guarantee that. 
         fseek(f, 0, SEEK_END);
         size = ftell(f);
-        s = memalign(16, size);
+        s = asset_buf_alloc(size);
 
         fseek(f, 0, SEEK_SET);
         fread(s, 1, size, f);
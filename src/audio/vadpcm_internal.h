@@ -0,0 +1,65 @@
+/**
+ * @file vadpcm_internal.h
+ * @brief Reference C decoder for VADPCM
+ * @ingroup mixer
+ */
+#ifndef LIBDRAGON_AUDIO_VADPCM_INTERNAL_H
+#define LIBDRAGON_AUDIO_VADPCM_INTERNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "wav64internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief VADPCM decoding errors */
+typedef enum {
+    // No error (success). Equal to 0.
+    kVADPCMErrNone,
+
+    // Invalid data.
+    kVADPCMErrInvalidData,
+
+    // Predictor order is too large.
+    kVADPCMErrLargeOrder,
+
+    // Predictor count is too large.
+    kVADPCMErrLargePredictorCount,
+
+    // Data uses an unsupported / unknown version of VADPCM.
+    kVADPCMErrUnknownVersion,
+
+    // Invalid encoding parameters.
+    kVADPCMErrInvalidParams,
+} vadpcm_error;
+
+/**
+ * @brief Decode VADPCM frames with the CPU.
+ *
+ * This is the reference implementation of the decoder that runs on the RSP
+ * (see rsp_mixer.S). It is not used by default, but it can be enabled in
+ * wav64.c for debugging, and it is portable C so that it can be benchmarked
+ * on the host (see tests/host).
+ *
+ * @param predictor_count   Number of predictors in the codebook
+ * @param order             Order of the predictors
+ * @param codebook          Codebook (predictor_count * order vectors)
+ * @param state             Decoder state (last decoded vector), updated
+ * @param frame_count       Number of 9-byte frames to decode
+ * @param dest              Output buffer (16 samples per frame)
+ * @param src               Compressed input
+ * @return kVADPCMErrNone on success, or an error code
+ */
+vadpcm_error vadpcm_decode(int predictor_count, int order,
+                           const wav64_vadpcm_vector_t *restrict codebook,
+                           wav64_vadpcm_vector_t *restrict state,
+                           size_t frame_count, int16_t *restrict dest,
+                           const void *restrict src);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -35,103 +35,7 @@
 int64_t __wav64_profile_dma = 0;
 
 #if VADPCM_REFERENCE_DECODER
-/** @brief VADPCM decoding errors */
-typedef enum {
-    // No error (success). Equal to 0.
-    kVADPCMErrNone,
-
-    // Invalid data.
-    kVADPCMErrInvalidData,
-
-    // Predictor order is too large.
-    kVADPCMErrLargeOrder,
-
-    // Predictor count is too large.
-    kVADPCMErrLargePredictorCount,
-
-    // Data uses an unsupported / unknown version of VADPCM.
-    kVADPCMErrUnknownVersion,
-
-    // Invalid encoding parameters.
-    kVADPCMErrInvalidParams,
-} vadpcm_error;
-
-// Extend the sign bit of a 4-bit integer.
-static int vadpcm_ext4(int x) {
-    return x > 7 ? x - 16 : x;
-}
-
-// Clamp an integer to a 16-bit range.
-static int vadpcm_clamp16(int x) {
-    if (x < -0x8000 || 0x7fff < x) {
-        return (x >> (sizeof(int) * CHAR_BIT - 1)) ^ 0x7fff;
-    }
-    return x;
-}
-
-__attribute__((unused))
-static vadpcm_error vadpcm_decode(int predictor_count, int order,
-                           const wav64_vadpcm_vector_t *restrict codebook,
-                           wav64_vadpcm_vector_t *restrict state,
-                           size_t frame_count, int16_t *restrict dest,
-                           const void *restrict src) {
-    const uint8_t *sptr = src;
-    for (size_t frame = 0; frame < frame_count; frame++) {
-        const uint8_t *fin = sptr + 9 * frame;
-
-        // Control byte: scaling & predictor index.
-        int control = fin[0];
-        int scaling = control >> 4;
-        int predictor_index = control & 15;
-        if (predictor_index >= predictor_count) {
-            return kVADPCMErrInvalidData;
-        }
-        const wav64_vadpcm_vector_t *predictor =
-            codebook + order * predictor_index;
-
-        // Decode each of the two vectors within the frame.
-        for (int vector = 0; vector < 2; vector++) {
-            int32_t accumulator[8];
-            for (int i = 0; i < 8; i++) {
-                accumulator[i] = 0;
-            }
-
-            // Accumulate the part of the predictor from the previous block.
-            for (int k = 0; k < order; k++) {
-                int sample = state->v[8 - order + k];
-                for (int i = 0; i < 8; i++) {
-                    accumulator[i] += sample * predictor[k].v[i];
-                }
-            }
-
-            // Decode the ADPCM residual.
-            int residuals[8];
-            for (int i = 0; i < 4; i++) {
-                int byte = fin[1 + 4 * vector + i];
-                residuals[2 * i] = vadpcm_ext4(byte >> 4);
-                residuals[2 * i + 1] = vadpcm_ext4(byte & 15);
-            }
-
-            // Accumulate the residual and predicted values.
-            const wav64_vadpcm_vector_t *v = &predictor[order - 1];
-            for (int k = 0; k < 8; k++) {
-                int residual = residuals[k] << scaling;
-                accumulator[k] += residual << 11;
-                for (int i = 0; i < 7 - k; i++) {
-                    accumulator[k + 1 + i] += residual * v->v[i];
-                }
-            }
-
-            // Discard fractional part and clamp to 16-bit range.
-            for (int i = 0; i < 8; i++) {
-                int sample = vadpcm_clamp16(accumulator[i] >> 11);
-                dest[16 * frame + 8 * vector + i] = sample;
-                state->v[i] = sample;
-            }
-        }
-    }
-    return 0;
-}
+#include "vadpcm_internal.h"
 #else
 
 static inline void rsp_vadpcm_decompress(void *input, int16_t *output, bool stereo, int nframes, 
@@ -153,11 +57,12 @@ void raw_waveform_read(samplebuffer_t *sbuf, int base_rom_addr, int wpos, int wl
 	int bytes = wlen << bps;
 
 	uint32_t t0 = TICKS_READ();
-	// Run the DMA transfer. We rely on libdragon's PI DMA function which works
-	// also for misaligned addresses and odd lengths.
+	// Run the DMA transfer through the DMA queue with high priority, so that
+	// streaming is not stalled by other queued transfers (eg: asset loading).
+	// The queue works also for misaligned addresses and odd lengths.
 	// The mixer/samplebuffer guarantees that ROM/RAM addresses are always
-	// on the same 2-byte phase, as the only requirement of dma_read.
-	dma_read(ram_addr, rom_addr, bytes);
+	// on the same 2-byte phase, as the only requirement of the queue.
+	dma_queue_read_wait(ram_addr, rom_addr, bytes, DMA_PRIORITY_HIGH);
 	__wav64_profile_dma += TICKS_READ() - t0;
 }
 
@@ -201,8 +106,8 @@ static void waveform_vadpcm_read(void *ctx, samplebuffer_t *sbuf, int wpos, int
 		int src_bytes = 9 * nframes * wav->wave.channels;
 		void *src = (void*)dest + ((nframes*16) << SAMPLES_BPS_SHIFT(sbuf)) - src_bytes;
 
-		// Fetch compressed data
-		dma_read(src, vhead->current_rom_addr, src_bytes);
+		// Fetch compressed data (with high priority, see raw_waveform_read)
+		dma_queue_read_wait(src, vhead->current_rom_addr, src_bytes, DMA_PRIORITY_HIGH);
 		vhead->current_rom_addr += src_bytes;
 
 		#if VADPCM_REFERENCE_DECODER
@@ -0,0 +1,132 @@
+/**
+ * @file bulk.c
+ * @brief Bulk memory copies and fills
+ * @ingroup bulk
+ */
+#include <string.h>
+#include "bulk.h"
+#include "rsp_compute.h"
+#include "compute_internal.h"
+#include "rdpq.h"
+#include "rdpq_mode.h"
+#include "rdpq_rect.h"
+#include "rdpq_attach.h"
+#include "../rdpq/rdpq_internal.h"
+#include "surface.h"
+#include "n64sys.h"
+#include "debug.h"
+#include "utils.h"
+
+/** @brief Width in pixels of the rows used for RDP fills (RGBA32, so 1 KiB per row) */
+#define RDP_FILL_WIDTH      256
+/** @brief Maximum number of rows filled with a single rectangle */
+#define RDP_FILL_MAX_ROWS   512
+
+/** @brief Fill with a 32-bit pattern using the CPU */
+static void cpu_memset32(uint8_t *dst, uint32_t pattern, size_t n)
+{
+    uint32_t *d = (uint32_t*)dst;
+    for (size_t i=0; i<n/4; i++)
+        d[i] = pattern;
+}
+
+void *bulk_memcpy(void *dst, const void *src, size_t n)
+{
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+
+    // The RSP DMA requires both addresses to be 8-byte aligned, so the
+    // buffers must have the same misalignment to be able to fix it up.
+    if (n < BULK_RSP_MIN_SIZE || !__rsp_compute_ovl_id || (((uint32_t)d ^ (uint32_t)s) & 7))
+        return memcpy(dst, src, n);
+    assertf(d + n <= s || s + n <= d, "bulk_memcpy: buffers overlap");
+
+    // Copy the head with the CPU, up to a cache line boundary in the
+    // destination. This way, the CPU and the RSP never write to the same
+    // cache line.
+    size_t head = -(uint32_t)d & 15;
+    memcpy(d, s, head);
+    d += head; s += head; n -= head;
+
+    size_t body = n & ~15;
+    rsp_compute_memcpy(d, s, body);
+    rspq_syncpoint_t fence = rsp_compute_fence();
+    rspq_flush();
+
+    // Copy the tail while the RSP is working
+    memcpy(d + body, s + body, n - body);
+    rsp_compute_fence_wait(fence);
+    return dst;
+}
+
+void *bulk_memset32(void *dst, uint32_t pattern, size_t n)
+{
+    assertf(((uint32_t)dst & 3) == 0, "bulk_memset32: buffer must be 4-byte aligned: %p", dst);
+    assertf((n & 3) == 0, "bulk_memset32: size must be a multiple of 4: %d", n);
+    uint8_t *d = dst;
+
+    if (n >= BULK_RDP_MIN_SIZE && __rdpq_inited) {
+        // The RDP color image must be 64-byte aligned
+        size_t head = -(uint32_t)d & 63;
+        cpu_memset32(d, pattern, head);
+        d += head; n -= head;
+
+        // Fill full rows of RDP_FILL_WIDTH pixels, in strips of at most
+        // RDP_FILL_MAX_ROWS rows (fill rectangle coordinates are 10.2 fixed point,
+        // so a single rectangle cannot reach 1024 rows).
+        size_t row_bytes = RDP_FILL_WIDTH * 4;
+        size_t rows = n / row_bytes;
+        size_t body = rows * row_bytes;
+        data_cache_hit_writeback_invalidate(d, body);
+
+        surface_t surf = surface_make_linear(d, FMT_RGBA32, RDP_FILL_WIDTH, MIN(rows, RDP_FILL_MAX_ROWS));
+        rdpq_attach(&surf, NULL);
+        rdpq_mode_push();
+            rdpq_set_mode_fill(color_from_packed32(pattern));
+            for (size_t y=0; y<rows; y+=RDP_FILL_MAX_ROWS) {
+                int h = MIN(rows - y, RDP_FILL_MAX_ROWS);
+                surf = surface_make_linear(d + y * row_bytes, FMT_RGBA32, RDP_FILL_WIDTH, h);
+                rdpq_set_color_image(&surf);
+                rdpq_fill_rectangle(0, 0, RDP_FILL_WIDTH, h);
+            }
+        rdpq_mode_pop();
+        rdpq_detach();
+
+        // Fill the tail while the RDP is working
+        cpu_memset32(d + body, pattern, n - body);
+        rspq_wait();
+        return dst;
+    }
+
+    if (n >= BULK_RSP_MIN_SIZE && __rsp_compute_ovl_id) {
+        size_t head = -(uint32_t)d & 15;
+        cpu_memset32(d, pattern, head);
+        d += head; n -= head;
+
+        size_t body = n & ~15;
+        rsp_compute_memset(d, pattern, body);
+        rspq_syncpoint_t fence = rsp_compute_fence();
+        rspq_flush();
+
+        cpu_memset32(d + body, pattern, n - body);
+        rsp_compute_fence_wait(fence);
+        return dst;
+    }
+
+    cpu_memset32(d, pattern, n);
+    return dst;
+}
+
+void *bulk_memset(void *dst, int c, size_t n)
+{
+    if (n < BULK_RSP_MIN_SIZE)
+        return memset(dst, c, n);
+
+    uint8_t *d = dst;
+    size_t head = -(uint32_t)d & 3;
+    memset(d, c, head);
+    size_t body = (n - head) & ~3;
+    bulk_memset32(d + head, (uint8_t)c * 0x01010101u, body);
+    memset(d + head + body, c, n - head - body);
+    return dst;
+}
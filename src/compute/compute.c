@@ -0,0 +1,142 @@
+/**
+ * @file compute.c
+ * @brief RSP compute offload
+ * @ingroup rsp_compute
+ */
+#include "rsp_compute.h"
+#include "compute_internal.h"
+#include "rspq.h"
+#include "n64sys.h"
+#include "debug.h"
+#include "utils.h"
+
+/** @brief Command that runs a kernel (the only command of a compute overlay) */
+#define COMPUTE_CMD_RUN     0x0
+
+DEFINE_RSP_UCODE(rsp_compute);
+
+/** @brief Overlay ID of the built-in kernels */
+uint32_t __rsp_compute_ovl_id = 0;
+
+void rsp_compute_init(void)
+{
+    if (__rsp_compute_ovl_id)
+        return;
+
+    rspq_init();
+    __rsp_compute_ovl_id = rspq_overlay_register(&rsp_compute);
+}
+
+void rsp_compute_close(void)
+{
+    if (!__rsp_compute_ovl_id)
+        return;
+
+    rspq_wait();
+    rspq_overlay_unregister(__rsp_compute_ovl_id);
+    __rsp_compute_ovl_id = 0;
+}
+
+void rsp_compute_dispatch(uint32_t ovl_id, int kernel, void *out, const void *in0,
+    const void *in1, int nbytes, uint32_t arg, const void *params)
+{
+    assertf(nbytes % 16 == 0, "size must be a multiple of 16: %d", nbytes);
+    assertf(((uint32_t)out & 7) == 0, "output buffer must be 8-byte aligned: %p", out);
+    assertf(((uint32_t)in0 & 7) == 0, "input buffer must be 8-byte aligned: %p", in0);
+    assertf(((uint32_t)in1 & 7) == 0, "input buffer must be 8-byte aligned: %p", in1);
+    assertf(((uint32_t)params & 7) == 0, "parameters must be 8-byte aligned: %p", params);
+    assertf(kernel >= 0 && kernel < 256, "invalid kernel index: %d", kernel);
+
+    if (nbytes == 0)
+        return;
+
+    // Make the inputs visible to the RSP, and make sure that no dirty cache
+    // line gets written back over the output while the RSP is writing it.
+    if (in0) data_cache_hit_writeback(in0, nbytes);
+    if (in1) data_cache_hit_writeback(in1, nbytes);
+    if (params) data_cache_hit_writeback(params, COMPUTE_PARAMS_SIZE);
+    data_cache_hit_writeback_invalidate(out, nbytes);
+
+    uint32_t out_addr = PhysicalAddr(out);
+    uint32_t in0_addr = in0 ? PhysicalAddr(in0) : 0;
+    uint32_t in1_addr = in1 ? PhysicalAddr(in1) : 0;
+    uint32_t params_addr = params ? PhysicalAddr(params) : 0;
+
+    // Commands are not preempted by the highpri queue, so split long
+    // dispatches to keep the latency of highpri work bounded.
+    while (nbytes > 0) {
+        int n = MIN(nbytes, COMPUTE_MAX_CMD_SIZE);
+        rspq_write(ovl_id, COMPUTE_CMD_RUN,
+            n,
+            ((uint32_t)kernel << 24) | in0_addr,
+            in1_addr,
+            out_addr,
+            arg,
+            params_addr);
+
+        out_addr += n;
+        if (in0_addr) in0_addr += n;
+        if (in1_addr) in1_addr += n;
+        nbytes -= n;
+    }
+}
+
+extern inline rspq_syncpoint_t rsp_compute_fence(void);
+extern inline void rsp_compute_fence_wait(rspq_syncpoint_t fence);
+
+void rsp_compute_memset(void *dst, uint32_t pattern, int nbytes)
+{
+    assertf(__rsp_compute_ovl_id, "rsp_compute_init() must be called first");
+    rsp_compute_dispatch(__rsp_compute_ovl_id, RSP_COMPUTE_MEMSET, dst, NULL, NULL, nbytes, pattern, NULL);
+}
+
+void rsp_compute_memcpy(void *dst, const void *src, int nbytes)
+{
+    assertf(__rsp_compute_ovl_id, "rsp_compute_init() must be called first");
+    rsp_compute_dispatch(__rsp_compute_ovl_id, RSP_COMPUTE_MEMCPY, dst, src, NULL, nbytes, 0, NULL);
+}
+
+void rsp_compute_saxpy(int16_t *out, float a, const int16_t *x, const int16_t *y, int count)
+{
+    assertf(__rsp_compute_ovl_id, "rsp_compute_init() must be called first");
+    int32_t a_fx = a * 65536.0f;
+    rsp_compute_dispatch(__rsp_compute_ovl_id, RSP_COMPUTE_SAXPY, out, x, y, count * sizeof(int16_t), a_fx, NULL);
+}
+
+void rsp_compute_transform(rsp_compute_vec4x2_t *out, const fm_mat4_fixed_t *mtx,
+    const rsp_compute_vec4x2_t *in, int count)
+{
+    _Static_assert(sizeof(fm_mat4_fixed_t) <= COMPUTE_PARAMS_SIZE, "matrix does not fit in the compute parameters");
+    assertf(__rsp_compute_ovl_id, "rsp_compute_init() must be called first");
+    rsp_compute_dispatch(__rsp_compute_ovl_id, RSP_COMPUTE_TRANSFORM, out, in, NULL, count * sizeof(rsp_compute_vec4x2_t), 0, mtx);
+}
+
+void rsp_compute_pack_vec3(rsp_compute_vec4x2_t *out, const fm_vec3_t *in, int count)
+{
+    for (int i=0; i<count; i++) {
+        rsp_compute_vec4x2_t *o = &out[i/2];
+        int base = (i & 1) * 4;
+        for (int j=0; j<4; j++) {
+            int32_t fixed = (j < 3 ? in[i].v[j] : 1.0f) * 65536.0f;
+            o->integer[base+j] = fixed >> 16;
+            o->fraction[base+j] = fixed & 0xFFFF;
+        }
+    }
+    if (count & 1) {
+        rsp_compute_vec4x2_t *o = &out[count/2];
+        for (int j=4; j<8; j++)
+            o->integer[j] = o->fraction[j] = 0;
+    }
+}
+
+void rsp_compute_unpack_vec4(fm_vec4_t *out, const rsp_compute_vec4x2_t *in, int count)
+{
+    for (int i=0; i<count; i++) {
+        const rsp_compute_vec4x2_t *v = &in[i/2];
+        int base = (i & 1) * 4;
+        for (int j=0; j<4; j++) {
+            int32_t fixed = ((int32_t)v->integer[base+j] << 16) | v->fraction[base+j];
+            out[i].v[j] = fixed * (1.0f / 65536.0f);
+        }
+    }
+}
@@ -0,0 +1,14 @@
+/**
+ * @file compute_internal.h
+ * @brief RSP compute offload (internal functions)
+ * @ingroup rsp_compute
+ */
+#ifndef __LIBDRAGON_COMPUTE_INTERNAL_H
+#define __LIBDRAGON_COMPUTE_INTERNAL_H
+
+#include <stdint.h>
+
+/** @brief Overlay ID of the built-in compute kernels (0 if not initialized) */
+extern uint32_t __rsp_compute_ovl_id;
+
+#endif
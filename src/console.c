@@ -36,11 +36,20 @@
  * code wishes to switch to the display subsystem, #console_clear should be called
  * to cleanly shut down the console support.
  *
+ * The console can also be used as a debug overlay on top of a game that
+ * renders with rdpq: initialize it with #console_init_overlay instead of
+ * #console_init (that would take over the display), and call
+ * #console_render_overlay every frame while attached to the framebuffer.
+ * The overlay draws the text with the RDP using a font atlas kept in memory,
+ * and keeps a rspq block per line, that is rebuilt only when the line
+ * changes, so that compositing the console costs very little CPU time.
+ *
  * @{
  */
 
 /* Prototypes */
 static void __console_render(void);
+extern const sprite_t *__graphics_default_font16(void);
 
 /** @brief Size of the console buffer in bytes */
 #define CONSOLE_SIZE        ((sizeof(char) * CONSOLE_WIDTH * CONSOLE_HEIGHT) + sizeof(char))
@@ -55,6 +64,18 @@ static int render_now;
 /** @brief True if the console output is sent to debug channel as well */
 static bool console_redirect_debug = true;
 
+_Static_assert(CONSOLE_HEIGHT <= 32, "dirty_lines must have a bit per console line");
+/** @brief Bitmask of all the console lines */
+#define ALL_LINES           ((uint32_t)(((uint64_t)1 << CONSOLE_HEIGHT) - 1))
+/** @brief Bitmask of the lines changed since the last #console_render_overlay */
+static uint32_t dirty_lines;
+/** @brief Font atlas used by the overlay (I4, all the glyphs of the built-in font) */
+static surface_t overlay_atlas;
+/** @brief Cached blocks drawing each line of the overlay (NULL if the line is empty) */
+static rspq_block_t *overlay_lines[CONSOLE_HEIGHT];
+/** @brief Position of the overlay used when recording #overlay_lines */
+static int overlay_x, overlay_y;
+
 /**
  * @brief Set the console rendering mode
  *
@@ -79,7 +100,8 @@ void console_set_render_mode(int mode)
  */
 #define move_buffer() \
     memmove(render_buffer, render_buffer + (sizeof(char) * CONSOLE_WIDTH), CONSOLE_SIZE - (CONSOLE_WIDTH * sizeof(char))); \
-    pos -= CONSOLE_WIDTH;
+    pos -= CONSOLE_WIDTH; \
+    dirty_lines = ALL_LINES;
 
 /**
  * @brief Newlib hook to allow printf/iprintf to appear on console
@@ -94,6 +116,7 @@ void console_set_render_mode(int mode)
 static int __console_write( char *buf, unsigned int len )
 {
     int pos = strlen(render_buffer);
+    int first_line = pos / CONSOLE_WIDTH;
 
     /* Redirect to stderr if requested for debugging purposes */
     if (console_redirect_debug)
@@ -157,6 +180,12 @@ static int __console_write( char *buf, unsigned int len )
 
     /* Cap off the end! */
     render_buffer[pos] = 0;
+
+    /* Track the lines to redraw in the overlay */
+    for(int y = first_line; y <= pos / CONSOLE_WIDTH && y < CONSOLE_HEIGHT; y++)
+    {
+        dirty_lines |= 1u << y;
+    }
     
     /* Out to screen! */
     if(render_now == RENDER_AUTOMATIC)
@@ -194,6 +223,66 @@ void console_init()
     graphics_set_default_font();
 }
 
+/**
+ * @brief Build the font atlas used by the overlay
+ *
+ * The built-in font is a RGBA16 sprite that uses only the lowest bit of
+ * each pixel. It is converted to I4, which is small enough to fit TMEM
+ * as a whole, so that it can be loaded once per frame.
+ */
+static void overlay_atlas_init(void)
+{
+    const sprite_t *font = __graphics_default_font16();
+    const uint16_t *src = (const uint16_t *)font->data;
+
+    overlay_atlas = surface_alloc(FMT_I4, font->width, font->height);
+    uint8_t *dst = overlay_atlas.buffer;
+
+    for(int y = 0; y < font->height; y++)
+    {
+        for(int x = 0; x < font->width; x += 2)
+        {
+            uint8_t hi = (src[y * font->width + x + 0] & 1) ? 0xF : 0x0;
+            uint8_t lo = (src[y * font->width + x + 1] & 1) ? 0xF : 0x0;
+            dst[y * overlay_atlas.stride + x / 2] = (hi << 4) | lo;
+        }
+    }
+}
+
+/**
+ * @brief Free a cached line block, once the RSP is done with it
+ */
+static void overlay_line_free(void *block)
+{
+    rspq_block_free(block);
+}
+
+/**
+ * @brief Initialize the console as an overlay
+ *
+ * Initialize the console without taking over the display, so that it can
+ * be drawn on top of the frames rendered by the application via
+ * #console_render_overlay. rdpq must be initialized.
+ *
+ * The console is configured in #RENDER_MANUAL mode, which must not be
+ * changed: the CPU renderer (#console_render) is not available in overlay mode.
+ */
+void console_init_overlay(void)
+{
+    render_buffer = malloc(CONSOLE_SIZE);
+
+    console_set_render_mode(RENDER_MANUAL);
+    console_clear();
+    console_set_debug(true);
+
+    /* Register ourselves with newlib */
+    stdio_t console_calls = { 0, __console_write, 0 };
+    hook_stdio_calls( &console_calls );
+
+    overlay_atlas_init();
+    overlay_x = overlay_y = 0;
+}
+
 /**
  * @brief Close the console
  *
@@ -209,6 +298,21 @@ void console_close()
         render_buffer = 0;
     }
 
+    if(overlay_atlas.buffer)
+    {
+        /* Make sure the RSP is not using the overlay anymore */
+        rspq_wait();
+        for(int y = 0; y < CONSOLE_HEIGHT; y++)
+        {
+            if(overlay_lines[y])
+            {
+                rspq_block_free(overlay_lines[y]);
+                overlay_lines[y] = NULL;
+            }
+        }
+        surface_free(&overlay_atlas);
+    }
+
     /* Unregister ourselves from newlib */
     stdio_t console_calls = { 0, __console_write, 0 };
     unhook_stdio_calls( &console_calls );
@@ -235,6 +339,7 @@ void console_clear()
 
     /* Remove all data */
     memset(render_buffer, 0, CONSOLE_SIZE);
+    dirty_lines = ALL_LINES;
     
     /* Should we display? */
     if(render_now == RENDER_AUTOMATIC)
@@ -307,6 +412,88 @@ void console_render()
     __console_render();
 }
 
+/**
+ * @brief Render the console as an overlay on the current rdpq target
+ *
+ * Draw the console text with the RDP on the surface currently attached
+ * to rdpq (see #rdpq_attach), on top of what was already drawn. The text
+ * has no background, so that the frame remains visible below it.
+ *
+ * Each console line is recorded in a rspq block, which is rebuilt only when
+ * the line changes (or when the overlay is moved), so this function is
+ * cheap to call every frame. The render mode is saved and restored around
+ * the overlay, so this can be called anywhere in the frame.
+ *
+ * The console must have been initialized with #console_init_overlay.
+ *
+ * @param[in] x
+ *            X coordinate of the top-left corner of the console
+ * @param[in] y
+ *            Y coordinate of the top-left corner of the console
+ * @param[in] color
+ *            Color of the text
+ */
+void console_render_overlay(int x, int y, color_t color)
+{
+    assertf(overlay_atlas.buffer, "console_render_overlay requires console_init_overlay");
+
+    /* Ensure data is flushed before rendering */
+    fflush( stdout );
+
+    if(x != overlay_x || y != overlay_y)
+    {
+        overlay_x = x;
+        overlay_y = y;
+        dirty_lines = ALL_LINES;
+    }
+
+    /* Rebuild the blocks of the lines that changed. Like the CPU renderer,
+     * stop at the end of the text. */
+    const sprite_t *font = __graphics_default_font16();
+    int end = strlen(render_buffer);
+    for(int l = 0; l < CONSOLE_HEIGHT && dirty_lines; l++)
+    {
+        if(!(dirty_lines & (1u << l))) { continue; }
+        dirty_lines &= ~(1u << l);
+
+        if(overlay_lines[l])
+        {
+            rspq_call_deferred(overlay_line_free, overlay_lines[l]);
+            overlay_lines[l] = NULL;
+        }
+
+        int len = end - l * CONSOLE_WIDTH;
+        if(len <= 0) { continue; }
+        if(len > CONSOLE_WIDTH) { len = CONSOLE_WIDTH; }
+
+        rspq_block_begin();
+        for(int i = 0; i < len; i++)
+        {
+            uint8_t ch = render_buffer[l * CONSOLE_WIDTH + i];
+            if(ch <= ' ' || ch >= font->hslices * font->vslices) { continue; }
+
+            int s = (ch % font->hslices) * 8;
+            int t = (ch / font->hslices) * 8;
+            int px = x + i * 8;
+            int py = y + l * 8;
+            rdpq_texture_rectangle_raw(TILE0, px, py, px + 8, py + 8, s, t, 1, 1);
+        }
+        overlay_lines[l] = rspq_block_end();
+    }
+
+    rdpq_mode_push();
+        rdpq_set_mode_standard();
+        rdpq_mode_combiner(RDPQ_COMBINER1((0,0,0,PRIM), (0,0,0,TEX0)));
+        rdpq_mode_alphacompare(1);
+        rdpq_set_prim_color(color);
+        rdpq_tex_upload(TILE0, &overlay_atlas, NULL);
+        for(int l = 0; l < CONSOLE_HEIGHT; l++)
+        {
+            if(overlay_lines[l]) { rspq_block_run(overlay_lines[l]); }
+        }
+    rdpq_mode_pop();
+}
+
 /**
  * @brief Send console output to debug channel
  *
@@ -9,6 +9,7 @@
 #include "interrupt.h"
 #include "debug.h"
 #include "regsinternal.h"
+#include "dma.h"
 
 /**
  * @defgroup dma DMA Controller
@@ -28,6 +29,10 @@
  * manipulating registers on a cartridge such as a gameshark.  Code should never
  * make raw 32-bit reads or writes in the cartridge domain as it could collide with
  * an in-progress DMA transfer or run into caching issues.
+ *
+ * To issue many transfers without waiting for each of them, submit them to the
+ * DMA queue with #dma_queue_read. Queued transfers are chained under interrupt
+ * in order of priority, and can notify their completion via callbacks.
  * @{
  */
 
@@ -46,6 +51,9 @@
 /** @brief Structure used to interact with the PI registers */
 static volatile struct PI_regs_s * const PI_regs = (struct PI_regs_s *)0xa4600000;
 
+/** @brief True if the DMA queue is in use (its PI interrupt handler has been registered) */
+static bool dma_queue_inited;
+
 static volatile int __dma_busy(void)
 {
     return PI_regs->status & (PI_STATUS_DMA_BUSY | PI_STATUS_IO_BUSY);
@@ -362,6 +370,10 @@ void dma_read_async(void *ram_pointer, unsigned long pi_address, unsigned long l
 
 /** 
  * @brief Wait until an async DMA or I/O transfer is finished.
+ * 
+ * This waits for the PI to be idle, so if the DMA queue is in use, it also
+ * waits for all queued transfers. Use #dma_req_wait to wait for a single
+ * queued transfer instead.
  */
 void dma_wait(void)
 {
@@ -374,6 +386,9 @@ void dma_wait(void)
  * 
  * This function performs a blocking read. See #dma_read_async for more information.
  * 
+ * If the DMA queue is in use, the read is submitted to it with #DMA_PRIORITY_HIGH
+ * (see #dma_queue_read_wait), so that it does not wait for queued transfers.
+ * 
  * @param[out] ram_address
  *             Pointer to a buffer in RDRAM to place read data
  * @param[in]  pi_address
@@ -390,6 +405,14 @@ void dma_wait(void)
 void dma_read(void *ram_address, unsigned long pi_address, unsigned long len)
 {
     pi_address = (pi_address | 0x10000000) & 0x1FFFFFFF;
+
+    // If the DMA queue is in use, go through it: otherwise, the PI interrupt
+    // would keep starting queued chunks, and we would wait for all of them.
+    if (dma_queue_inited) {
+        dma_queue_read_wait(ram_address, pi_address, len, DMA_PRIORITY_HIGH);
+        return;
+    }
+
     dma_read_async(ram_address, pi_address, len);
     dma_wait();
 }
@@ -419,6 +442,287 @@ void dma_write(const void * ram_address, unsigned long rom_address, unsigned lon
     dma_wait();
 }
 
+/**
+ * @name DMA request queue
+ * 
+ * The queue allows to submit many PI DMA reads at once, without waiting for
+ * each transfer to finish before issuing the next. Requests are chained from
+ * the PI interrupt, in order of priority. Transfers are split in chunks of
+ * #DMA_QUEUE_CHUNK bytes, so that a higher priority request (eg: audio streaming)
+ * never needs to wait for a large low priority transfer (eg: a level load) to
+ * finish: it will start as soon as the current chunk is done.
+ * 
+ * The queue coexists with the other DMA functions. Once the queue is in use,
+ * #dma_read goes through it with a high priority, so it only waits for the
+ * chunk in flight. The asynchronous functions wait for the current chunk to
+ * be finished, and the queue resumes once their transfer is done.
+ * @{
+ */
+
+/** @brief Maximum size of a single transfer issued by the queue */
+#define DMA_QUEUE_CHUNK     (16*1024)
+
+/** @brief Requests waiting to be transferred, sorted by priority */
+static dma_req_t *dma_queue_head;
+/** @brief Request whose chunk is currently being transferred (NULL if none) */
+static dma_req_t *dma_queue_busy;
+/** @brief Length of the chunk currently being transferred */
+static uint32_t dma_queue_busy_len;
+
+/** 
+ * @brief Calculate the length of the next chunk of a request
+ * 
+ * Odd-length transfers are only well-defined for lengths below 0x7F. So if
+ * the request has an odd length, the last chunk is made short enough,
+ * while all previous chunks keep the RDRAM address 8-byte aligned.
+ */
+static uint32_t dma_queue_chunk_len(dma_req_t *req)
+{
+    uint32_t left = req->len - req->done;
+    if (left & 1) {
+        uint32_t last = (left & 7) + 0x40;
+        if (left <= last)
+            return left;
+        left -= last;
+    }
+    return left < DMA_QUEUE_CHUNK ? left : DMA_QUEUE_CHUNK;
+}
+
+/**
+ * @brief Transfer the first bytes of a request with the CPU
+ * 
+ * PI DMA requires the RDRAM address to be 8-byte aligned. If it is not, the
+ * bytes up to the next 8-byte boundary are read via CPU I/O, like #dma_read_async
+ * does for misaligned transfers.
+ * 
+ * @note This function must be called with interrupts disabled.
+ */
+static void dma_queue_read_head(dma_req_t *req)
+{
+    union { uint64_t mem64; uint16_t mem16[4]; uint8_t mem8[8]; } val;
+    uint8_t *ram = (uint8_t*)(PhysicalAddr(req->ram_address + req->done) | 0xA0000000);
+    void *rom = (void*)((req->pi_address + req->done) | 0xA0000000);
+    uint32_t len = req->len - req->done;
+    int misalign = (uint32_t)ram & 7;
+
+    // Only uncached 64-bit accesses to RDRAM, to mimic DMA
+    uint64_t *ram0 = (uint64_t*)(ram - misalign);
+    val.mem64 = *ram0;
+
+    do {
+        if ((misalign & 1) || len == 1) {
+            val.mem8[misalign] = __io_read8(rom);
+            misalign += 1; rom += 1; len -= 1;
+        } else {
+            val.mem16[misalign/2] = __io_read16(rom);
+            misalign += 2; rom += 2; len -= 2;
+        }
+    } while (misalign < 8 && len > 0);
+
+    *ram0 = val.mem64;
+    req->done = req->len - len;
+}
+
+/** @brief Remove a completed request from the queue */
+static void dma_queue_remove(dma_req_t *req)
+{
+    // It might not be the head anymore, if a higher priority request was
+    // submitted in the meantime.
+    dma_req_t **prev = &dma_queue_head;
+    while (*prev != req) prev = &(*prev)->next;
+    *prev = req->next;
+}
+
+/** @brief Mark a request as completed and call its callback */
+static void dma_queue_complete(dma_req_t *req)
+{
+    req->state = DMA_REQ_DONE;
+    if (req->callback)
+        req->callback(req);
+}
+
+/**
+ * @brief Advance the queue if the PI is idle
+ * 
+ * Completes the chunk in flight (calling the request callback if it was the
+ * last one), and starts the next chunk of the highest priority request.
+ * 
+ * @note This function must be called with interrupts disabled.
+ */
+static void dma_queue_process(void)
+{
+    // If the PI is busy, a transfer is in progress (ours, or one started
+    // by the other DMA functions). We will be called again by the PI
+    // interrupt once it is done.
+    if (__dma_busy())
+        return;
+
+    dma_req_t *finished = NULL;
+    if (dma_queue_busy) {
+        dma_req_t *req = dma_queue_busy;
+        req->done += dma_queue_busy_len;
+        dma_queue_busy = NULL;
+        if (req->done == req->len) {
+            dma_queue_remove(req);
+            finished = req;
+        }
+    }
+
+    // Start the next chunk before running the callback, to keep the PI busy
+    while (dma_queue_head) {
+        dma_req_t *req = dma_queue_head;
+
+        if ((PhysicalAddr(req->ram_address) + req->done) & 7) {
+            dma_queue_read_head(req);
+            if (req->done == req->len) {
+                // The request was short enough to be fully read by the CPU
+                dma_queue_remove(req);
+                dma_queue_complete(req);
+                continue;
+            }
+        }
+
+        dma_queue_busy = req;
+        dma_queue_busy_len = dma_queue_chunk_len(req);
+        MEMORY_BARRIER();
+        PI_regs->ram_address = UncachedAddr(req->ram_address + req->done);
+        MEMORY_BARRIER();
+        PI_regs->pi_address = req->pi_address + req->done;
+        MEMORY_BARRIER();
+        PI_regs->write_length = dma_queue_busy_len-1;
+        MEMORY_BARRIER();
+        break;
+    }
+
+    if (finished)
+        dma_queue_complete(finished);
+}
+
+/** @brief PI interrupt handler for the DMA queue */
+static void dma_queue_interrupt(void)
+{
+    dma_queue_process();
+}
+
+/**
+ * @brief Submit a PI DMA read to the queue
+ * 
+ * The request is transferred asynchronously, after all pending requests with the
+ * same or higher priority. Use #dma_req_wait to wait for it, or set a callback
+ * in the request to be notified under interrupt.
+ * 
+ * Like #dma_read_async, any length is accepted, and the RDRAM and PI addresses
+ * can be misaligned as long as they have the same 1-bit misalignment. The first
+ * bytes up to 8-byte aligning the RDRAM address are read with the CPU when the
+ * request is started. The destination buffer is written via DMA, so it must be
+ * invalidated from the data cache by the caller (eg: using
+ * #data_cache_hit_writeback_invalidate) before submitting it.
+ * 
+ * @param req       Request to submit (must stay valid until it is completed)
+ */
+void dma_queue_read(dma_req_t *req)
+{
+    assert(req->len > 0);
+    assertf((((uint32_t)req->ram_address ^ req->pi_address) & 1) == 0,
+        "RDRAM and PI addresses must have the same 1-bit misalignment: %p %08lx", req->ram_address, req->pi_address);
+    assertf(((uint32_t)req->ram_address & 7) == 0 || io_accessible(req->pi_address),
+        "misaligned transfer not supported at this PI address: %08lx", req->pi_address);
+
+    disable_interrupts();
+
+    if (!dma_queue_inited) {
+        register_PI_handler(dma_queue_interrupt);
+        set_PI_interrupt(1);
+        dma_queue_inited = true;
+    }
+
+    req->state = DMA_REQ_PENDING;
+    req->done = 0;
+
+    // Insert after all requests with the same or higher priority
+    dma_req_t **prev = &dma_queue_head;
+    while (*prev && (*prev)->priority >= req->priority)
+        prev = &(*prev)->next;
+    req->next = *prev;
+    *prev = req;
+
+    dma_queue_process();
+
+    enable_interrupts();
+}
+
+/**
+ * @brief Check whether a queued DMA request is completed
+ * 
+ * @param req       Request to check
+ * @return          True if the transfer is finished
+ */
+bool dma_req_done(dma_req_t *req)
+{
+    return req->state == DMA_REQ_DONE;
+}
+
+/**
+ * @brief Wait until a queued DMA request is completed
+ * 
+ * This function can also be called with interrupts disabled: in that case,
+ * the queue is advanced by polling the PI status.
+ * 
+ * @param req       Request to wait for
+ */
+void dma_req_wait(dma_req_t *req)
+{
+    assert(req->state != DMA_REQ_IDLE);
+    while (req->state != DMA_REQ_DONE) {
+        disable_interrupts();
+        dma_queue_process();
+        enable_interrupts();
+    }
+}
+
+/**
+ * @brief Read data through the DMA queue, waiting for completion
+ * 
+ * This is a blocking read like #dma_read, but it is submitted to the DMA queue
+ * with the specified priority. So it does not wait for queued transfers with
+ * a lower priority (apart from the chunk currently in flight), and it does not
+ * get interleaved with queued transfers with the same or higher priority.
+ * 
+ * @param[out] ram_address
+ *             Pointer to a buffer in RDRAM to place read data
+ * @param[in]  pi_address
+ *             PI address to read from
+ * @param[in]  len
+ *             Length in bytes to read into ram_address
+ * @param[in]  priority
+ *             Priority of the request (see #DMA_PRIORITY_NORMAL and #DMA_PRIORITY_HIGH)
+ */
+void dma_queue_read_wait(void *ram_address, uint32_t pi_address, uint32_t len, int priority)
+{
+    dma_req_t req = {
+        .ram_address = ram_address,
+        .pi_address = pi_address,
+        .len = len,
+        .priority = priority,
+    };
+    dma_queue_read(&req);
+    dma_req_wait(&req);
+}
+
+/**
+ * @brief Wait until all queued DMA requests are completed
+ */
+void dma_queue_wait(void)
+{
+    while (dma_queue_head) {
+        disable_interrupts();
+        dma_queue_process();
+        enable_interrupts();
+    }
+}
+
+/** @} */
+
 /**
  * @brief Read a 32 bit integer from a peripheral using the CPU.
  *
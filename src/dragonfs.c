@@ -87,6 +87,27 @@ static uint32_t directory_top = 0;
 /** @brief Pointer to next directory entry set when doing a directory walk */
 static directory_entry_t *next_entry = 0;
 
+/** @brief True if file accesses must be logged (see #dfs_trace_log) */
+static bool trace_log = false;
+
+/**
+ * @brief Read data from cartspace through the DMA queue
+ *
+ * Reads are submitted with normal priority, so that latency-sensitive
+ * streaming (eg: audio) is not stalled behind filesystem accesses.
+ *
+ * @param[out] ram_loc
+ *             Pointer to RAM buffer to place the data
+ * @param[in]  cart_loc
+ *             Cartridge location (virtual or physical)
+ * @param[in]  len
+ *             Length in bytes to read
+ */
+static inline void dfs_dma_read(void *ram_loc, uint32_t cart_loc, uint32_t len)
+{
+    dma_queue_read_wait(ram_loc, (cart_loc | 0x10000000) & 0x1FFFFFFF, len, DMA_PRIORITY_NORMAL);
+}
+
 /**
  * @brief Read a sector from cartspace
  *
@@ -103,7 +124,7 @@ static inline void grab_sector(void *cart_loc, void *ram_loc)
     /* Make sure we have fresh cache */
     data_cache_hit_writeback_invalidate(ram_loc, SECTOR_SIZE);
 
-    dma_read((void *)(((uint32_t)ram_loc) & 0x1FFFFFFF), (uint32_t)cart_loc, SECTOR_SIZE);
+    dfs_dma_read(ram_loc, (uint32_t)cart_loc, SECTOR_SIZE);
 }
 
 /**
@@ -787,6 +808,11 @@ int dfs_open(const char * const path)
         return ret;
     }
 
+    if(trace_log)
+    {
+        debugf("dfs-trace: %s\n", path);
+    }
+
     /* We now have the pointer to the file entry */
     directory_entry_t t_node;
     grab_sector(dirent, &t_node);
@@ -989,8 +1015,7 @@ int dfs_read(void * const buf, int size, int count, uint32_t handle)
         else
             data_cache_hit_writeback_invalidate(buf, to_read);
 
-        dma_read((void *)(((uint32_t)buf) & 0x1FFFFFFF),
-            file->cart_start_loc + file->loc, to_read);
+        dfs_dma_read(buf, file->cart_start_loc + file->loc, to_read);
 
         file->loc += to_read;
         return to_read;
@@ -1014,7 +1039,7 @@ int dfs_read(void * const buf, int size, int count, uint32_t handle)
                so the cachelines are not shared with other variables. */
             data_cache_hit_invalidate(file->cached_data, CACHED_SIZE);
 
-            dma_read((void *)(((uint32_t)file->cached_data) & 0x1FFFFFFF),
+            dfs_dma_read(file->cached_data,
                 file->cart_start_loc + file->cached_loc, CACHED_SIZE);
         }
 
@@ -1085,6 +1110,11 @@ uint32_t dfs_rom_addr(const char *path)
         return 0;
     }
 
+    if(trace_log)
+    {
+        debugf("dfs-trace: %s\n", path);
+    }
+
     /* We now have the pointer to the file entry */
     directory_entry_t t_node;
     grab_sector(dirent, &t_node);
@@ -1093,6 +1123,25 @@ uint32_t dfs_rom_addr(const char *path)
     return get_start_location(&t_node);
 }
 
+/**
+ * @brief Enable or disable logging of file accesses
+ *
+ * When enabled, every file opened via #dfs_open (including through the
+ * "rom:/" filesystem) or located via #dfs_rom_addr is logged on the
+ * debug channel as "dfs-trace: <path>".
+ *
+ * The resulting log can be passed to mkdfs with the --trace option, which
+ * places files in the order they were first accessed, so that assets loaded
+ * together are contiguous in ROM.
+ *
+ * @param[in] enable
+ *            True to enable logging, false to disable it
+ */
+void dfs_trace_log(bool enable)
+{
+    trace_log = enable;
+}
+
 /**
  * @brief Return whether the end of file has been reached
  *
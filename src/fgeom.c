@@ -0,0 +1,205 @@
+/**
+ * @file fgeom.c
+ * @brief Vector, quaternion and matrix math for 3D graphics
+ * @ingroup fastmath
+ */
+#include "fgeom.h"
+#include "debug.h"
+
+void fm_quat_from_axis_angle(fm_quat_t *out, const fm_vec3_t *axis, float angle)
+{
+    float s = fm_sinf(angle * 0.5f);
+    float c = fm_cosf(angle * 0.5f);
+    *out = (fm_quat_t){{ axis->x * s, axis->y * s, axis->z * s, c }};
+}
+
+void fm_quat_mul(fm_quat_t *out, const fm_quat_t *a, const fm_quat_t *b)
+{
+    float x = a->w * b->x + a->x * b->w + a->y * b->z - a->z * b->y;
+    float y = a->w * b->y - a->x * b->z + a->y * b->w + a->z * b->x;
+    float z = a->w * b->z + a->x * b->y - a->y * b->x + a->z * b->w;
+    float w = a->w * b->w - a->x * b->x - a->y * b->y - a->z * b->z;
+    *out = (fm_quat_t){{ x, y, z, w }};
+}
+
+void fm_quat_rotate(fm_vec3_t *out, const fm_quat_t *q, const fm_vec3_t *v)
+{
+    // v' = v + 2w(q x v) + 2(q x (q x v)), which is cheaper than two
+    // quaternion multiplications.
+    const fm_vec3_t *qv = (const fm_vec3_t*)q;
+    fm_vec3_t t, u;
+    fm_vec3_cross(&t, qv, v);
+    fm_vec3_scale(&t, &t, 2.0f);
+    fm_vec3_cross(&u, qv, &t);
+    out->x = v->x + q->w * t.x + u.x;
+    out->y = v->y + q->w * t.y + u.y;
+    out->z = v->z + q->w * t.z + u.z;
+}
+
+void fm_quat_nlerp(fm_quat_t *out, const fm_quat_t *a, const fm_quat_t *b, float t)
+{
+    // Take the shortest path: q and -q represent the same rotation
+    float tb = fm_quat_dot(a, b) < 0 ? -t : t;
+    float ta = 1.0f - t;
+    fm_quat_t q = {{
+        a->x * ta + b->x * tb, a->y * ta + b->y * tb,
+        a->z * ta + b->z * tb, a->w * ta + b->w * tb,
+    }};
+    fm_quat_norm(out, &q);
+}
+
+void fm_mat4_identity(fm_mat4_t *out)
+{
+    *out = (fm_mat4_t){{
+        {1, 0, 0, 0},
+        {0, 1, 0, 0},
+        {0, 0, 1, 0},
+        {0, 0, 0, 1},
+    }};
+}
+
+void fm_mat4_mul(fm_mat4_t *out, const fm_mat4_t *a, const fm_mat4_t *b)
+{
+    // Work on a local copy so that out can alias a or b, and so that the
+    // compiler does not need to reload the inputs after each store.
+    fm_mat4_t r;
+    for (int j=0; j<4; j++) {
+        float b0 = b->m[j][0], b1 = b->m[j][1], b2 = b->m[j][2], b3 = b->m[j][3];
+        for (int i=0; i<4; i++)
+            r.m[j][i] = a->m[0][i] * b0 + a->m[1][i] * b1 + a->m[2][i] * b2 + a->m[3][i] * b3;
+    }
+    *out = r;
+}
+
+void fm_mat4_from_srt(fm_mat4_t *out, const fm_vec3_t *scale, const fm_quat_t *rot, const fm_vec3_t *pos)
+{
+    float sx = scale ? scale->x : 1, sy = scale ? scale->y : 1, sz = scale ? scale->z : 1;
+
+    if (rot) {
+        float x = rot->x, y = rot->y, z = rot->z, w = rot->w;
+        float xx = x*x, yy = y*y, zz = z*z;
+        float xy = x*y, xz = x*z, yz = y*z;
+        float wx = w*x, wy = w*y, wz = w*z;
+
+        out->m[0][0] = (1 - 2*(yy + zz)) * sx;
+        out->m[0][1] = (2*(xy + wz)) * sx;
+        out->m[0][2] = (2*(xz - wy)) * sx;
+        out->m[1][0] = (2*(xy - wz)) * sy;
+        out->m[1][1] = (1 - 2*(xx + zz)) * sy;
+        out->m[1][2] = (2*(yz + wx)) * sy;
+        out->m[2][0] = (2*(xz + wy)) * sz;
+        out->m[2][1] = (2*(yz - wx)) * sz;
+        out->m[2][2] = (1 - 2*(xx + yy)) * sz;
+    } else {
+        out->m[0][0] = sx; out->m[0][1] = 0;  out->m[0][2] = 0;
+        out->m[1][0] = 0;  out->m[1][1] = sy; out->m[1][2] = 0;
+        out->m[2][0] = 0;  out->m[2][1] = 0;  out->m[2][2] = sz;
+    }
+    out->m[0][3] = out->m[1][3] = out->m[2][3] = 0;
+
+    out->m[3][0] = pos ? pos->x : 0;
+    out->m[3][1] = pos ? pos->y : 0;
+    out->m[3][2] = pos ? pos->z : 0;
+    out->m[3][3] = 1;
+}
+
+void fm_mat4_affine_invert(fm_mat4_t *out, const fm_mat4_t *m)
+{
+    // Invert the upper 3x3 via the adjugate, then the translation is -R^-1 * t
+    float a00 = m->m[0][0], a01 = m->m[0][1], a02 = m->m[0][2];
+    float a10 = m->m[1][0], a11 = m->m[1][1], a12 = m->m[1][2];
+    float a20 = m->m[2][0], a21 = m->m[2][1], a22 = m->m[2][2];
+    float tx = m->m[3][0], ty = m->m[3][1], tz = m->m[3][2];
+
+    float c00 = a11*a22 - a12*a21;
+    float c01 = a02*a21 - a01*a22;
+    float c02 = a01*a12 - a02*a11;
+    float det = a00*c00 + a10*c01 + a20*c02;
+    assertf(det != 0, "matrix is not invertible");
+    float inv = 1.0f / det;
+
+    fm_mat4_t r;
+    r.m[0][0] = c00 * inv;
+    r.m[0][1] = c01 * inv;
+    r.m[0][2] = c02 * inv;
+    r.m[1][0] = (a12*a20 - a10*a22) * inv;
+    r.m[1][1] = (a00*a22 - a02*a20) * inv;
+    r.m[1][2] = (a02*a10 - a00*a12) * inv;
+    r.m[2][0] = (a10*a21 - a11*a20) * inv;
+    r.m[2][1] = (a01*a20 - a00*a21) * inv;
+    r.m[2][2] = (a00*a11 - a01*a10) * inv;
+    r.m[0][3] = r.m[1][3] = r.m[2][3] = 0;
+
+    r.m[3][0] = -(r.m[0][0]*tx + r.m[1][0]*ty + r.m[2][0]*tz);
+    r.m[3][1] = -(r.m[0][1]*tx + r.m[1][1]*ty + r.m[2][1]*tz);
+    r.m[3][2] = -(r.m[0][2]*tx + r.m[1][2]*ty + r.m[2][2]*tz);
+    r.m[3][3] = 1;
+    *out = r;
+}
+
+void fm_mat4_transform_vec3(const fm_mat4_t *m, const fm_vec3_t *in, int in_stride,
+    fm_vec4_t *out, int out_stride, int count)
+{
+    if (!in_stride) in_stride = sizeof(fm_vec3_t);
+    if (!out_stride) out_stride = sizeof(fm_vec4_t);
+
+    // Load the matrix in locals once: the VR4300 has 32 FPU registers, enough
+    // to keep all 16 elements live across the loop.
+    float m00 = m->m[0][0], m01 = m->m[0][1], m02 = m->m[0][2], m03 = m->m[0][3];
+    float m10 = m->m[1][0], m11 = m->m[1][1], m12 = m->m[1][2], m13 = m->m[1][3];
+    float m20 = m->m[2][0], m21 = m->m[2][1], m22 = m->m[2][2], m23 = m->m[2][3];
+    float m30 = m->m[3][0], m31 = m->m[3][1], m32 = m->m[3][2], m33 = m->m[3][3];
+
+    const uint8_t *src = (const uint8_t*)in;
+    uint8_t *dst = (uint8_t*)out;
+    for (int i=0; i<count; i++) {
+        const fm_vec3_t *v = (const fm_vec3_t*)src;
+        fm_vec4_t *o = (fm_vec4_t*)dst;
+        float x = v->x, y = v->y, z = v->z;
+        o->x = m00*x + m10*y + m20*z + m30;
+        o->y = m01*x + m11*y + m21*z + m31;
+        o->z = m02*x + m12*y + m22*z + m32;
+        o->w = m03*x + m13*y + m23*z + m33;
+        src += in_stride;
+        dst += out_stride;
+    }
+}
+
+void fm_mat4_transform_vec3_affine(const fm_mat4_t *m, const fm_vec3_t *in, int in_stride,
+    fm_vec3_t *out, int out_stride, int count)
+{
+    if (!in_stride) in_stride = sizeof(fm_vec3_t);
+    if (!out_stride) out_stride = sizeof(fm_vec3_t);
+
+    float m00 = m->m[0][0], m01 = m->m[0][1], m02 = m->m[0][2];
+    float m10 = m->m[1][0], m11 = m->m[1][1], m12 = m->m[1][2];
+    float m20 = m->m[2][0], m21 = m->m[2][1], m22 = m->m[2][2];
+    float m30 = m->m[3][0], m31 = m->m[3][1], m32 = m->m[3][2];
+
+    const uint8_t *src = (const uint8_t*)in;
+    uint8_t *dst = (uint8_t*)out;
+    for (int i=0; i<count; i++) {
+        const fm_vec3_t *v = (const fm_vec3_t*)src;
+        fm_vec3_t *o = (fm_vec3_t*)dst;
+        // Read all inputs before writing, in case the arrays alias in place
+        float x = v->x, y = v->y, z = v->z;
+        o->x = m00*x + m10*y + m20*z + m30;
+        o->y = m01*x + m11*y + m21*z + m31;
+        o->z = m02*x + m12*y + m22*z + m32;
+        src += in_stride;
+        dst += out_stride;
+    }
+}
+
+void fm_mat4_to_fixed(fm_mat4_fixed_t *out, const fm_mat4_t *m)
+{
+    const float *src = &m->m[0][0];
+    int16_t *integer = &out->integer[0][0];
+    uint16_t *fraction = &out->fraction[0][0];
+
+    for (int i=0; i<16; i++) {
+        int32_t fixed = src[i] * (1<<16);
+        integer[i] = fixed >> 16;
+        fraction[i] = fixed & 0xFFFF;
+    }
+}
@@ -645,6 +645,14 @@ void graphics_set_default_font( void )
     graphics_set_font_sprite( font );
 }
 
+/**
+ * @brief Return the built-in font, in RGBA16 format (used by the console overlay)
+ */
+const sprite_t *__graphics_default_font16( void )
+{
+    return (const sprite_t *)__font_data_16;
+}
+
 /**
  * @brief Set the current font. Should be set before using any of the draw function.
  * 
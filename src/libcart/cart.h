@@ -15,6 +15,21 @@
 extern "C" {
 #endif
 
+/* Number of sectors transferred per step of an asynchronous request */
+#define CART_CARD_CHUNK 8
+
+/* Asynchronous read request */
+typedef struct cart_card_req
+{
+    struct cart_card_req *next;
+    void *dram;             /* Destination in RDRAM (NULL: use cart) */
+    uint32_t cart;          /* Destination in cartridge SDRAM */
+    uint32_t lba;           /* Next sector to read */
+    uint32_t count;         /* Sectors left to read */
+    volatile int result;    /* 1: pending, 0: done, -1: error */
+}
+cart_card_req_t;
+
 /* PI BSD configuration */
 extern uint32_t cart_dom1;
 extern uint32_t cart_dom2;
@@ -38,6 +53,18 @@ extern int cart_card_byteswap(int flag);
 extern int cart_card_rd_dram(void *dram, uint32_t lba, uint32_t count);
 /* Read sectors from card to cartridge SDRAM */
 extern int cart_card_rd_cart(uint32_t cart, uint32_t lba, uint32_t count);
+/* Queue an asynchronous read of sectors from card to system RDRAM */
+extern int cart_card_rd_dram_async(
+    cart_card_req_t *req, void *dram, uint32_t lba, uint32_t count
+);
+/* Queue an asynchronous read of sectors from card to cartridge SDRAM */
+extern int cart_card_rd_cart_async(
+    cart_card_req_t *req, uint32_t cart, uint32_t lba, uint32_t count
+);
+/* Perform up to max sectors of queued I/O, return number of pending requests */
+extern int cart_card_poll(uint32_t max);
+/* Perform queued I/O until the request is complete, return its result */
+extern int cart_card_wait(cart_card_req_t *req);
 /* Write sectors from system RDRAM to card */
 extern int cart_card_wr_dram(const void *dram, uint32_t lba, uint32_t count);
 /* Write sectors from cartridge SDRAM to card */
@@ -5,6 +5,7 @@
 #include "model64.h"
 #include "model64_internal.h"
 #include "asset.h"
+#include "arena.h"
 #include "debug.h"
 
 #define PTR_DECODE(model, ptr)    ((void*)(((uint8_t*)(model)) + (uint32_t)(ptr)))
@@ -43,7 +44,9 @@ model64_t *model64_load(const char *fn)
     int sz;
     void *buf = asset_load(fn, &sz);
     model64_t *model = model64_load_buf(buf, sz);
-    model->magic = MODEL64_MAGIC_OWNED;
+    // Models allocated from an arena are released together with it
+    if (!arena_get_current())
+        model->magic = MODEL64_MAGIC_OWNED;
     return model;
 }
 
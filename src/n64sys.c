@@ -9,6 +9,7 @@
 #include <malloc.h>
 #include "n64sys.h"
 #include "utils.h"
+#include "uncached_pool_internal.h"
 
 /**
  * @defgroup n64sys N64 System Interface
@@ -214,6 +215,9 @@ void inst_cache_invalidate_all(void)
  * 
  * To free the buffer, use #free_uncached.
  * 
+ * If a default uncached pool has been installed via #uncached_pool_set_default,
+ * the buffer is allocated from it instead of the heap.
+ * 
  * @param[in]  size  The size of the buffer to allocate
  *
  * @return a pointer to the start of the buffer (in the uncached segment)
@@ -241,6 +245,10 @@ void *malloc_uncached(size_t size)
  */
 void *malloc_uncached_aligned(int align, size_t size)
 {
+    // If the application installed a default pool, serve the request from it.
+    if (__uncached_pool_default)
+        return uncached_pool_alloc_aligned(__uncached_pool_default, align < 16 ? 16 : align, size);
+
     // Since we will be accessing the buffer as uncached memory, we absolutely
     // need to prevent part of it to ever enter the data cache, even as false
     // sharing with contiguous buffers. So we want the buffer to exclusively
@@ -265,6 +273,7 @@ void *malloc_uncached_aligned(int align, size_t size)
  * @brief Free an uncached memory buffer
  * 
  * This function frees a memory buffer previously allocated via #malloc_uncached.
+ * Buffers served by an uncached pool are returned to their pool.
  * 
  * @param[in]  buf  The buffer to free
  * 
@@ -272,6 +281,8 @@ void *malloc_uncached_aligned(int align, size_t size)
  */
 void free_uncached(void *buf)
 {
+    if (!buf) return;
+    if (__uncached_pool_release_any(buf)) return;
     free(CachedAddr(buf));
 }
 
@@ -582,6 +582,9 @@ static void rdpq_assert_handler(rsp_snapshot_t *state, uint16_t assert_code)
 /** @brief Autosync engine: mark certain resources as in use */
 extern inline void __rdpq_autosync_use(uint32_t res);
 
+/** @brief Mark the current contents of TMEM as known to their user */
+extern inline void __rdpq_tmem_acknowledge(void);
+
 /** 
  * @brief Autosync engine: mark certain resources as being changed.
  * 
@@ -592,6 +595,8 @@ extern inline void __rdpq_autosync_use(uint32_t res);
  * The SYNC command will then reset the "use" status of each respective resource.
  */
 void __rdpq_autosync_change(uint32_t res) {
+    if (res & AUTOSYNC_TMEMS)
+        rdpq_tracking.tmem_changed = 2;
     res &= rdpq_tracking.autosync;
     if (res) {
         if ((res & AUTOSYNC_TILES) && (rdpq_config & RDPQ_CFG_AUTOSYNCTILE))
@@ -762,6 +767,8 @@ void __rdpq_block_run(rdpq_block_t *block)
             rdpq_tracking.cycle_type_known = prev.cycle_type_known;
         if (rdpq_tracking.cycle_type_frozen == 0)
             rdpq_tracking.cycle_type_frozen = prev.cycle_type_frozen;
+        if (rdpq_tracking.tmem_changed == 0)
+            rdpq_tracking.tmem_changed = prev.tmem_changed;
     } else {
         // Initialize tracking state for unknown state
         rdpq_tracking = (rdpq_tracking_t){
@@ -777,6 +784,9 @@ void __rdpq_block_run(rdpq_block_t *block)
             // we don't know the cycle type after we run the block
             .cycle_type_known = 0,
             .cycle_type_frozen = 0,
+            // we don't know whether TMEM will have been changed when the
+            // block will play
+            .tmem_changed = 0,
         };
     }
 }
@@ -12,6 +12,9 @@
 #include "rspq.h"
 #include "display.h"
 #include "debug.h"
+#include "surface.h"
+#include "utils.h"
+#include <malloc.h>
 
 /** @brief Size of the internal stack of attached surfaces */
 #define ATTACH_STACK_SIZE   4
@@ -146,6 +149,106 @@ const surface_t* rdpq_get_attached(void)
     }
 }
 
+/** @brief A surface owned by the render target pool */
+typedef struct rt_pool_entry_s {
+    surface_t surface;                  ///< The surface (must be the first field)
+    bool in_use;                        ///< True from #rdpq_rt_acquire until the RDP is done with it
+    bool released;                      ///< True from #rdpq_rt_release until it is acquired again
+    struct rt_pool_entry_s *next;       ///< Next entry in the pool
+} rt_pool_entry_t;
+
+/** @brief List of the surfaces in the render target pool */
+static rt_pool_entry_t *rt_pool = NULL;
+/** @brief Statistics of the render target pool */
+static rdpq_rt_stats_t rt_stats;
+
+static int rt_size(const surface_t *surf)
+{
+    return surf->stride * surf->height;
+}
+
+static void rt_recycle(void *arg)
+{
+    rt_pool_entry_t *entry = arg;
+    rt_stats.num_in_use--;
+    rt_stats.memory_in_use -= rt_size(&entry->surface);
+    entry->in_use = false;
+}
+
+surface_t* rdpq_rt_acquire(tex_format_t format, uint16_t width, uint16_t height)
+{
+    rt_pool_entry_t *entry;
+
+    for (entry = rt_pool; entry; entry = entry->next) {
+        if (!entry->in_use && surface_get_format(&entry->surface) == format &&
+            entry->surface.width == width && entry->surface.height == height)
+            break;
+    }
+
+    if (!entry) {
+        entry = malloc(sizeof(rt_pool_entry_t));
+        assertf(entry, "out of memory allocating a render target");
+        entry->surface = surface_alloc(format, width, height);
+        assertf(entry->surface.buffer, "out of memory allocating a %dx%d render target (format: %s)",
+            width, height, tex_format_name(format));
+        entry->next = rt_pool;
+        rt_pool = entry;
+
+        rt_stats.num_surfaces++;
+        rt_stats.memory += rt_size(&entry->surface);
+        rt_stats.peak_memory = MAX(rt_stats.peak_memory, rt_stats.memory);
+    }
+
+    entry->in_use = true;
+    entry->released = false;
+    rt_stats.num_in_use++;
+    rt_stats.memory_in_use += rt_size(&entry->surface);
+    rt_stats.peak_memory_in_use = MAX(rt_stats.peak_memory_in_use, rt_stats.memory_in_use);
+    return &entry->surface;
+}
+
+void rdpq_rt_release(surface_t *surf)
+{
+    rt_pool_entry_t *entry = (rt_pool_entry_t*)surf;
+#ifndef NDEBUG
+    rt_pool_entry_t *e = rt_pool;
+    while (e && e != entry) e = e->next;
+    assertf(e, "Surface %p was not acquired from the render target pool", surf);
+    assertf(!entry->released, "Render target %p released twice", surf);
+    for (int i=0; i<attach_stack_ptr; i++)
+        assertf(attach_stack[i][0] != surf && attach_stack[i][1] != surf,
+            "Render target %p released while still attached", surf);
+#endif
+
+    // The surface might still be read by RDP commands enqueued until now
+    // (eg: as a texture), so it can be reused only after they are done.
+    // in_use is cleared only then, so track the release itself separately.
+    entry->released = true;
+    rdpq_call_deferred(rt_recycle, entry);
+}
+
+void rdpq_rt_trim(void)
+{
+    rt_pool_entry_t **prev = &rt_pool;
+    while (*prev) {
+        rt_pool_entry_t *entry = *prev;
+        if (entry->in_use) {
+            prev = &entry->next;
+            continue;
+        }
+        *prev = entry->next;
+        rt_stats.num_surfaces--;
+        rt_stats.memory -= rt_size(&entry->surface);
+        surface_free(&entry->surface);
+        free(entry);
+    }
+}
+
+rdpq_rt_stats_t rdpq_rt_get_stats(void)
+{
+    return rt_stats;
+}
+
 /* Extern inline instantiations. */
 extern inline void rdpq_clear(color_t color);
 extern inline void rdpq_clear_z(uint16_t z);
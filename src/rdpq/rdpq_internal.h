@@ -56,6 +56,14 @@ typedef struct {
     /** @brief 0=unknown, 1=standard, 2=copy/fill  */
     uint8_t cycle_type_known : 2;
     uint8_t cycle_type_frozen : 2;
+    /** 
+     * @brief 0=unknown, 1=unchanged, 2=changed: whether TMEM was written since the
+     *        last time its contents were acknowledged (see #__rdpq_tmem_acknowledge).
+     * 
+     * This is used by subsystems that keep track of what is resident in TMEM (eg: GL),
+     * to notice that a plain rdpq load (eg: #rdpq_tex_upload) overwrote it.
+     */
+    uint8_t tmem_changed : 2;
 } rdpq_tracking_t;
 
 extern rdpq_tracking_t rdpq_tracking;
@@ -122,6 +130,12 @@ inline void __rdpq_autosync_use(uint32_t res)
 }
 void __rdpq_autosync_change(uint32_t res);
 
+/** @brief Mark the current contents of TMEM as known to their user (see #rdpq_tracking_t) */
+inline void __rdpq_tmem_acknowledge(void)
+{
+    rdpq_tracking.tmem_changed = 1;
+}
+
 void __rdpq_write8(uint32_t cmd_id, uint32_t arg0, uint32_t arg1);
 void __rdpq_write16(uint32_t cmd_id, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3);
 
@@ -0,0 +1,323 @@
+/**
+ * @file rdpq_occlusion.c
+ * @brief RDP Command queue: coarse occlusion culling
+ * @ingroup rdpq
+ *
+ * Occluders are rasterized into cells with a coverage mask of one bit per pixel
+ * (sampled at the pixel center, like the RDP does), so that a cell is
+ * considered occluded also when it is covered by multiple triangles (eg: the
+ * cells along the diagonal of a quad). Each cell has two layers, following the
+ * "masked occlusion culling" approach: the committed layer is the farthest
+ * depth of geometry that completely covers the cell, while the working layer
+ * accumulates partial coverage together with its farthest depth. When the
+ * working layer becomes fully covered, it is merged into the committed one.
+ * Only the committed layer is used for the tests.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include "rdpq_occlusion.h"
+#include "utils.h"
+#include "debug.h"
+
+/** @brief Depth of an empty cell (nothing can be hidden behind it) */
+#define DEPTH_EMPTY     FLT_MAX
+
+_Static_assert(RDPQ_OCCLUSION_CELL_SIZE * RDPQ_OCCLUSION_CELL_SIZE == 64, "coverage masks must be 64-bit");
+
+/** @brief Occlusion buffer */
+typedef struct rdpq_occlusion_s {
+    int width, height;              ///< Size of the screen area in pixels
+    int cw, ch;                     ///< Size of the buffer in cells
+    int tw, th;                     ///< Size of the buffer in tiles
+    float *cells;                   ///< Per-cell committed depth (farthest depth of the geometry covering it)
+    float *tiles;                   ///< Per-tile farthest committed depth of its cells
+    float *work_depth;              ///< Per-cell farthest depth of the working layer
+    uint64_t *work_mask;            ///< Per-cell coverage mask of the working layer
+    rdpq_occlusion_stats_t stats;   ///< Statistics since the last clear
+} rdpq_occlusion_t;
+
+rdpq_occlusion_t* rdpq_occlusion_alloc(int width, int height)
+{
+    assertf(width > 0 && height > 0, "invalid occlusion buffer size: %dx%d", width, height);
+
+    rdpq_occlusion_t *occ = malloc(sizeof(rdpq_occlusion_t));
+    occ->width = width;
+    occ->height = height;
+    occ->cw = DIVIDE_CEIL(width, RDPQ_OCCLUSION_CELL_SIZE);
+    occ->ch = DIVIDE_CEIL(height, RDPQ_OCCLUSION_CELL_SIZE);
+    occ->tw = DIVIDE_CEIL(occ->cw, RDPQ_OCCLUSION_TILE_CELLS);
+    occ->th = DIVIDE_CEIL(occ->ch, RDPQ_OCCLUSION_TILE_CELLS);
+    occ->cells = malloc(occ->cw * occ->ch * sizeof(float));
+    occ->tiles = malloc(occ->tw * occ->th * sizeof(float));
+    occ->work_depth = malloc(occ->cw * occ->ch * sizeof(float));
+    occ->work_mask = malloc(occ->cw * occ->ch * sizeof(uint64_t));
+    rdpq_occlusion_clear(occ);
+    return occ;
+}
+
+void rdpq_occlusion_free(rdpq_occlusion_t *occ)
+{
+    free(occ->work_mask);
+    free(occ->work_depth);
+    free(occ->tiles);
+    free(occ->cells);
+    free(occ);
+}
+
+void rdpq_occlusion_clear(rdpq_occlusion_t *occ)
+{
+    for (int i = 0; i < occ->cw * occ->ch; i++) {
+        occ->cells[i] = DEPTH_EMPTY;
+        occ->work_depth[i] = 0;
+        occ->work_mask[i] = 0;
+    }
+    for (int i = 0; i < occ->tw * occ->th; i++)
+        occ->tiles[i] = DEPTH_EMPTY;
+    memset(&occ->stats, 0, sizeof(occ->stats));
+}
+
+rdpq_occlusion_stats_t rdpq_occlusion_get_stats(rdpq_occlusion_t *occ)
+{
+    return occ->stats;
+}
+
+/** @brief Recalculate the depth of the tiles that contain the specified range of cells */
+static void update_tiles(rdpq_occlusion_t *occ, int cx0, int cy0, int cx1, int cy1)
+{
+    for (int ty = cy0 / RDPQ_OCCLUSION_TILE_CELLS; ty <= cy1 / RDPQ_OCCLUSION_TILE_CELLS; ty++) {
+        for (int tx = cx0 / RDPQ_OCCLUSION_TILE_CELLS; tx <= cx1 / RDPQ_OCCLUSION_TILE_CELLS; tx++) {
+            int x0 = tx * RDPQ_OCCLUSION_TILE_CELLS, x1 = MIN(x0 + RDPQ_OCCLUSION_TILE_CELLS, occ->cw);
+            int y0 = ty * RDPQ_OCCLUSION_TILE_CELLS, y1 = MIN(y0 + RDPQ_OCCLUSION_TILE_CELLS, occ->ch);
+            float zmax = 0;
+            for (int y = y0; y < y1; y++)
+                for (int x = x0; x < x1; x++)
+                    zmax = MAX(zmax, occ->cells[y * occ->cw + x]);
+            occ->tiles[ty * occ->tw + tx] = zmax;
+        }
+    }
+}
+
+/** @brief Merge the coverage of a triangle into a cell */
+static void merge_cell(rdpq_occlusion_t *occ, int idx, uint64_t mask, float z)
+{
+    if (mask == ~0ull) {
+        occ->cells[idx] = MIN(occ->cells[idx], z);
+        return;
+    }
+
+    // Partial coverage: geometry behind the committed layer does not matter
+    if (z >= occ->cells[idx])
+        return;
+    occ->work_mask[idx] |= mask;
+    occ->work_depth[idx] = MAX(occ->work_depth[idx], z);
+    if (occ->work_mask[idx] == ~0ull) {
+        occ->cells[idx] = MIN(occ->cells[idx], occ->work_depth[idx]);
+        occ->work_mask[idx] = 0;
+        occ->work_depth[idx] = 0;
+    }
+}
+
+void rdpq_occlusion_add_triangle(rdpq_occlusion_t *occ, const float *v1, const float *v2, const float *v3)
+{
+    const int cs = RDPQ_OCCLUSION_CELL_SIZE;
+
+    float area = (v2[0] - v1[0]) * (v3[1] - v1[1]) - (v2[1] - v1[1]) * (v3[0] - v1[0]);
+    if (area == 0) return;
+
+    // Range of cells touched by the bounding box
+    float minx = MIN(v1[0], MIN(v2[0], v3[0])), maxx = MAX(v1[0], MAX(v2[0], v3[0]));
+    float miny = MIN(v1[1], MIN(v2[1], v3[1])), maxy = MAX(v1[1], MAX(v2[1], v3[1]));
+    int cx0 = MAX((int)floorf(minx / cs), 0), cx1 = MIN((int)floorf(maxx / cs), occ->cw - 1);
+    int cy0 = MAX((int)floorf(miny / cs), 0), cy1 = MIN((int)floorf(maxy / cs), occ->ch - 1);
+    if (cx0 > cx1 || cy0 > cy1) return;
+
+    // Edge functions, oriented so that they are positive inside the triangle
+    // whatever the winding. e0 is their value at the top-left corner of the
+    // first cell.
+    const float *v[3] = { v1, v2, v3 };
+    float sign = area > 0 ? -1 : 1;
+    float e0[3], edx[3], edy[3], emin[3], emax[3];
+    for (int i = 0; i < 3; i++) {
+        const float *a = v[i], *b = v[(i+1) % 3];
+        edx[i] = (b[1] - a[1]) * sign;
+        edy[i] = -(b[0] - a[0]) * sign;
+        e0[i] = (cx0 * cs - a[0]) * edx[i] + (cy0 * cs - a[1]) * edy[i];
+        // Offsets from the top-left corner to the corners of a cell
+        // where the edge function has its minimum and maximum
+        emin[i] = MIN(edx[i] * cs, 0) + MIN(edy[i] * cs, 0);
+        emax[i] = MAX(edx[i] * cs, 0) + MAX(edy[i] * cs, 0);
+    }
+
+    // Depth plane. Since it is linear, the farthest point of each cell is
+    // one of its corners, and its offset from the top-left corner is constant.
+    // It is also clamped to the farthest vertex, for partially covered cells.
+    float dzdx = ((v2[2] - v1[2]) * (v3[1] - v1[1]) - (v3[2] - v1[2]) * (v2[1] - v1[1])) / area;
+    float dzdy = ((v3[2] - v1[2]) * (v2[0] - v1[0]) - (v2[2] - v1[2]) * (v3[0] - v1[0])) / area;
+    float z0 = v1[2] + (cx0 * cs - v1[0]) * dzdx + (cy0 * cs - v1[1]) * dzdy;
+    float zcell = MAX(dzdx * cs, 0) + MAX(dzdy * cs, 0);
+    float zmax = MAX(v1[2], MAX(v2[2], v3[2]));
+
+    for (int cy = cy0; cy <= cy1; cy++) {
+        float e[3] = { e0[0], e0[1], e0[2] };
+        float z = z0 + zcell;
+        for (int cx = cx0; cx <= cx1; cx++) {
+            uint64_t mask;
+            if (e[0] + emax[0] < 0 || e[1] + emax[1] < 0 || e[2] + emax[2] < 0) {
+                // Cell completely outside of one edge
+                mask = 0;
+            } else if (e[0] + emin[0] >= 0 && e[1] + emin[1] >= 0 && e[2] + emin[2] >= 0) {
+                // Cell completely inside the triangle
+                mask = ~0ull;
+            } else {
+                // Cell crossing one or more edges: sample each pixel center
+                mask = 0;
+                for (int py = 0; py < cs; py++) {
+                    float r0 = e[0] + (py + 0.5f) * edy[0] + 0.5f * edx[0];
+                    float r1 = e[1] + (py + 0.5f) * edy[1] + 0.5f * edx[1];
+                    float r2 = e[2] + (py + 0.5f) * edy[2] + 0.5f * edx[2];
+                    for (int px = 0; px < cs; px++) {
+                        if (r0 >= 0 && r1 >= 0 && r2 >= 0)
+                            mask |= 1ull << (py * cs + px);
+                        r0 += edx[0]; r1 += edx[1]; r2 += edx[2];
+                    }
+                }
+            }
+
+            if (mask)
+                merge_cell(occ, cy * occ->cw + cx, mask, MAX(MIN(z, zmax), 0));
+
+            e[0] += edx[0] * cs; e[1] += edx[1] * cs; e[2] += edx[2] * cs;
+            z += dzdx * cs;
+        }
+        e0[0] += edy[0] * cs; e0[1] += edy[1] * cs; e0[2] += edy[2] * cs;
+        z0 += dzdy * cs;
+    }
+
+    update_tiles(occ, cx0, cy0, cx1, cy1);
+}
+
+bool rdpq_occlusion_test_rect(rdpq_occlusion_t *occ, float x0, float y0, float x1, float y1, float zmin)
+{
+    const float cs = RDPQ_OCCLUSION_CELL_SIZE;
+
+    // Cells touched by the rectangle, clamped to the buffer. The range is
+    // inclusive, so a rectangle ending exactly on a cell boundary touches
+    // one more cell, which is conservative.
+    int cx0 = MAX((int)floorf(x0 / cs), 0), cx1 = MIN((int)floorf(x1 / cs), occ->cw - 1);
+    int cy0 = MAX((int)floorf(y0 / cs), 0), cy1 = MIN((int)floorf(y1 / cs), occ->ch - 1);
+    if (cx0 > cx1 || cy0 > cy1) return true;
+
+    for (int ty = cy0 / RDPQ_OCCLUSION_TILE_CELLS; ty <= cy1 / RDPQ_OCCLUSION_TILE_CELLS; ty++) {
+        for (int tx = cx0 / RDPQ_OCCLUSION_TILE_CELLS; tx <= cx1 / RDPQ_OCCLUSION_TILE_CELLS; tx++) {
+            // Fast path: all the cells of the tile are nearer
+            if (occ->tiles[ty * occ->tw + tx] < zmin)
+                continue;
+            int xs = MAX(tx * RDPQ_OCCLUSION_TILE_CELLS, cx0), xe = MIN((tx + 1) * RDPQ_OCCLUSION_TILE_CELLS - 1, cx1);
+            int ys = MAX(ty * RDPQ_OCCLUSION_TILE_CELLS, cy0), ye = MIN((ty + 1) * RDPQ_OCCLUSION_TILE_CELLS - 1, cy1);
+            for (int y = ys; y <= ye; y++)
+                for (int x = xs; x <= xe; x++)
+                    if (occ->cells[y * occ->cw + x] >= zmin)
+                        return true;
+        }
+    }
+    return false;
+}
+
+bool rdpq_occlusion_test_triangle(rdpq_occlusion_t *occ, const float *v1, const float *v2, const float *v3)
+{
+    float minx = MIN(v1[0], MIN(v2[0], v3[0])), maxx = MAX(v1[0], MAX(v2[0], v3[0]));
+    float miny = MIN(v1[1], MIN(v2[1], v3[1])), maxy = MAX(v1[1], MAX(v2[1], v3[1]));
+    float minz = MIN(v1[2], MIN(v2[2], v3[2]));
+
+    occ->stats.tris_tested++;
+    if (rdpq_occlusion_test_rect(occ, minx, miny, maxx, maxy, minz))
+        return true;
+
+    float area = (v2[0] - v1[0]) * (v3[1] - v1[1]) - (v2[1] - v1[1]) * (v3[0] - v1[0]);
+    occ->stats.tris_rejected++;
+    occ->stats.pixels_saved += fabsf(area) * 0.5f;
+    return false;
+}
+
+bool rdpq_occlusion_triangle(rdpq_occlusion_t *occ, const rdpq_trifmt_t *fmt,
+    const float *v1, const float *v2, const float *v3)
+{
+    assertf(fmt->z_offset >= 0, "rdpq_occlusion_triangle requires a depth component");
+
+    const int p = fmt->pos_offset, z = fmt->z_offset;
+    float p1[3] = { v1[p], v1[p+1], v1[z] };
+    float p2[3] = { v2[p], v2[p+1], v2[z] };
+    float p3[3] = { v3[p], v3[p+1], v3[z] };
+    if (!rdpq_occlusion_test_triangle(occ, p1, p2, p3))
+        return false;
+
+    rdpq_triangle(fmt, v1, v2, v3);
+    return true;
+}
+
+/**
+ * @brief Transform a vertex to screen space
+ *
+ * @return false if the vertex is behind the near plane, and thus cannot be projected
+ */
+static bool project(rdpq_occlusion_t *occ, const fm_mat4_t *mvp, const fm_vec3_t *v, float *out)
+{
+    fm_vec4_t clip;
+    fm_mat4_mul_vec3(&clip, mvp, v);
+    if (clip.w <= 0 || clip.z < -clip.w)
+        return false;
+
+    float inv_w = 1.0f / clip.w;
+    out[0] = (clip.x * inv_w * 0.5f + 0.5f) * occ->width;
+    out[1] = (0.5f - clip.y * inv_w * 0.5f) * occ->height;
+    out[2] = clip.z * inv_w * 0.5f + 0.5f;
+    return true;
+}
+
+void rdpq_occlusion_add_mesh(rdpq_occlusion_t *occ, const fm_mat4_t *mvp,
+    const fm_vec3_t *verts, const uint16_t *indices, int num_indices)
+{
+    for (int i = 0; i + 2 < num_indices; i += 3) {
+        float s[3][3];
+        if (!project(occ, mvp, &verts[indices[i+0]], s[0]) ||
+            !project(occ, mvp, &verts[indices[i+1]], s[1]) ||
+            !project(occ, mvp, &verts[indices[i+2]], s[2]))
+            continue;
+        rdpq_occlusion_add_triangle(occ, s[0], s[1], s[2]);
+    }
+}
+
+bool rdpq_occlusion_test_box(rdpq_occlusion_t *occ, const fm_mat4_t *mvp,
+    const fm_vec3_t *min, const fm_vec3_t *max)
+{
+    occ->stats.objects_tested++;
+
+    float minx = FLT_MAX, miny = FLT_MAX, minz = FLT_MAX;
+    float maxx = -FLT_MAX, maxy = -FLT_MAX;
+    for (int i = 0; i < 8; i++) {
+        fm_vec3_t corner = {{
+            (i & 1) ? max->x : min->x,
+            (i & 2) ? max->y : min->y,
+            (i & 4) ? max->z : min->z,
+        }};
+        float s[3];
+        if (!project(occ, mvp, &corner, s))
+            return true;
+        minx = MIN(minx, s[0]); maxx = MAX(maxx, s[0]);
+        miny = MIN(miny, s[1]); maxy = MAX(maxy, s[1]);
+        minz = MIN(minz, s[2]);
+    }
+
+    if (rdpq_occlusion_test_rect(occ, minx, miny, maxx, maxy, minz))
+        return true;
+
+    // Estimate the fill saved as the on-screen area of the bounding rectangle
+    float w = MIN(maxx, occ->width) - MAX(minx, 0);
+    float h = MIN(maxy, occ->height) - MAX(miny, 0);
+    occ->stats.objects_rejected++;
+    occ->stats.pixels_saved += MAX(w, 0) * MAX(h, 0);
+    return false;
+}
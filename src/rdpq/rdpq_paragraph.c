@@ -3,6 +3,7 @@
 #include "rdpq_font.h"
 #include "rdpq_font_internal.h"
 #include "debug.h"
+#include "arena.h"
 #include "fmath.h"
 #include <stdlib.h>
 #include <assert.h>
@@ -77,9 +78,12 @@ void rdpq_paragraph_builder_begin(const rdpq_textparms_t *parms, uint8_t initial
 
     if (!layout) {
         const int initial_chars = 256;
-        layout = malloc(sizeof(rdpq_paragraph_t) + sizeof(rdpq_paragraph_char_t) * initial_chars);
+        const int size = sizeof(rdpq_paragraph_t) + sizeof(rdpq_paragraph_char_t) * initial_chars;
+        arena_t *arena = arena_get_current();
+        layout = arena ? arena_alloc(arena, size, 8) : malloc(size);
         memset(layout, 0, sizeof(*layout));
         layout->capacity = initial_chars;
+        layout->arena_allocated = arena != NULL;
     }
     builder.layout = layout;
 
@@ -424,7 +428,7 @@ rdpq_paragraph_t* __rdpq_paragraph_build(const rdpq_textparms_t *parms, uint8_t
             } else {
                 bool error = false;
                 uint8_t font_id = must_hex_digit(buf[1], &error) << 4 | must_hex_digit(buf[2], &error);
-                assertf(!error, "invalid font id: %c%c at position %d", buf[1], buf[2], buf-utf8_text);
+                assertf(!error, "invalid font id: %c%c at position %d", buf[1], buf[2], (int)(buf-utf8_text));
                 assertf(font_id > 0, "invalid usage of font ID 0 (reserved)");
                 rdpq_paragraph_builder_font(font_id);
                 span = buf + 3;
@@ -441,7 +445,7 @@ rdpq_paragraph_t* __rdpq_paragraph_build(const rdpq_textparms_t *parms, uint8_t
             } else {
                 bool error = false;
                 uint8_t style_id = must_hex_digit(buf[1], &error) << 4 | must_hex_digit(buf[2], &error);
-                assertf(!error, "invalid style id: %c%c at position %d", buf[1], buf[2], buf-utf8_text);
+                assertf(!error, "invalid style id: %c%c at position %d", buf[1], buf[2], (int)(buf-utf8_text));
                 rdpq_paragraph_builder_style(style_id);
                 span = buf + 3;
                 buf = span;
@@ -489,6 +493,9 @@ void rdpq_paragraph_render(const rdpq_paragraph_t *layout, float x0, float y0)
 
 void rdpq_paragraph_free(rdpq_paragraph_t *layout)
 {
+    // Paragraphs allocated from an arena are released together with it
+    if (layout->arena_allocated)
+        return;
     #ifndef NDEBUG
     memset(layout, 0, sizeof(*layout));
     #endif
@@ -502,9 +509,13 @@ void __rdpq_paragraph_char_check_bitfield(void)
     // If this ever changes across GCC versions, we want to detect this: if the
     // sort key isn't made of font_id/atlas_id/style_id in this order, performance
     // will silently decrease a lot.
+    // The check only applies to big-endian targets: on little-endian hosts
+    // (see tests/host), the chars are just sorted in a different order.
+    #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
     rdpq_paragraph_char_t ch = {0};
     ch.font_id = 0xAA;
     ch.atlas_id = 0xBB;
     ch.style_id = 0xCC;
     assert((ch.sort_key & 0xFFFFFF00) == 0xAABBCC00);
+    #endif
 }
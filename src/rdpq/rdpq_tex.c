@@ -12,8 +12,12 @@
 #include "rdpq_rect.h"
 #include "rdpq_tex.h"
 #include "rdpq_tex_internal.h"
+#include "rspq.h"
+#include "rspq/rspq_internal.h"
+#include "n64sys.h"
 #include "utils.h"
 #include <math.h>
+#include <malloc.h>
 
 /** @brief Non-zero if we are doing a multi-texture upload */
 typedef struct rdpq_multi_upload_s {
@@ -313,12 +317,109 @@ static void texload_settile(tex_loader_t *tload, int s0, int t0, int s1, int t1)
     rdpq_set_tile_size_fx(tload->tile, s0, t0, s1, t1);
 }
 
+/**
+ * @brief Describe the RGBA16 surface that a block-compressed surface decodes to
+ * 
+ * The decoded surface is linear (stride = width * 2), so that LOAD_BLOCK
+ * can be used on it. @p buffer is the pointer to the decoded line @p t0;
+ * the returned surface buffer is offset backwards so that texture coordinates
+ * stay the same as in the compressed surface.
+ */
+static surface_t blockcomp_decoded_surface(const surface_t *tex, void *buffer, int t0)
+{
+    return (surface_t){
+        .flags = FMT_RGBA16,
+        .width = tex->width,
+        .height = tex->height,
+        .stride = tex->width * 2,
+        .buffer = buffer - t0 * tex->width * 2,
+    };
+}
+
+/**
+ * @brief Decode lines [t0, t1) of a block-compressed surface into a RGBA16 buffer
+ * 
+ * Each 4x4 block is 8 bytes: two RGBA5551 endpoints followed by 16 2-bit indices
+ * (row-major, first pixel in the top bits). If the first endpoint is greater than the
+ * second one, the indices 2 and 3 select colors interpolated at 1/3 and 2/3 between
+ * the endpoints; otherwise, index 2 is the average of the endpoints and index 3 is
+ * fully transparent. Blocks are stored row by row, with surface->stride bytes per
+ * row of blocks. t0 must be a multiple of 4.
+ */
+static void blockcomp_decode(const surface_t *tex, uint16_t *dst, int t0, int t1)
+{
+    int width = tex->width;
+    for (int by = t0; by < t1; by += 4) {
+        const uint32_t *blk = tex->buffer + (by / 4) * tex->stride;
+        int rows = MIN(4, t1 - by);
+        for (int bx = 0; bx < width; bx += 4, blk += 2) {
+            uint16_t c0 = blk[0] >> 16, c1 = blk[0] & 0xFFFF;
+            uint32_t idx = blk[1];
+            uint16_t pal[4] = { c0, c1, 0, 0 };
+
+            int r0 = c0 >> 11, g0 = (c0 >> 6) & 0x1F, b0 = (c0 >> 1) & 0x1F;
+            int r1 = c1 >> 11, g1 = (c1 >> 6) & 0x1F, b1 = (c1 >> 1) & 0x1F;
+            if (c0 > c1) {
+                pal[2] = (((2*r0+r1)/3) << 11) | (((2*g0+g1)/3) << 6) | (((2*b0+b1)/3) << 1) | 1;
+                pal[3] = (((r0+2*r1)/3) << 11) | (((g0+2*g1)/3) << 6) | (((b0+2*b1)/3) << 1) | 1;
+            } else {
+                pal[2] = (((r0+r1)/2) << 11) | (((g0+g1)/2) << 6) | (((b0+b1)/2) << 1) | 1;
+            }
+
+            int cols = MIN(4, width - bx);
+            for (int y = 0; y < rows; y++) {
+                uint16_t *d = dst + (by - t0 + y) * width + bx;
+                uint32_t row = idx << (y * 8);
+                for (int x = 0; x < cols; x++, row <<= 2)
+                    d[x] = pal[row >> 30];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Load a rect of a block-compressed texture via the texloader
+ * 
+ * TMEM can only be filled by the RDP reading from RDRAM, so the lines covering
+ * the rect are decoded by the CPU into a transient RGBA16 buffer, which is then
+ * loaded as usual and freed once the RDP is done with it (or together with the
+ * block being recorded).
+ */
+static int texload_blockcomp(tex_loader_t *tload, int s0, int t0, int s1, int t1)
+{
+    const surface_t *tex = tload->tex;
+    int bt0 = t0 & ~3;
+    int bt1 = MIN(ROUND_UP(t1, 4), tex->height);
+    int size = ROUND_UP(tex->width * 2 * (bt1 - bt0), 16);
+    uint16_t *buf = memalign(16, size);
+    assertf(buf, "out of memory decoding a block-compressed texture (%d bytes)", size);
+    blockcomp_decode(tex, buf, bt0, bt1);
+    data_cache_hit_writeback(buf, size);
+
+    surface_t decoded = blockcomp_decoded_surface(tex, buf, bt0);
+    tload->tex = &decoded;
+    tload->load_mode = TEX_LOAD_UNKNOWN;
+    int mem = tex_loader_load(tload, s0, t0, s1, t1);
+    tload->tex = tex;
+    tload->load_mode = TEX_LOAD_UNKNOWN;
+
+    // A block can be run any number of times, so it keeps the decoded lines
+    // until it is freed. Otherwise, they are released once the RDP is done.
+    if (rspq_in_block())
+        __rspq_block_own(buf);
+    else
+        rdpq_call_deferred(free, buf);
+    return mem;
+}
+
 ///@cond
 // Tex loader API, not yet documented
 int tex_loader_load(tex_loader_t *tload, int s0, int t0, int s1, int t1)
 {
     assertf(s0 <= s1, "Invalid texture load: s0:%d s1:%d", s0, s1);
     assertf(t0 <= t1, "Invalid texture load: t0:%d t1:%d", t0, t1);
+    if (__builtin_expect(tload->tex->flags & SURFACE_FLAGS_BLOCKCOMP, 0))
+        return texload_blockcomp(tload, s0, t0, s1, t1);
     int mem = texload_set_rect(tload, s0, t0, s1, t1);
     if (tload->rect.can_load_block && (t0 & 1) == 0)
         tload->load_block(tload, s0, t0, s1, t1);
@@ -353,6 +454,16 @@ void tex_loader_set_tmem_addr(tex_loader_t *tload, int tmem_addr)
 
 int tex_loader_calc_max_height(tex_loader_t *tload, int width)
 {
+    if (tload->tex->flags & SURFACE_FLAGS_BLOCKCOMP) {
+        // Compute the rect parameters on the decoded layout, as that is what will be loaded
+        const surface_t *tex = tload->tex;
+        surface_t decoded = blockcomp_decoded_surface(tex, NULL, 0);
+        tload->tex = &decoded;
+        int h = tex_loader_calc_max_height(tload, width);
+        tload->tex = tex;
+        return h;
+    }
+
     texload_set_rect(tload, 0, 0, width, 1);
 
     tex_format_t fmt = surface_get_format(tload->tex);
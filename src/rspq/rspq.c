@@ -1121,6 +1121,7 @@ void rspq_block_begin(void)
     rspq_block = malloc_uncached(sizeof(rspq_block_t) + rspq_block_size*sizeof(uint32_t));
     rspq_block->nesting_level = 0;
     rspq_block->rdp_block = NULL;
+    rspq_block->buffers = NULL;
 
     // Switch to the block buffer. From now on, all rspq_writes will
     // go into the block.
@@ -1150,11 +1151,43 @@ rspq_block_t* rspq_block_end(void)
     return b;
 }
 
+/** @brief A heap buffer owned by a block (see #__rspq_block_own) */
+typedef struct rspq_block_buffer_s {
+    void *buf;                              ///< Buffer (allocated with malloc or memalign)
+    struct rspq_block_buffer_s *next;       ///< Next buffer owned by the same block
+} rspq_block_buffer_t;
+
+/**
+ * @brief Make the block being recorded the owner of a heap buffer
+ * 
+ * This is used for data that is referenced by the commands of the block
+ * (eg: a staging buffer read by the RDP), which must then live as long as the
+ * block itself, as the block can be run any number of times. The buffer
+ * is released by #rspq_block_free.
+ */
+void __rspq_block_own(void *buf)
+{
+    assertf(rspq_block, "a block is not being created");
+    rspq_block_buffer_t *node = malloc(sizeof(rspq_block_buffer_t));
+    assertf(node, "out of memory");
+    node->buf = buf;
+    node->next = rspq_block->buffers;
+    rspq_block->buffers = node;
+}
+
 void rspq_block_free(rspq_block_t *block)
 {
     // Free RDP blocks first
     __rdpq_block_free(block->rdp_block);
 
+    // Free the buffers referenced by the block
+    while (block->buffers) {
+        rspq_block_buffer_t *node = block->buffers;
+        block->buffers = node->next;
+        free(node->buf);
+        free(node);
+    }
+
     // Start from the commands in the first chunk of the block
     int size = RSPQ_BLOCK_MIN_SIZE;
     void *start = block;
@@ -167,7 +167,8 @@ typedef struct rdpq_block_s rdpq_block_t;
 typedef struct rspq_block_s {
     uint32_t nesting_level;     ///< Nesting level of the block
     rdpq_block_t *rdp_block;    ///< Option RDP static buffer (with RDP commands)
-    uint32_t cmds[];            ///< Block contents (commands)
+    struct rspq_block_buffer_s *buffers;    ///< Heap buffers referenced by the block (see #__rspq_block_own)
+    uint32_t cmds[] __attribute__((aligned(8)));    ///< Block contents (commands)
 } rspq_block_t;
 
 /** @brief RDP render mode definition 
@@ -303,5 +304,6 @@ rsp_queue_t *__rspq_get_state(void);
  * @brief Notify that a RSP command is going to run a block
  */
 void rspq_block_run_rsp(int nesting_level);
+void __rspq_block_own(void *buf);
 
 #endif
@@ -4,6 +4,7 @@
 #include "surface.h"
 #include "sprite_internal.h"
 #include "asset.h"
+#include "arena.h"
 #include "utils.h"
 #include "rdpq_tex.h"
 #include <stdio.h>
@@ -13,6 +14,25 @@
 
 static sprite_t *last_spritemap = NULL;
 
+/** @brief Size in bytes of an image of the sprite, taking block compression into account */
+static int __sprite_image_size(sprite_t *sprite, tex_format_t format, int width, int height)
+{
+    if ((sprite->flags & SPRITE_FLAGS_BLOCKCOMP) && format == FMT_RGBA16)
+        return ((width + 3) / 4) * ((height + 3) / 4) * 8;
+    return TEX_FORMAT_PIX2BYTES(format, width) * height;
+}
+
+/** @brief Create a surface for an image of the sprite, taking block compression into account */
+static surface_t __sprite_surface(sprite_t *sprite, void *pixels, tex_format_t format, int width, int height)
+{
+    if ((sprite->flags & SPRITE_FLAGS_BLOCKCOMP) && format == FMT_RGBA16) {
+        surface_t surf = surface_make(pixels, format, width, height, ((width + 3) / 4) * 8);
+        surf.flags |= SURFACE_FLAGS_BLOCKCOMP;
+        return surf;
+    }
+    return surface_make_linear(pixels, format, width, height);
+}
+
 /** @brief Access the sprite extended structure, or NULL if the structure does not exist */
 __attribute__((noinline))
 sprite_ext_t *__sprite_ext(sprite_t *sprite)
@@ -22,7 +42,7 @@ sprite_ext_t *__sprite_ext(sprite_t *sprite)
 
     uint8_t *data = (uint8_t*)sprite->data;
     tex_format_t format = sprite_get_format(sprite);
-    data += ROUND_UP(TEX_FORMAT_PIX2BYTES(format, sprite->width) * sprite->height, 8);
+    data += ROUND_UP(__sprite_image_size(sprite, format, sprite->width, sprite->height), 8);
 
     // Access extended header
     sprite_ext_t *sx = (sprite_ext_t*)data;
@@ -64,7 +84,9 @@ sprite_t *sprite_load(const char *fn)
     int sz;
     void *buf = asset_load(fn, &sz);
     sprite_t *s = sprite_load_buf(buf, sz);
-    s->flags |= SPRITE_FLAGS_OWNEDBUFFER;
+    // Sprites allocated from an arena are released together with it
+    if (!arena_get_current())
+        s->flags |= SPRITE_FLAGS_OWNEDBUFFER;
     return s;
 }
 
@@ -83,7 +105,7 @@ void sprite_free(sprite_t *s)
 }
 
 surface_t sprite_get_pixels(sprite_t *sprite) {
-    return surface_make_linear(sprite->data, sprite_get_format(sprite),
+    return __sprite_surface(sprite, sprite->data, sprite_get_format(sprite),
         sprite->width, sprite->height);
 }
 
@@ -107,7 +129,7 @@ surface_t sprite_get_lod_pixels(sprite_t *sprite, int num_level) {
     // Return the surface that refers to this LOD
     tex_format_t fmt = lod->fmt_file_pos >> 24;
     void *pixels = (void*)sprite + (lod->fmt_file_pos & 0x00FFFFFF);
-    return surface_make_linear(pixels, fmt, lod->width, lod->height);
+    return __sprite_surface(sprite, pixels, fmt, lod->width, lod->height);
 }
 
 void sprite_get_detail_texparms(sprite_t *sprite, rdpq_texparms_t *parms) {
@@ -175,6 +197,52 @@ surface_t sprite_get_tile(sprite_t *sprite, int h, int v) {
         tile_width, tile_height);
 }
 
+/** @brief Access the atlas table of the sprite, or NULL if the sprite is not an atlas sheet */
+static sprite_atlas_t *__sprite_atlas(sprite_t *sprite)
+{
+    sprite_ext_t *sx = __sprite_ext(sprite);
+    if (!sx || sx->size < 128 || !sx->atlas_file_pos)
+        return NULL;
+    return (void*)sprite + sx->atlas_file_pos;
+}
+
+int sprite_get_atlas_count(sprite_t *sprite) {
+    sprite_atlas_t *atlas = __sprite_atlas(sprite);
+    return atlas ? atlas->count : 0;
+}
+
+int sprite_get_atlas_index(sprite_t *sprite, const char *name) {
+    sprite_atlas_t *atlas = __sprite_atlas(sprite);
+    if (!atlas)
+        return -1;
+    for (int i=0; i<atlas->count; i++) {
+        const char *rname = (void*)sprite + atlas->rects[i].name_file_pos;
+        if (!strcmp(rname, name))
+            return i;
+    }
+    return -1;
+}
+
+bool sprite_get_atlas_rect(sprite_t *sprite, int idx, int *x, int *y, int *width, int *height) {
+    sprite_atlas_t *atlas = __sprite_atlas(sprite);
+    if (!atlas || idx < 0 || idx >= atlas->count)
+        return false;
+    struct sprite_atlas_rect_s *r = &atlas->rects[idx];
+    if (x) *x = r->x;
+    if (y) *y = r->y;
+    if (width) *width = r->width;
+    if (height) *height = r->height;
+    return true;
+}
+
+surface_t sprite_get_atlas_tile(sprite_t *sprite, int idx) {
+    int x, y, w, h;
+    if (!sprite_get_atlas_rect(sprite, idx, &x, &y, &w, &h))
+        return (surface_t){0};
+    surface_t surf = sprite_get_pixels(sprite);
+    return surface_make_sub(&surf, x, y, w, h);
+}
+
 bool sprite_get_texparms(sprite_t *sprite, rdpq_texparms_t *parms) {
     sprite_ext_t *sx = __sprite_ext(sprite);
     if (!sx)
@@ -49,9 +49,25 @@ typedef struct sprite_ext_s {
         bool              use_main_texture; ///< True if the detail texture is the same as the LOD0 of the main texture
         uint8_t           padding[3];    ///< Padding
     } detail;                    ///< Detail texture parameters
+    uint32_t atlas_file_pos;     ///< Position of the atlas table in the file (0 if not an atlas). Only valid if size >= 128.
 } sprite_ext_t;
 
-_Static_assert(sizeof(sprite_ext_t) == 124, "invalid sizeof(sprite_ext_t)");
+_Static_assert(sizeof(sprite_ext_t) == 128, "invalid sizeof(sprite_ext_t)");
+
+/**
+ * @brief Table of sub-images of a sprite generated as atlas sheet (mksprite --atlas)
+ */
+typedef struct sprite_atlas_s {
+    uint16_t count;             ///< Number of sub-images
+    uint16_t padding;           ///< Padding
+    struct sprite_atlas_rect_s {
+        uint16_t x;                ///< X coordinate of the sub-image in the sheet
+        uint16_t y;                ///< Y coordinate of the sub-image in the sheet
+        uint16_t width;            ///< Width of the sub-image
+        uint16_t height;           ///< Height of the sub-image
+        uint32_t name_file_pos;    ///< Absolute offset in the file of the name (NULL terminated)
+    } rects[];                  ///< Sub-images
+} sprite_atlas_t;
 
 /** @brief Convert a sprite from the old format with implicit texture format */ 
 bool __sprite_upgrade(sprite_t *sprite);
@@ -58,6 +58,9 @@ surface_t surface_make_sub(surface_t *parent, uint32_t x0, uint32_t y0, uint32_t
     assert(x0 + width <= parent->width);
     assert(y0 + height <= parent->height);
 
+    assertf(!(parent->flags & SURFACE_FLAGS_BLOCKCOMP),
+        "cannot create a subsurface of a block-compressed surface");
+
     tex_format_t fmt = surface_get_format(parent);
     assertf(TEX_FORMAT_BITDEPTH(fmt) != 4 || (x0 & 1) == 0,
         "cannot create a subsurface with an odd X offset (%ld) in a 4bpp surface", x0);
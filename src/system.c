@@ -1003,6 +1003,11 @@ int readlink( const char *path, char *buf, size_t bufsize )
     return -1;
 }
 
+/** @brief Current end of the memory handed to the allocator by #sbrk */
+static char * heap_end = 0;
+/** @brief Upper limit of the heap (start of the stack area) */
+static char * heap_top = 0;
+
 /**
  * @brief Return a new chunk of memory to be used as heap
  *
@@ -1013,8 +1018,6 @@ int readlink( const char *path, char *buf, size_t bufsize )
  */
 void *sbrk( int incr )
 {
-    static char * heap_end = 0;
-    static char * heap_top = 0;
     char *        prev_heap_end;
 
     disable_interrupts();
@@ -1041,6 +1044,53 @@ void *sbrk( int incr )
     return (void *)prev_heap_end;
 }
 
+/**
+ * @brief Collect statistics about the heap
+ *
+ * Besides the amount of used and free memory, this function measures the
+ * largest block that can be allocated, which is what ultimately matters
+ * when a long session has fragmented the heap: a load can fail even with
+ * plenty of free memory, if no free block is big enough.
+ *
+ * The largest block is found by probing the allocator (via a binary search
+ * of malloc calls), so this function is meant for diagnostics, not to be
+ * called every frame.
+ *
+ * @param[out] stats
+ *             Structure to fill with the statistics
+ */
+void sys_get_heap_stats( heap_stats_t *stats )
+{
+    // Make sure the heap bounds are initialized
+    sbrk(0);
+
+    struct mallinfo info = mallinfo();
+    int unreserved = heap_top - heap_end;
+
+    stats->total = heap_top - (char*)HEAP_START_ADDR;
+    stats->used = info.uordblks;
+    stats->free = info.fordblks + unreserved;
+
+    // Binary search the largest allocation that succeeds. Preserve errno,
+    // as failed allocations set it.
+    int saved_errno = errno;
+    int lo = 0, hi = stats->free;
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        void *ptr = malloc(mid);
+        if (ptr) {
+            free(ptr);
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    errno = saved_errno;
+
+    stats->largest_free = lo;
+    stats->fragmentation = stats->free ? 100 - (int)((int64_t)lo * 100 / stats->free) : 0;
+}
+
 /**
  * @brief Return file stats based on a file name
  *
@@ -0,0 +1,389 @@
+/**
+ * @file uncached_pool.c
+ * @brief Pooled uncached memory allocator
+ * @ingroup uncached_pool
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <malloc.h>
+#include "n64sys.h"
+#include "debug.h"
+#include "utils.h"
+#include "uncached_pool_internal.h"
+
+/**
+ * @defgroup uncached_pool Uncached memory pool
+ * @ingroup lowlevel
+ * @brief Size-class allocator for buffers accessed via uncached memory.
+ *
+ * Buffers shared with the RCP (rspq blocks, rdpq buffers, samplebuffers,
+ * framebuffers...) are normally allocated with #malloc_uncached, which goes
+ * through memalign and must then invalidate the whole buffer from the data
+ * cache. Each allocation also pays the heap fragmentation caused by the
+ * 16-byte rounding and alignment padding.
+ *
+ * An uncached pool carves small buffers out of 16 KiB slabs, one size class
+ * per slab, so that allocation and release are O(1) pointer operations and
+ * cache invalidation is done only once per slab. A pool can be reset in bulk
+ * (eg: when a level is unloaded) keeping its slabs for later reuse, and can
+ * be installed as the backend of #malloc_uncached via #uncached_pool_set_default.
+ * @{
+ */
+
+/** @brief Size of the header at the beginning of each slab */
+#define SLAB_HEADER_SIZE    64
+/** @brief Smallest size class */
+#define MIN_CLASS_SIZE      16
+/** @brief Number of size classes (16, 32, ..., 2048) */
+#define NUM_CLASSES         8
+/** @brief Maximum amount of RDRAM that can contain slabs (iQue Player) */
+#define MAX_RDRAM_SIZE      (16*1024*1024)
+/** @brief Number of slab-sized pages in RDRAM */
+#define NUM_PAGES           (MAX_RDRAM_SIZE / UNCACHED_POOL_SLAB_SIZE)
+
+_Static_assert((MIN_CLASS_SIZE << (NUM_CLASSES-1)) == UNCACHED_POOL_MAX_CLASS_SIZE, "invalid number of classes");
+
+/** @brief Header of a slab (stored at its beginning, accessed uncached) */
+typedef struct slab_s {
+    uncached_pool_t *pool;      ///< Owner pool
+    struct slab_s *next;        ///< Next slab of the same class
+    uint16_t cls;               ///< Size class index
+    uint16_t bump;              ///< Offset of the first never-allocated object
+} slab_t;
+
+_Static_assert(sizeof(slab_t) <= SLAB_HEADER_SIZE, "slab header too big");
+
+/** @brief Header of a large allocation (stored just before the buffer, accessed uncached) */
+typedef struct large_s {
+    uncached_pool_t *pool;      ///< Owner pool
+    void *base;                 ///< Pointer returned by memalign (cached segment)
+    size_t size;                ///< Size of the buffer as reserved from the heap
+    struct large_s *prev;       ///< Previous large allocation of the pool
+    struct large_s *next;       ///< Next large allocation of the pool
+    uint32_t index;             ///< Index of this header in #large_table
+    uint32_t padding[2];        ///< Pad to 32 bytes
+} large_t;
+
+_Static_assert(sizeof(large_t) == 32, "invalid large header size");
+
+/** @brief Freelist node, stored in the released buffer itself */
+typedef struct free_node_s {
+    struct free_node_s *next;   ///< Next free buffer of the same class
+} free_node_t;
+
+/** @brief Uncached pool */
+struct uncached_pool_s {
+    free_node_t *freelist[NUM_CLASSES];     ///< Released buffers per class
+    slab_t *slabs[NUM_CLASSES];             ///< All slabs per class
+    slab_t *cur[NUM_CLASSES];               ///< Slab being carved per class
+    large_t *large;                         ///< Large allocations
+    uncached_pool_stats_t stats;            ///< Statistics
+    struct uncached_pool_s *next;           ///< Next live pool
+};
+
+/** @brief Pool serving #malloc_uncached, if any */
+uncached_pool_t *__uncached_pool_default = NULL;
+/** @brief List of live pools */
+static uncached_pool_t *pools = NULL;
+/** @brief Bitmap of the RDRAM pages that are currently slabs of a pool */
+static uint32_t slab_pages[NUM_PAGES / 32];
+/** @brief Headers of the large allocations of all pools (unordered) */
+static large_t **large_table = NULL;
+/** @brief Number of headers in #large_table */
+static uint32_t large_count = 0;
+/** @brief Capacity of #large_table */
+static uint32_t large_capacity = 0;
+
+/** @brief Find the size class index for a given size */
+static int size_class(size_t size)
+{
+    int cls = 0;
+    while ((MIN_CLASS_SIZE << cls) < size)
+        cls++;
+    return cls;
+}
+
+/** @brief Mark or unmark the RDRAM page of a slab in #slab_pages */
+static void slab_page_set(slab_t *slab, bool used)
+{
+    uint32_t page = PhysicalAddr(slab) / UNCACHED_POOL_SLAB_SIZE;
+    assertf(page < NUM_PAGES, "slab %p out of RDRAM", slab);
+    if (used) slab_pages[page / 32] |= 1u << (page % 32);
+    else      slab_pages[page / 32] &= ~(1u << (page % 32));
+}
+
+/**
+ * @brief Return the slab owning a pointer, or NULL if it's not in a slab
+ *
+ * Slabs are aligned to their size, so the pointer belongs to a slab only
+ * if its page is marked in #slab_pages.
+ */
+static slab_t *slab_of(void *ptr)
+{
+    uint32_t page = PhysicalAddr(ptr) / UNCACHED_POOL_SLAB_SIZE;
+    if (page >= NUM_PAGES || !(slab_pages[page / 32] & (1u << (page % 32))))
+        return NULL;
+    slab_t *slab = (slab_t*)((uint32_t)UncachedAddr(ptr) & ~(UNCACHED_POOL_SLAB_SIZE-1));
+    if ((void*)slab == UncachedAddr(ptr)) return NULL;
+    return slab;
+}
+
+/**
+ * @brief Return the large header of a pointer, or NULL if it's not a large allocation
+ *
+ * Each header stores its own index in #large_table, so the header candidate
+ * just before the pointer is a real one only if the table entry at that index
+ * points back to it. Random heap contents can never pass this check.
+ */
+static large_t *large_of(void *ptr)
+{
+    if ((uint32_t)ptr & 15)
+        return NULL;
+    large_t *large = (large_t*)UncachedAddr(ptr) - 1;
+    uint32_t index = large->index;
+    if (index >= large_count || large_table[index] != large)
+        return NULL;
+    return large;
+}
+
+/** @brief Allocate a new slab for the specified class and make it current */
+static slab_t *slab_new(uncached_pool_t *pool, int cls)
+{
+    void *mem = memalign(UNCACHED_POOL_SLAB_SIZE, UNCACHED_POOL_SLAB_SIZE);
+    if (!mem) return NULL;
+    data_cache_hit_invalidate(mem, UNCACHED_POOL_SLAB_SIZE);
+
+    slab_t *slab = UncachedAddr(mem);
+    slab_page_set(slab, true);
+    slab->pool = pool;
+    slab->next = NULL;
+    slab->cls = cls;
+    slab->bump = SLAB_HEADER_SIZE;
+
+    // Append to the class list, so that after a reset the slabs are
+    // carved again in the same order.
+    if (pool->cur[cls]) {
+        assertf(pool->cur[cls]->next == NULL, "slab list corrupted");
+        pool->cur[cls]->next = slab;
+    } else {
+        pool->slabs[cls] = slab;
+    }
+    pool->cur[cls] = slab;
+    pool->stats.num_slabs++;
+    pool->stats.slab_bytes += UNCACHED_POOL_SLAB_SIZE;
+    return slab;
+}
+
+/** @brief Release a slab to the heap */
+static void slab_free(slab_t *slab)
+{
+    slab_page_set(slab, false);
+    free(CachedAddr(slab));
+}
+
+/** @brief Account for a new allocation in the statistics */
+static void stats_add(uncached_pool_t *pool, size_t size)
+{
+    pool->stats.num_allocs++;
+    pool->stats.used_bytes += size;
+    if (pool->stats.used_bytes > pool->stats.peak_bytes)
+        pool->stats.peak_bytes = pool->stats.used_bytes;
+}
+
+/** @brief Allocate a buffer bigger than the biggest size class */
+static void *large_alloc(uncached_pool_t *pool, int align, size_t size)
+{
+    // The header is placed just before the buffer, so pad the allocation
+    // with the alignment (at least 32 bytes to fit it).
+    int pad = align < sizeof(large_t) ? sizeof(large_t) : align;
+    size = ROUND_UP(size, 16) + pad;
+    if (large_count == large_capacity) {
+        uint32_t capacity = large_capacity ? large_capacity * 2 : 16;
+        large_t **table = realloc(large_table, capacity * sizeof(large_t*));
+        if (!table) return NULL;
+        large_table = table;
+        large_capacity = capacity;
+    }
+
+    void *mem = memalign(align, size);
+    if (!mem) return NULL;
+    data_cache_hit_invalidate(mem, size);
+
+    void *ptr = UncachedAddr(mem + pad);
+    large_t *large = (large_t*)ptr - 1;
+    large->pool = pool;
+    large->base = mem;
+    large->size = size;
+    large->index = large_count;
+    large_table[large_count++] = large;
+    large->prev = NULL;
+    large->next = pool->large;
+    if (pool->large) pool->large->prev = large;
+    pool->large = large;
+
+    pool->stats.large_bytes += size;
+    stats_add(pool, size);
+    return ptr;
+}
+
+/** @brief Release a large allocation to the heap */
+static void large_free(uncached_pool_t *pool, large_t *large)
+{
+    if (large->prev) large->prev->next = large->next;
+    else pool->large = large->next;
+    if (large->next) large->next->prev = large->prev;
+
+    // Move the last header of the table into the hole
+    large_t *last = large_table[--large_count];
+    large_table[large->index] = last;
+    last->index = large->index;
+    large->index = ~0u;
+
+    pool->stats.large_bytes -= large->size;
+    pool->stats.used_bytes -= large->size;
+    pool->stats.num_allocs--;
+
+    free(large->base);
+}
+
+uncached_pool_t *uncached_pool_new(void)
+{
+    uncached_pool_t *pool = calloc(1, sizeof(uncached_pool_t));
+    pool->next = pools;
+    pools = pool;
+    return pool;
+}
+
+void uncached_pool_free(uncached_pool_t *pool)
+{
+    uncached_pool_reset(pool);
+    for (int cls=0; cls<NUM_CLASSES; cls++) {
+        slab_t *slab = pool->slabs[cls];
+        while (slab) {
+            slab_t *next = slab->next;
+            slab_free(slab);
+            slab = next;
+        }
+    }
+    if (__uncached_pool_default == pool)
+        __uncached_pool_default = NULL;
+    uncached_pool_t **prev = &pools;
+    while (*prev != pool) prev = &(*prev)->next;
+    *prev = pool->next;
+    free(pool);
+}
+
+void *uncached_pool_alloc_aligned(uncached_pool_t *pool, int align, size_t size)
+{
+    assertf((align & (align-1)) == 0, "alignment must be a power of two: %d", align);
+
+    // Objects within a slab start at offset 64 and are laid out at multiples
+    // of the class size, so classes of 64 bytes and up are 64-byte aligned.
+    if (align > 16) size = MAX(size, align);
+    if (align > SLAB_HEADER_SIZE || size > UNCACHED_POOL_MAX_CLASS_SIZE)
+        return large_alloc(pool, MAX(align, 16), size);
+
+    int cls = size_class(size);
+    size_t cls_size = MIN_CLASS_SIZE << cls;
+
+    // Fast path: reuse a released buffer
+    free_node_t *node = pool->freelist[cls];
+    if (node) {
+        pool->freelist[cls] = node->next;
+        stats_add(pool, cls_size);
+        return node;
+    }
+
+    // Carve from the current slab, moving to the next one when exhausted
+    slab_t *slab = pool->cur[cls];
+    while (!slab || slab->bump + cls_size > UNCACHED_POOL_SLAB_SIZE) {
+        if (slab && slab->next) {
+            slab = pool->cur[cls] = slab->next;
+            continue;
+        }
+        slab = slab_new(pool, cls);
+        if (!slab) return NULL;
+    }
+
+    void *ptr = (void*)slab + slab->bump;
+    slab->bump += cls_size;
+    stats_add(pool, cls_size);
+    return ptr;
+}
+
+void *uncached_pool_alloc(uncached_pool_t *pool, size_t size)
+{
+    return uncached_pool_alloc_aligned(pool, 16, size);
+}
+
+void uncached_pool_release(uncached_pool_t *pool, void *ptr)
+{
+    if (!ptr) return;
+
+    slab_t *slab = slab_of(ptr);
+    if (slab) {
+        assertf(slab->pool == pool, "buffer %p does not belong to pool %p", ptr, pool);
+        free_node_t *node = UncachedAddr(ptr);
+        node->next = pool->freelist[slab->cls];
+        pool->freelist[slab->cls] = node;
+        pool->stats.num_allocs--;
+        pool->stats.used_bytes -= MIN_CLASS_SIZE << slab->cls;
+        return;
+    }
+
+    large_t *large = large_of(ptr);
+    assertf(large && large->pool == pool, "buffer %p was not allocated by pool %p", ptr, pool);
+    large_free(pool, large);
+}
+
+void uncached_pool_reset(uncached_pool_t *pool)
+{
+    while (pool->large)
+        large_free(pool, pool->large);
+
+    for (int cls=0; cls<NUM_CLASSES; cls++) {
+        pool->freelist[cls] = NULL;
+        for (slab_t *slab = pool->slabs[cls]; slab; slab = slab->next)
+            slab->bump = SLAB_HEADER_SIZE;
+        pool->cur[cls] = pool->slabs[cls];
+    }
+
+    pool->stats.num_allocs = 0;
+    pool->stats.used_bytes = 0;
+}
+
+void uncached_pool_get_stats(uncached_pool_t *pool, uncached_pool_stats_t *stats)
+{
+    *stats = pool->stats;
+}
+
+void uncached_pool_set_default(uncached_pool_t *pool)
+{
+    __uncached_pool_default = pool;
+}
+
+uncached_pool_t *uncached_pool_get_default(void)
+{
+    return __uncached_pool_default;
+}
+
+bool __uncached_pool_release_any(void *ptr)
+{
+    if (!pools)
+        return false;
+
+    slab_t *slab = slab_of(ptr);
+    if (slab) {
+        uncached_pool_release(slab->pool, ptr);
+        return true;
+    }
+    large_t *large = large_of(ptr);
+    if (large) {
+        large_free(large->pool, large);
+        return true;
+    }
+    return false;
+}
+
+/** @} */
@@ -0,0 +1,26 @@
+/**
+ * @file uncached_pool_internal.h
+ * @brief Pooled uncached memory allocator (internal API)
+ * @ingroup uncached_pool
+ */
+
+#ifndef __LIBDRAGON_UNCACHED_POOL_INTERNAL_H
+#define __LIBDRAGON_UNCACHED_POOL_INTERNAL_H
+
+#include <stdbool.h>
+#include "uncached_pool.h"
+
+/** @brief Pool serving #malloc_uncached (see #uncached_pool_set_default) */
+extern uncached_pool_t *__uncached_pool_default;
+
+/**
+ * @brief Release a buffer to its pool, if it was allocated by one.
+ *
+ * Used by #free_uncached to support buffers allocated while a default pool
+ * was installed.
+ *
+ * @return true if the buffer was released, false if it is a plain heap buffer
+ */
+bool __uncached_pool_release_any(void *ptr);
+
+#endif
@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""
+Compare two runs of the benchmark testrom (testrom_bench.z64).
+
+Each input can be either the raw debug log of a run (as captured from the
+emulator or the flashcart), from which the JSON blocks between the
+"@@@ BENCHMARK BEGIN" and "@@@ BENCHMARK END" markers are extracted, or a
+JSON file previously saved with --extract. The output of the host
+benchmarks (make -C tests/host bench) uses the same format.
+
+All metrics are throughputs, so higher is better. The script exits with
+status 1 if any metric regressed by more than the threshold.
+
+Usage:
+    benchcompare.py [--threshold PCT] baseline.log new.log
+    benchcompare.py --extract run.log > run.json
+"""
+
+import argparse
+import json
+import sys
+
+BEGIN_MARKER = "@@@ BENCHMARK BEGIN"
+END_MARKER = "@@@ BENCHMARK END"
+
+def parse(fn, text):
+    try:
+        return json.loads(text)
+    except json.JSONDecodeError as e:
+        sys.exit(f"{fn}: invalid benchmark output: {e}")
+
+def load(fn):
+    with open(fn, "r", errors="replace") as f:
+        text = f.read()
+    if BEGIN_MARKER not in text:
+        return parse(fn, text)
+
+    # A log can contain multiple blocks (eg: the host benchmarks, that are
+    # separate executables): merge all of them.
+    run = None
+    pos = 0
+    while (begin := text.find(BEGIN_MARKER, pos)) >= 0:
+        end = text.find(END_MARKER, begin)
+        if end < 0:
+            sys.exit(f"{fn}: truncated benchmark output (missing end marker)")
+        block = parse(fn, text[begin + len(BEGIN_MARKER):end])
+        if run is None:
+            run = block
+        else:
+            run["results"] += block["results"]
+            run["failures"] = run.get("failures", 0) + block.get("failures", 0)
+        pos = end
+    return run
+
+def metrics(run):
+    return {(r["test"], r["metric"]): r for r in run["results"]}
+
+def describe(fn, run):
+    where = "host" if run.get("suite") == "host" else "emulator" if run.get("emulator") else "hardware"
+    if run.get("bbplayer"):
+        where += " (iQue)"
+    return f"{fn}: {len(run['results'])} metrics on {where}, {run.get('failures', 0)} failures"
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two runs of the benchmark testrom")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="regression threshold in percent (default: 5)")
+    parser.add_argument("--extract", action="store_true",
+                        help="extract the JSON results from a single log and print them")
+    parser.add_argument("files", nargs="+")
+    args = parser.parse_args()
+
+    if args.extract:
+        if len(args.files) != 1:
+            parser.error("--extract requires exactly one file")
+        json.dump(load(args.files[0]), sys.stdout, indent=2)
+        print()
+        return 0
+
+    if len(args.files) != 2:
+        parser.error("two files are required (baseline and new run)")
+    base, new = load(args.files[0]), load(args.files[1])
+    print(describe(args.files[0], base))
+    print(describe(args.files[1], new))
+    if base.get("emulator") != new.get("emulator"):
+        print("warning: comparing an emulator run with a hardware run")
+    print()
+
+    mbase, mnew = metrics(base), metrics(new)
+    regressions = 0
+    print(f"{'test':<28} {'metric':<12} {'baseline':>12} {'new':>12} {'delta':>9}  unit")
+    for key in sorted(set(mbase) | set(mnew)):
+        test, metric = key
+        b, n = mbase.get(key), mnew.get(key)
+        if b is None or n is None:
+            r = b or n
+            side = "new" if b is None else "removed"
+            print(f"{test:<28} {metric:<12} {'-' if b is None else b['value']:>12} "
+                  f"{'-' if n is None else n['value']:>12} {side:>9}  {r['unit']}")
+            continue
+        if b["value"]:
+            delta = (n["value"] - b["value"]) * 100.0 / b["value"]
+        else:
+            delta = 0.0
+        flag = ""
+        if delta < -args.threshold:
+            flag = "  <-- REGRESSION"
+            regressions += 1
+        print(f"{test:<28} {metric:<12} {b['value']:>12.3f} {n['value']:>12.3f} "
+              f"{delta:>+8.1f}%  {n['unit']}{flag}")
+
+    if new.get("failures", 0):
+        print(f"\nerror: {new['failures']} benchmark tests failed in the new run")
+        return 1
+    if regressions:
+        print(f"\n{regressions} metrics regressed by more than {args.threshold}%")
+        return 1
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,76 @@
+// Decompression benchmark: same inputs as test_perf_decompress in the testrom.
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hostbench.h"
+#include "asset_internal.h"
+#include "compress/lz4_dec_internal.h"
+#include "compress/lzh5_internal.h"
+
+typedef struct {
+    asset_header_t header;
+    uint8_t *data;
+    uint8_t *out;
+} compressed_t;
+
+static compressed_t load_compressed(const char *fn, int algo)
+{
+    compressed_t c;
+    int size;
+    uint8_t *buf = bench_load_file(fn, &size);
+    memcpy(&c.header, buf, sizeof(asset_header_t));
+    if (memcmp(c.header.magic, ASSET_MAGIC, 3)) {
+        fprintf(stderr, "%s: not a compressed asset\n", fn);
+        exit(1);
+    }
+    // Assets are big-endian
+    c.header.algo = __builtin_bswap16(c.header.algo);
+    c.header.cmp_size = __builtin_bswap32(c.header.cmp_size);
+    c.header.orig_size = __builtin_bswap32(c.header.orig_size);
+    if (c.header.algo != algo) {
+        fprintf(stderr, "%s: wrong compression algorithm (%d, expected %d)\n", fn, c.header.algo, algo);
+        exit(1);
+    }
+    c.data = buf + sizeof(asset_header_t);
+    c.out = malloc(c.header.orig_size);
+    return c;
+}
+
+static void run_lz4(void *ctx)
+{
+    compressed_t *c = ctx;
+    int n = decompress_lz4_full_mem(c->data, c->header.cmp_size, c->out, c->header.orig_size, false);
+    if (n != c->header.orig_size) {
+        fprintf(stderr, "LZ4 decompression error\n");
+        exit(1);
+    }
+}
+
+static void run_lzh5(void *ctx)
+{
+    compressed_t *c = ctx;
+    FILE *f = fmemopen(c->data, c->header.cmp_size, "rb");
+    size_t n = decompress_lz5h_full(f, c->out, c->header.orig_size);
+    fclose(f);
+    if (n != c->header.orig_size) {
+        fprintf(stderr, "LZH5 decompression error\n");
+        exit(1);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *fn_lz4 = argc > 1 ? argv[1] : "../filesystem/perf_sprite.c1";
+    const char *fn_lzh5 = argc > 2 ? argv[2] : "../filesystem/perf_sprite.c2";
+
+    compressed_t lz4 = load_compressed(fn_lz4, 1);
+    compressed_t lzh5 = load_compressed(fn_lzh5, 2);
+
+    double t = bench_time(run_lz4, &lz4);
+    bench_report("compress", "lz4", lz4.header.orig_size / t / (1024*1024), "MiB/s");
+    t = bench_time(run_lzh5, &lzh5);
+    bench_report("compress", "lzh5", lzh5.header.orig_size / t / (1024*1024), "MiB/s");
+
+    return bench_finish();
+}
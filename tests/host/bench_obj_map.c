@@ -0,0 +1,132 @@
+// obj_map benchmark: the access patterns of the GL object tables.
+#include <stdio.h>
+#include <stdlib.h>
+#include "hostbench.h"
+#include "GL/obj_map.h"
+
+/** @brief Number of objects in the map (GL names are allocated sequentially) */
+#define NUM_OBJECTS     1000
+
+static void *value(uint32_t key)
+{
+    return (void*)(uintptr_t)(key * 16 + 16);
+}
+
+static void run_insert(void *ctx)
+{
+    obj_map_t map = { 0 };
+    obj_map_new(&map);
+    for (uint32_t i = 1; i <= NUM_OBJECTS; i++)
+        obj_map_set(&map, i, value(i));
+    obj_map_free(&map);
+}
+
+static void run_lookup(void *ctx)
+{
+    obj_map_t *map = ctx;
+    for (uint32_t i = 1; i <= NUM_OBJECTS; i++) {
+        if (obj_map_get(map, i) != value(i)) {
+            fprintf(stderr, "lookup mismatch for key %u\n", i);
+            exit(1);
+        }
+    }
+}
+
+static void run_lookup_miss(void *ctx)
+{
+    obj_map_t *map = ctx;
+    for (uint32_t i = NUM_OBJECTS + 1; i <= NUM_OBJECTS * 2; i++) {
+        if (obj_map_get(map, i)) {
+            fprintf(stderr, "unexpected hit for key %u\n", i);
+            exit(1);
+        }
+    }
+}
+
+// Keys that are not allocated sequentially: heap addresses of objects, which is
+// what glGenTextures and glGenBuffersARB return as names.
+static uint32_t sparse_key(uint32_t i)
+{
+    return 0x80100000 + i * 48;
+}
+
+static void run_lookup_sparse(void *ctx)
+{
+    obj_map_t *map = ctx;
+    for (uint32_t i = 1; i <= NUM_OBJECTS; i++) {
+        if (obj_map_get(map, sparse_key(i)) != value(i)) {
+            fprintf(stderr, "sparse lookup mismatch for key %u\n", sparse_key(i));
+            exit(1);
+        }
+    }
+}
+
+static void run_churn_sparse(void *ctx)
+{
+    obj_map_t *map = ctx;
+    for (uint32_t i = 1; i <= NUM_OBJECTS; i += 2)
+        obj_map_remove(map, sparse_key(i));
+    for (uint32_t i = 1; i <= NUM_OBJECTS; i += 2)
+        obj_map_set(map, sparse_key(i), value(i));
+}
+
+static void run_churn(void *ctx)
+{
+    // Delete and recreate every other object, as done when streaming
+    // textures or buffers in and out.
+    obj_map_t *map = ctx;
+    for (uint32_t i = 1; i <= NUM_OBJECTS; i += 2)
+        obj_map_remove(map, i);
+    for (uint32_t i = 1; i <= NUM_OBJECTS; i += 2)
+        obj_map_set(map, i, value(i));
+}
+
+static void run_iterate(void *ctx)
+{
+    obj_map_t *map = ctx;
+    uint32_t count = 0;
+    obj_map_iter_t it = obj_map_iterator(map);
+    while (obj_map_iterator_next(&it))
+        count++;
+    if (count != NUM_OBJECTS) {
+        fprintf(stderr, "iteration returned %u objects\n", count);
+        exit(1);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    obj_map_t map = { 0 };
+    obj_map_new(&map);
+    for (uint32_t i = 1; i <= NUM_OBJECTS; i++)
+        obj_map_set(&map, i, value(i));
+
+    double t = bench_time(run_insert, NULL);
+    bench_report("obj_map", "insert", NUM_OBJECTS / t / 1e6, "Mop/s");
+    t = bench_time(run_lookup, &map);
+    bench_report("obj_map", "lookup", NUM_OBJECTS / t / 1e6, "Mop/s");
+    t = bench_time(run_lookup_miss, &map);
+    bench_report("obj_map", "lookup_miss", NUM_OBJECTS / t / 1e6, "Mop/s");
+    t = bench_time(run_churn, &map);
+    bench_report("obj_map", "churn", NUM_OBJECTS / t / 1e6, "Mop/s");
+    t = bench_time(run_iterate, &map);
+    bench_report("obj_map", "iterate", NUM_OBJECTS / t / 1e6, "Mobj/s");
+
+    obj_map_free(&map);
+
+    obj_map_t sparse = { 0 };
+    obj_map_new(&sparse);
+    for (uint32_t i = 1; i <= NUM_OBJECTS; i++)
+        obj_map_set(&sparse, sparse_key(i), value(i));
+
+    t = bench_time(run_lookup_sparse, &sparse);
+    bench_report("obj_map", "lookup_sparse", NUM_OBJECTS / t / 1e6, "Mop/s");
+    // After many deletions, lookups must not become slower
+    t = bench_time(run_churn_sparse, &sparse);
+    bench_report("obj_map", "churn_sparse", NUM_OBJECTS / t / 1e6, "Mop/s");
+    t = bench_time(run_lookup_sparse, &sparse);
+    bench_report("obj_map", "lookup_sparse_churned", NUM_OBJECTS / t / 1e6, "Mop/s");
+
+    obj_map_free(&sparse);
+    return bench_finish();
+}
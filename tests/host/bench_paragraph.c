@@ -0,0 +1,147 @@
+// Paragraph layout benchmark: lay out a long text with word wrapping.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hostbench.h"
+#include "rdpq_text.h"
+#include "rdpq_paragraph.h"
+#include "rdpq/rdpq_font_internal.h"
+
+static const char *lorem =
+    "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor "
+    "incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud "
+    "exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat.\n"
+    "Duis aute irure dolor in reprehenderit in voluptate velit esse cillum dolore eu "
+    "fugiat nulla pariatur. Excepteur sint occaecat cupidatat non proident, sunt in "
+    "culpa qui officia deserunt mollit anim id est laborum. AVATAR Tomorrow Yesterday.\n";
+
+/*
+ * The font loader (rdpq_font.c) depends on the rest of libdragon, so this file
+ * provides a synthetic font and the few font functions used by the layout
+ * engine. The glyph lookup and kerning search follow the same algorithms of
+ * rdpq_font.c.
+ */
+#define FIRST_CP        32
+#define NUM_GLYPHS      (127 - FIRST_CP)
+
+static range_t font_range = { FIRST_CP, NUM_GLYPHS, 0 };
+static glyph_t font_glyphs[NUM_GLYPHS];
+static kerning_t font_kerning[1 + 26*3];
+static rdpq_font_t font = {
+    .magic = FONT_MAGIC_LOADED, .version = 1, .point_size = 12,
+    .ascent = 10, .descent = -3, .line_gap = 2, .space_width = 4,
+    .num_ranges = 1, .num_glyphs = NUM_GLYPHS,
+    .ranges = &font_range, .glyphs = font_glyphs, .kerning = font_kerning,
+};
+
+static void font_init(void)
+{
+    int nk = 1; // kerning index 0 means "no kerning"
+    for (int i = 0; i < NUM_GLYPHS; i++) {
+        int cp = FIRST_CP + i;
+        glyph_t *g = &font_glyphs[i];
+        g->xadvance = (5 + (cp % 4)) * 64;
+        g->xoff = 0; g->xoff2 = g->xadvance / 64 - 1;
+        g->yoff = -8; g->yoff2 = 0;
+        if (cp >= 'A' && cp <= 'Z') {
+            // Kern uppercase letters against a few lowercase ones (sorted by glyph)
+            g->kerning_lo = nk;
+            font_kerning[nk++] = (kerning_t){ 'a' - FIRST_CP, -10 };
+            font_kerning[nk++] = (kerning_t){ 'e' - FIRST_CP, -8 };
+            font_kerning[nk++] = (kerning_t){ 'o' - FIRST_CP, -6 };
+            g->kerning_hi = nk - 1;
+        }
+    }
+    font.num_kerning = nk;
+    font.ellipsis_glyph = '.' - FIRST_CP;
+    font.ellipsis_reps = 3;
+}
+
+int16_t __rdpq_font_glyph(const rdpq_font_t *fnt, uint32_t codepoint)
+{
+    for (int i = 0; i < fnt->num_ranges; i++) {
+        range_t *r = &fnt->ranges[i];
+        if (codepoint >= r->first_codepoint && codepoint < r->first_codepoint + r->num_codepoints)
+            return r->first_glyph + codepoint - r->first_codepoint;
+    }
+    return -1;
+}
+
+float __rdpq_font_kerning(const rdpq_font_t *fnt, int16_t glyph1, int16_t glyph2)
+{
+    glyph_t *g = &fnt->glyphs[glyph1];
+    float kerning_scale = fnt->point_size / 127.0f;
+    int l = g->kerning_lo, r = g->kerning_hi;
+    while (l <= r) {
+        int m = (l + r) / 2;
+        if (fnt->kerning[m].glyph2 == glyph2)
+            return fnt->kerning[m].kerning * kerning_scale;
+        if (fnt->kerning[m].glyph2 < glyph2)
+            l = m + 1;
+        else
+            r = m - 1;
+    }
+    return 0;
+}
+
+extern inline void __rdpq_font_glyph_metrics(const rdpq_font_t *fnt, int16_t index, float *xadvance, int8_t *xoff, int8_t *xoff2, bool *has_kerning, uint8_t *atlas_id);
+
+const rdpq_font_t *rdpq_text_get_font(uint8_t font_id)
+{
+    return font_id == 1 ? &font : NULL;
+}
+
+int rdpq_font_render_paragraph(const rdpq_font_t *fnt, const rdpq_paragraph_char_t *chars, float x0, float y0)
+{
+    fprintf(stderr, "rendering is not supported on the host\n");
+    abort();
+}
+
+typedef struct {
+    const char *text;
+    int len;
+    rdpq_textparms_t parms;
+} layout_t;
+
+static void run_layout(void *ctx)
+{
+    // Paragraphs are limited to 256 chars, so lay out the text in chunks,
+    // like the pages of a dialog.
+    enum { CHUNK = 200 };
+    layout_t *l = ctx;
+    for (int i = 0; i < l->len; i += CHUNK) {
+        int nbytes = l->len - i < CHUNK ? l->len - i : CHUNK;
+        rdpq_paragraph_t *p = rdpq_paragraph_build(&l->parms, 1, l->text + i, &nbytes);
+        rdpq_paragraph_free(p);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    font_init();
+
+    // Repeat the text to get a few KiB, like a dialog script
+    enum { REPEAT = 8 };
+    int len = strlen(lorem);
+    char *text = malloc(len * REPEAT + 1);
+    for (int i = 0; i < REPEAT; i++)
+        memcpy(text + i * len, lorem, len);
+    text[len * REPEAT] = 0;
+
+    layout_t l = { .text = text, .len = len * REPEAT };
+
+    l.parms = (rdpq_textparms_t){ .width = 280, .wrap = WRAP_WORD };
+    double t = bench_time(run_layout, &l);
+    bench_report("paragraph", "wrap_word", l.len / t / 1e6, "Mchar/s");
+
+    l.parms = (rdpq_textparms_t){ .width = 280, .align = ALIGN_CENTER, .wrap = WRAP_CHAR };
+    t = bench_time(run_layout, &l);
+    bench_report("paragraph", "wrap_char", l.len / t / 1e6, "Mchar/s");
+
+    l.parms = (rdpq_textparms_t){ 0 };
+    t = bench_time(run_layout, &l);
+    bench_report("paragraph", "nowrap", l.len / t / 1e6, "Mchar/s");
+
+    free(text);
+    return bench_finish();
+}
@@ -0,0 +1,74 @@
+// RDP validator benchmark: validate and disassemble a clean RDP stream.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hostbench.h"
+#include "rdpq_debug.h"
+#include "rdpq/rdpq_debug_internal.h"
+
+/** @brief Number of times the input stream is repeated */
+#define REPEAT      256
+
+typedef struct {
+    uint64_t *cmds;
+    int num_cmds;
+    FILE *null;
+} stream_t;
+
+static void run_validate(void *ctx)
+{
+    stream_t *s = ctx;
+    uint64_t *cur = s->cmds, *end = s->cmds + s->num_cmds;
+    int errs = 0, warns = 0;
+    while (cur < end) {
+        rdpq_validate(cur, 0, &errs, &warns);
+        cur += rdpq_debug_disasm_size(cur);
+    }
+    if (errs || warns) {
+        fprintf(stderr, "validation failed: %d errors, %d warnings\n", errs, warns);
+        exit(1);
+    }
+}
+
+static void run_disasm(void *ctx)
+{
+    stream_t *s = ctx;
+    uint64_t *cur = s->cmds, *end = s->cmds + s->num_cmds;
+    while (cur < end) {
+        rdpq_debug_disasm(cur, s->null);
+        cur += rdpq_debug_disasm_size(cur);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *fn = argc > 1 ? argv[1] : "validate.rdp";
+
+    // Parse the stream (hex format, same as rdpvalidate)
+    int size;
+    char *text = bench_load_file(fn, &size);
+    uint64_t cmds[256]; int n = 0;
+    for (char *line = strtok(text, "\n"); line; line = strtok(NULL, "\n")) {
+        if (line[0] == '#' || line[0] == '\r') continue;
+        if (n == sizeof(cmds) / sizeof(cmds[0])) {
+            fprintf(stderr, "%s: too many commands\n", fn);
+            return 1;
+        }
+        cmds[n++] = strtoull(line, NULL, 16);
+    }
+    free(text);
+
+    stream_t s = { .num_cmds = n * REPEAT, .null = fopen("/dev/null", "w") };
+    s.cmds = malloc(s.num_cmds * sizeof(uint64_t));
+    for (int i = 0; i < REPEAT; i++)
+        memcpy(s.cmds + i * n, cmds, n * sizeof(uint64_t));
+
+    double t = bench_time(run_validate, &s);
+    bench_report("rdpq_validate", "validate", s.num_cmds / t / 1e6, "Mcmd/s");
+    t = bench_time(run_disasm, &s);
+    bench_report("rdpq_validate", "disasm", s.num_cmds / t / 1e6, "Mcmd/s");
+
+    fclose(s.null);
+    free(s.cmds);
+    return bench_finish();
+}
@@ -0,0 +1,72 @@
+// VADPCM benchmark: reference C decoder, mono and stereo.
+#include <stdio.h>
+#include <stdlib.h>
+#include "hostbench.h"
+#include "audio/vadpcm_internal.h"
+
+#define NUM_PREDICTORS  4
+#define ORDER           2
+/** @brief Number of frames (16 samples each) decoded per run: about 1s at 32 kHz */
+#define NUM_FRAMES      2048
+
+typedef struct {
+    wav64_vadpcm_vector_t codebook[2][NUM_PREDICTORS * ORDER];
+    wav64_vadpcm_vector_t state[2];
+    uint8_t *src;
+    int16_t *dst;
+    int channels;
+} vadpcm_t;
+
+static uint32_t rng = 0x12345678;
+
+static uint32_t rand32(void)
+{
+    // xorshift32: deterministic inputs across runs and platforms
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    return rng;
+}
+
+static void run_decode(void *ctx)
+{
+    vadpcm_t *v = ctx;
+    for (int ch = 0; ch < v->channels; ch++) {
+        vadpcm_error err = vadpcm_decode(NUM_PREDICTORS, ORDER, v->codebook[ch], &v->state[ch],
+            NUM_FRAMES, v->dst, v->src + ch * NUM_FRAMES * 9);
+        if (err) {
+            fprintf(stderr, "VADPCM decoding error: %d\n", err);
+            exit(1);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    static vadpcm_t v;
+
+    // Random but plausible codebooks: small predictor coefficients (in 5.11
+    // fixed point), so that the output does not saturate all the time.
+    for (int ch = 0; ch < 2; ch++)
+        for (int i = 0; i < NUM_PREDICTORS * ORDER; i++)
+            for (int j = 0; j < 8; j++)
+                v.codebook[ch][i].v[j] = (int16_t)(rand32() % 4096) - 2048;
+
+    v.src = malloc(NUM_FRAMES * 9 * 2);
+    v.dst = malloc(NUM_FRAMES * 16 * sizeof(int16_t));
+    for (int i = 0; i < NUM_FRAMES * 2; i++) {
+        uint8_t *frame = v.src + i * 9;
+        frame[0] = ((rand32() % 12) << 4) | (rand32() % NUM_PREDICTORS);
+        for (int j = 1; j < 9; j++)
+            frame[j] = rand32();
+    }
+
+    v.channels = 1;
+    double t = bench_time(run_decode, &v);
+    bench_report("vadpcm", "mono", NUM_FRAMES * 16 / t / 1e6, "Msample/s");
+    v.channels = 2;
+    t = bench_time(run_decode, &v);
+    bench_report("vadpcm", "stereo", NUM_FRAMES * 16 * 2 / t / 1e6, "Msample/s");
+
+    free(v.src);
+    free(v.dst);
+    return bench_finish();
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <time.h>
+#include "hostbench.h"
+
+/** @brief Minimum measured time for a benchmark, in seconds */
+#define BENCH_MIN_TIME      0.25
+
+static struct {
+    const char *test, *metric, *unit;
+    double value;
+} results[64];
+static int num_results;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+double bench_time(void (*fn)(void *ctx), void *ctx)
+{
+    fn(ctx);
+    for (long iters = 1;; iters *= 2) {
+        double t0 = now();
+        for (long i = 0; i < iters; i++)
+            fn(ctx);
+        double elapsed = now() - t0;
+        if (elapsed >= BENCH_MIN_TIME)
+            return elapsed / iters;
+    }
+}
+
+void bench_report(const char *test, const char *metric, double value, const char *unit)
+{
+    if (num_results == sizeof(results) / sizeof(results[0])) {
+        fprintf(stderr, "too many results\n");
+        abort();
+    }
+    results[num_results++] = (typeof(results[0])){ test, metric, unit, value };
+    fprintf(stderr, "%-24s %-12s %12.3f %s\n", test, metric, value, unit);
+}
+
+// Assertion handler used by assertf() (see debug.h)
+void debug_assert_func_f(const char *file, int line, const char *func, const char *failedexpr, const char *msg, ...)
+{
+    fprintf(stderr, "ASSERTION FAILED: %s\n%s:%d (%s)\n", failedexpr, file, line, func);
+    if (msg) {
+        va_list args;
+        va_start(args, msg);
+        vfprintf(stderr, msg, args);
+        va_end(args);
+        fprintf(stderr, "\n");
+    }
+    abort();
+}
+
+void *bench_load_file(const char *fn, int *size)
+{
+    FILE *f = fopen(fn, "rb");
+    if (!f) {
+        fprintf(stderr, "cannot open file: %s\n", fn);
+        exit(1);
+    }
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    void *buf = malloc(*size + 1);
+    fread(buf, 1, *size, f);
+    ((char*)buf)[*size] = 0;
+    fclose(f);
+    return buf;
+}
+
+int bench_finish(void)
+{
+    printf("@@@ BENCHMARK BEGIN\n");
+    printf("{\"suite\": \"host\", \"emulator\": false, \"bbplayer\": false, \"failures\": 0, \"results\": [\n");
+    for (int i = 0; i < num_results; i++) {
+        printf("  {\"test\": \"%s\", \"metric\": \"%s\", \"value\": %.3f, \"unit\": \"%s\"}%s\n",
+            results[i].test, results[i].metric, results[i].value, results[i].unit,
+            i < num_results-1 ? "," : "");
+    }
+    printf("]}\n");
+    printf("@@@ BENCHMARK END\n");
+    return 0;
+}
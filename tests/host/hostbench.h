@@ -0,0 +1,41 @@
+#ifndef HOSTBENCH_H
+#define HOSTBENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Time a benchmark function.
+ *
+ * The function is run once to warm up caches, and then repeatedly (doubling
+ * the number of iterations each time) until the total time is long enough
+ * to be measured reliably.
+ *
+ * @return Average time of a single call, in seconds
+ */
+double bench_time(void (*fn)(void *ctx), void *ctx);
+
+/**
+ * @brief Record a benchmark result.
+ *
+ * The result is printed on stderr immediately, and then dumped in JSON
+ * format by #bench_finish.
+ */
+void bench_report(const char *test, const char *metric, double value, const char *unit);
+
+/**
+ * @brief Load a whole file in memory, aborting on error.
+ */
+void *bench_load_file(const char *fn, int *size);
+
+/**
+ * @brief Dump all the results on stdout.
+ *
+ * The format is the same used by the benchmark testrom, so that
+ * tests/benchcompare.py can be used to compare two runs.
+ *
+ * @return Exit code for main()
+ */
+int bench_finish(void);
+
+#endif
@@ -0,0 +1,144 @@
+// obj_map correctness test: every operation is checked against a reference
+// table, on both the dense range (sequential GL names) and the hashed range
+// (heap addresses, as returned by glGenTextures and glGenBuffersARB).
+#include <stdio.h>
+#include <stdlib.h>
+#include "GL/obj_map.h"
+
+/** @brief Number of keys per range (enough to grow both the dense array and the hash table several times) */
+#define NUM_KEYS        3000
+
+#define CHECK(cond, msg, ...) ({ \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: " msg "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
+        exit(1); \
+    } \
+})
+
+/** @brief Key of the i-th object in the dense range */
+static uint32_t dense_key(uint32_t i)
+{
+    return i + 1;
+}
+
+/** @brief Key of the i-th object in the hashed range */
+static uint32_t sparse_key(uint32_t i)
+{
+    return 0x80100000 + i * 48;
+}
+
+static void *value(uint32_t i, uint32_t gen)
+{
+    return (void*)(uintptr_t)((i + 1) * 16 + gen);
+}
+
+/** @brief Expected contents of the map, indexed by range and object */
+static void *expected[2][NUM_KEYS];
+
+static uint32_t key_of(int range, uint32_t i)
+{
+    return range ? sparse_key(i) : dense_key(i);
+}
+
+static void check_map(obj_map_t *map, const char *phase)
+{
+    uint32_t count = 0;
+    for (int r = 0; r < 2; r++) {
+        for (uint32_t i = 0; i < NUM_KEYS; i++) {
+            void *v = obj_map_get(map, key_of(r, i));
+            CHECK(v == expected[r][i], "%s: wrong value for key 0x%x: %p (expected: %p)",
+                phase, key_of(r, i), v, expected[r][i]);
+            if (v) count++;
+        }
+    }
+    CHECK(obj_map_count(map) == count, "%s: wrong count: %u (expected: %u)",
+        phase, obj_map_count(map), count);
+
+    // Every entry must be visited exactly once by the iterator
+    uint32_t visited = 0;
+    obj_map_iter_t it = obj_map_iterator(map);
+    while (obj_map_iterator_next(&it)) {
+        CHECK(it.value == obj_map_get(map, it.key), "%s: iterator returned wrong value for key 0x%x",
+            phase, it.key);
+        visited++;
+    }
+    CHECK(visited == count, "%s: iterator visited %u entries (expected: %u)", phase, visited, count);
+}
+
+static void set(obj_map_t *map, int range, uint32_t i, void *v)
+{
+    void *old = obj_map_set(map, key_of(range, i), v);
+    CHECK(old == expected[range][i], "set: wrong old value for key 0x%x: %p (expected: %p)",
+        key_of(range, i), old, expected[range][i]);
+    expected[range][i] = v;
+}
+
+static void remove_key(obj_map_t *map, int range, uint32_t i)
+{
+    void *old = obj_map_remove(map, key_of(range, i));
+    CHECK(old == expected[range][i], "remove: wrong value for key 0x%x: %p (expected: %p)",
+        key_of(range, i), old, expected[range][i]);
+    expected[range][i] = NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    obj_map_t map = { 0 };
+    obj_map_new(&map);
+    check_map(&map, "empty");
+
+    // Insert a few keys beyond the initial dense array first: they go into
+    // the hash table and must be moved when the dense array grows past them.
+    for (uint32_t i = NUM_KEYS - 8; i < NUM_KEYS; i++)
+        set(&map, 0, i, value(i, 0));
+    check_map(&map, "insert high");
+
+    // Interleave the two ranges, checking lookups across every grow
+    for (uint32_t i = 0; i < NUM_KEYS - 8; i++) {
+        set(&map, 0, i, value(i, 0));
+        set(&map, 1, i, value(i, 0));
+        if ((i & (i - 1)) == 0)
+            check_map(&map, "insert");
+    }
+    for (uint32_t i = NUM_KEYS - 8; i < NUM_KEYS; i++)
+        set(&map, 1, i, value(i, 0));
+    check_map(&map, "insert");
+
+    // Overwrite existing keys: the old value is returned and the count doesn't change
+    for (uint32_t i = 0; i < NUM_KEYS; i += 3) {
+        set(&map, 0, i, value(i, 1));
+        set(&map, 1, i, value(i, 1));
+    }
+    check_map(&map, "overwrite");
+
+    // Remove every other key, and some keys that are not in the map
+    for (uint32_t i = 0; i < NUM_KEYS; i += 2) {
+        remove_key(&map, 0, i);
+        remove_key(&map, 1, i);
+    }
+    for (uint32_t i = 0; i < NUM_KEYS; i += 4) {
+        remove_key(&map, 0, i);
+        remove_key(&map, 1, i);
+    }
+    CHECK(obj_map_remove(&map, 0) == NULL, "remove: key 0 was never inserted");
+    CHECK(obj_map_remove(&map, 0xFFFFFFFF) == NULL, "remove: key 0xFFFFFFFF was never inserted");
+    check_map(&map, "remove");
+
+    // Reinsert the removed keys with new values
+    for (uint32_t i = 0; i < NUM_KEYS; i += 2) {
+        set(&map, 0, i, value(i, 2));
+        set(&map, 1, i, value(i, 2));
+    }
+    check_map(&map, "reinsert");
+
+    // Empty the map completely
+    for (uint32_t i = 0; i < NUM_KEYS; i++) {
+        remove_key(&map, 0, i);
+        remove_key(&map, 1, i);
+    }
+    check_map(&map, "clear");
+
+    obj_map_free(&map);
+    printf("obj_map: OK\n");
+    return 0;
+}
@@ -0,0 +1,59 @@
+void test_arena(TestContext *ctx) {
+	arena_t arena;
+	arena_init(&arena, 1024);
+	DEFER(arena_close(&arena));
+
+	uint8_t *buf1 = arena_alloc(&arena, 10, 1);
+	uint8_t *buf2 = arena_alloc(&arena, 100, 64);
+	ASSERT(buf1 && buf2, "allocation failed");
+	ASSERT(buf2 >= buf1+10, "overlapping allocations");
+	ASSERT_EQUAL_HEX((uint32_t)buf2 & 63, 0, "invalid alignment");
+	ASSERT_EQUAL_UNSIGNED(arena.used, 110, "invalid used bytes");
+
+	// Oversized allocation gets its own chunk
+	uint8_t *big = arena_alloc(&arena, 4000, 16);
+	ASSERT(big, "big allocation failed");
+	memset(big, 0xAA, 4000);
+	ASSERT(arena_contains(&arena, big+3999), "big allocation not in arena");
+	size_t reserved = arena.reserved;
+
+	// Rewinding to a mark releases only later allocations
+	arena_mark_t mark = arena_mark(&arena);
+	uint8_t *tmp = arena_alloc(&arena, 500, 16);
+	ASSERT(tmp, "allocation failed");
+	arena_rewind(&arena, mark);
+	ASSERT_EQUAL_UNSIGNED(arena.used, 4110, "invalid used bytes after rewind");
+	uint8_t *tmp2 = arena_alloc(&arena, 500, 16);
+	ASSERT(tmp2 == tmp, "rewind did not release memory (%p != %p)", tmp2, tmp);
+
+	// Reset reuses the chunks without touching the heap
+	arena_reset(&arena);
+	ASSERT_EQUAL_UNSIGNED(arena.used, 0, "invalid used bytes after reset");
+	ASSERT(arena_alloc(&arena, 10, 1) == buf1, "reset did not restart from the first chunk");
+	ASSERT_EQUAL_UNSIGNED(arena.reserved, reserved, "reset reserved new memory");
+	ASSERT_EQUAL_UNSIGNED(arena.peak, 4610, "invalid peak");
+}
+
+void test_arena_loaders(TestContext *ctx) {
+	arena_t arena;
+	arena_init(&arena, 0);
+	DEFER(arena_close(&arena));
+
+	heap_stats_t stats_before, stats_after;
+	sys_get_heap_stats(&stats_before);
+	ASSERT(stats_before.largest_free > 0 && stats_before.largest_free <= stats_before.free,
+		"invalid heap stats (%d/%d)", stats_before.largest_free, stats_before.free);
+
+	arena_t *prev = arena_set_current(&arena);
+	sprite_t *s = sprite_load("rom:/grass2.rgba32.sprite");
+	arena_set_current(prev);
+
+	ASSERT(arena_contains(&arena, s), "sprite not allocated in arena");
+	ASSERT_EQUAL_SIGNED(s->width, 24, "invalid sprite");
+	sprite_free(s); // no-op: released with the arena
+
+	// Only the arena chunk must have been taken from the heap
+	sys_get_heap_stats(&stats_after);
+	ASSERT(stats_after.used - stats_before.used < arena.reserved + 1024,
+		"unexpected heap usage (%d)", stats_after.used - stats_before.used);
+}
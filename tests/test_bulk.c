@@ -0,0 +1,120 @@
+#include <bulk.h>
+
+// Run a bulk_memcpy / bulk_memset / bulk_memset32 on a few sizes and alignments,
+// checking the result and that the bytes around the buffer are untouched.
+static void bulk_check(TestContext *ctx, const char *backend) {
+	enum { MAXSIZE = 48*1024, GUARD = 64 };
+	uint8_t *src = memalign(64, MAXSIZE + GUARD*2);
+	DEFER(free(src));
+	uint8_t *dst = memalign(64, MAXSIZE + GUARD*2);
+	DEFER(free(dst));
+	for (int i=0; i<MAXSIZE + GUARD*2; i++)
+		src[i] = i * 13 + 5;
+
+	const int sizes[] = { 100, BULK_RSP_MIN_SIZE, BULK_RSP_MIN_SIZE + 36, BULK_RDP_MIN_SIZE + 1000, MAXSIZE - 8 };
+	const int offsets[] = { 0, 4, 8, 20 };
+	for (int s=0; s<sizeof(sizes)/sizeof(sizes[0]); s++) {
+		for (int o=0; o<sizeof(offsets)/sizeof(offsets[0]); o++) {
+			int size = sizes[s], off = offsets[o];
+			uint8_t *d = dst + GUARD + off;
+
+			memset(dst, 0xAA, MAXSIZE + GUARD*2);
+			bulk_memcpy(d, src + GUARD + off, size);
+			ASSERT_EQUAL_MEM(d, src + GUARD + off, size, "%s: memcpy mismatch (size %d, offset %d)", backend, size, off);
+			ASSERT_EQUAL_HEX(d[-1], 0xAA, "%s: memcpy underflow (size %d, offset %d)", backend, size, off);
+			ASSERT_EQUAL_HEX(d[size], 0xAA, "%s: memcpy overflow (size %d, offset %d)", backend, size, off);
+
+			// Source misaligned with destination: must still be correct
+			memset(dst, 0xAA, MAXSIZE + GUARD*2);
+			bulk_memcpy(d, src + GUARD + 3, size);
+			ASSERT_EQUAL_MEM(d, src + GUARD + 3, size, "%s: unaligned memcpy mismatch (size %d, offset %d)", backend, size, off);
+
+			memset(dst, 0xAA, MAXSIZE + GUARD*2);
+			bulk_memset32(d, 0xDEADBEEF, size & ~3);
+			for (int i=0; i<(size & ~3); i+=4)
+				ASSERT_EQUAL_HEX(*(uint32_t*)(d+i), 0xDEADBEEF, "%s: memset32 mismatch at %d (size %d, offset %d)", backend, i, size, off);
+			ASSERT_EQUAL_HEX(d[-1], 0xAA, "%s: memset32 underflow (size %d, offset %d)", backend, size, off);
+			ASSERT_EQUAL_HEX(d[size & ~3], 0xAA, "%s: memset32 overflow (size %d, offset %d)", backend, size, off);
+
+			memset(dst, 0xAA, MAXSIZE + GUARD*2);
+			bulk_memset(d + 1, 0x42, size);
+			for (int i=0; i<size; i++)
+				ASSERT_EQUAL_HEX(d[1+i], 0x42, "%s: memset mismatch at %d (size %d, offset %d)", backend, i, size, off);
+			ASSERT_EQUAL_HEX(d[0], 0xAA, "%s: memset underflow (size %d, offset %d)", backend, size, off);
+			ASSERT_EQUAL_HEX(d[1+size], 0xAA, "%s: memset overflow (size %d, offset %d)", backend, size, off);
+		}
+	}
+}
+
+void test_bulk(TestContext *ctx) {
+	// CPU only
+	bulk_check(ctx, "cpu");
+	if (ctx->result == TEST_FAILED) return;
+
+	// CPU + RSP
+	rspq_init();
+	DEFER(rspq_close());
+	rsp_compute_init();
+	DEFER(rsp_compute_close());
+	bulk_check(ctx, "rsp");
+	if (ctx->result == TEST_FAILED) return;
+
+	// CPU + RSP + RDP
+	rdpq_init();
+	DEFER(rdpq_close());
+	bulk_check(ctx, "rdp");
+	if (ctx->result == TEST_FAILED) return;
+
+	// A RDP fill of more than 512 rows of 1 KiB is split into several rectangles
+	enum { BIGSIZE = 600*1024 + 40, GUARD = 64 };
+	uint8_t *big = memalign(64, BIGSIZE + GUARD*2);
+	DEFER(free(big));
+	memset(big, 0xAA, BIGSIZE + GUARD*2);
+	bulk_memset32(big + GUARD + 4, 0xCAFEF00D, BIGSIZE);
+	for (int i=0; i<BIGSIZE; i+=4)
+		ASSERT_EQUAL_HEX(*(uint32_t*)(big+GUARD+4+i), 0xCAFEF00D, "big memset32 mismatch at %d", i);
+	ASSERT_EQUAL_HEX(big[GUARD+3], 0xAA, "big memset32 underflow");
+	ASSERT_EQUAL_HEX(big[GUARD+4+BIGSIZE], 0xAA, "big memset32 overflow");
+}
+
+void test_bulk_benchmark(TestContext *ctx) {
+	rspq_init();
+	DEFER(rspq_close());
+	rsp_compute_init();
+	DEFER(rsp_compute_close());
+	rdpq_init();
+	DEFER(rdpq_close());
+
+	enum { MAXSIZE = 256*1024 };
+	uint8_t *src = memalign(64, MAXSIZE);
+	DEFER(free(src));
+	uint8_t *dst = memalign(64, MAXSIZE);
+	DEFER(free(dst));
+	memset(src, 0x5A, MAXSIZE);
+
+	// Compare the backends on increasing sizes, to find the crossover points
+	// to use for BULK_RSP_MIN_SIZE and BULK_RDP_MIN_SIZE.
+	LOG("size      memcpy cpu/rsp      memset cpu/rsp/rdp\n");
+	for (int size=1024; size<=MAXSIZE; size*=2) {
+		uint32_t t0 = TICKS_READ();
+		memcpy(dst, src, size);
+		uint32_t t1 = TICKS_READ();
+		rsp_compute_memcpy(dst, src, size);
+		rsp_compute_fence_wait(rsp_compute_fence());
+		uint32_t t2 = TICKS_READ();
+		memset(dst, 0x11, size);
+		uint32_t t3 = TICKS_READ();
+		rsp_compute_memset(dst, 0x11111111, size);
+		rsp_compute_fence_wait(rsp_compute_fence());
+		uint32_t t4 = TICKS_READ();
+		surface_t surf = surface_make_linear(dst, FMT_RGBA32, 256, size / 1024);
+		rdpq_attach(&surf, NULL);
+		rdpq_set_mode_fill(color_from_packed32(0x11111111));
+		rdpq_fill_rectangle(0, 0, 256, size / 1024);
+		rdpq_detach_wait();
+		uint32_t t5 = TICKS_READ();
+		LOG("%-8d  %7ld/%-7ld     %7ld/%-7ld/%-7ld\n", size,
+			TICKS_DISTANCE(t0, t1), TICKS_DISTANCE(t1, t2),
+			TICKS_DISTANCE(t2, t3), TICKS_DISTANCE(t3, t4), TICKS_DISTANCE(t4, t5));
+	}
+}
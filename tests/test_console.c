@@ -0,0 +1,63 @@
+// Count the lit pixels in a rectangle of a RGBA16 surface
+static int console_lit_pixels(surface_t *fb, int x0, int y0, int x1, int y1) {
+	int count = 0;
+	for (int y=y0; y<y1; y++)
+		for (int x=x0; x<x1; x++)
+			count += ((uint16_t*)fb->buffer)[y * fb->width + x] != 0;
+	return count;
+}
+
+void test_console_overlay(TestContext *ctx) {
+	RDPQ_INIT();
+
+	surface_t fb = surface_alloc(FMT_RGBA16, 320, 64);
+	DEFER(surface_free(&fb));
+
+	console_init_overlay();
+	DEFER(console_close());
+	console_set_debug(false);
+
+	color_t white = RGBA32(0xFF, 0xFF, 0xFF, 0xFF);
+	printf("A\nBC");
+
+	surface_clear(&fb, 0);
+	rdpq_attach(&fb, NULL);
+	console_render_overlay(16, 8, white);
+	rdpq_detach_wait();
+
+	ASSERT(console_lit_pixels(&fb, 16, 8, 24, 16) > 0, "glyph A not drawn");
+	ASSERT(console_lit_pixels(&fb, 16, 16, 32, 24) > 0, "glyphs BC not drawn");
+	ASSERT_EQUAL_SIGNED(console_lit_pixels(&fb, 24, 8, 320, 16), 0, "spurious pixels after A");
+	ASSERT_EQUAL_SIGNED(console_lit_pixels(&fb, 0, 24, 320, 64), 0, "spurious pixels below the text");
+	int lit_a = console_lit_pixels(&fb, 16, 8, 24, 16);
+
+	// Change only the second line: the first one must still be drawn,
+	// from its cached block.
+	printf("D");
+	surface_clear(&fb, 0);
+	rdpq_attach(&fb, NULL);
+	console_render_overlay(16, 8, white);
+	rdpq_detach_wait();
+
+	ASSERT_EQUAL_SIGNED(console_lit_pixels(&fb, 16, 8, 24, 16), lit_a, "glyph A changed");
+	ASSERT(console_lit_pixels(&fb, 32, 16, 40, 24) > 0, "glyph D not drawn");
+
+	// Move the overlay
+	surface_clear(&fb, 0);
+	rdpq_attach(&fb, NULL);
+	console_render_overlay(0, 0, white);
+	rdpq_detach_wait();
+
+	ASSERT_EQUAL_SIGNED(console_lit_pixels(&fb, 0, 0, 8, 8), lit_a, "glyph A not moved");
+	ASSERT(console_lit_pixels(&fb, 0, 8, 24, 16) > 0, "glyphs BCD not moved");
+	ASSERT_EQUAL_SIGNED(console_lit_pixels(&fb, 24, 8, 320, 64), 0, "stale pixels after moving the overlay");
+
+	// Clear: nothing must be drawn anymore
+	console_clear();
+	surface_clear(&fb, 0);
+	rdpq_attach(&fb, NULL);
+	console_render_overlay(0, 0, white);
+	rdpq_detach_wait();
+
+	ASSERT_EQUAL_SIGNED(console_lit_pixels(&fb, 0, 0, 320, 64), 0, "console not cleared");
+}
@@ -27,3 +27,89 @@ void test_dma_read_misalign(TestContext *ctx) {
 		}
 	}
 }
+
+void test_dma_queue(TestContext *ctx) {
+	// Read a large block of ROM with a low priority, then a small one with
+	// high priority. The second must complete first, as the first transfer
+	// is split in chunks.
+	const int big_len = 64*1024;
+	uint32_t big_rom = dfs_rom_addr("counter.dat") & 0x1FFFFFFE;
+	uint32_t small_rom = dfs_rom_addr("random.dat");
+	const int small_len = 8192-3;
+
+	uint8_t *big = malloc_uncached_aligned(8, big_len);
+	DEFER(free_uncached(big));
+	uint8_t *big_exp = malloc_uncached_aligned(8, big_len);
+	DEFER(free_uncached(big_exp));
+	uint8_t *small = malloc_uncached_aligned(8, small_len+16);
+	DEFER(free_uncached(small));
+	uint8_t *small_exp = malloc_uncached_aligned(8, small_len+16);
+	DEFER(free_uncached(small_exp));
+
+	dma_read(big_exp, big_rom, big_len);
+	dma_read(small_exp, small_rom, small_len);
+	memset(small+small_len, 0xAA, 16);
+
+	static dma_req_t * volatile order[2]; static volatile int norder;
+	norder = 0;
+	void done_cb(dma_req_t *req) {
+		order[norder++] = req;
+	}
+
+	dma_req_t rbig = {
+		.ram_address = big, .pi_address = big_rom, .len = big_len,
+		.priority = DMA_PRIORITY_NORMAL, .callback = done_cb,
+	};
+	dma_req_t rsmall = {
+		.ram_address = small, .pi_address = small_rom, .len = small_len,
+		.priority = DMA_PRIORITY_HIGH, .callback = done_cb,
+	};
+	dma_queue_read(&rbig);
+	dma_queue_read(&rsmall);
+	ASSERT(!dma_req_done(&rbig), "large transfer completed too early");
+
+	dma_req_wait(&rsmall);
+	dma_queue_wait();
+	ASSERT(dma_req_done(&rbig), "large transfer not completed");
+
+	ASSERT_EQUAL_SIGNED(norder, 2, "invalid number of callbacks");
+	ASSERT(order[0] == &rsmall, "high priority request did not complete first");
+	ASSERT(order[1] == &rbig, "low priority request did not complete last");
+
+	static const uint8_t expAA[16] = { 0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA,0xAA, };
+	ASSERT_EQUAL_MEM(big, big_exp, big_len, "invalid data in large transfer");
+	ASSERT_EQUAL_MEM(small, small_exp, small_len, "invalid data in small transfer");
+	ASSERT_EQUAL_MEM(small+small_len, expAA, 16, "small transfer overflowed");
+}
+
+void test_dma_queue_sync(TestContext *ctx) {
+	// Submit a large asynchronous read, then a synchronous one. The synchronous
+	// read must not wait for the whole queue to drain.
+	const int big_len = 64*1024;
+	uint32_t big_rom = dfs_rom_addr("counter.dat") & 0x1FFFFFFE;
+	uint32_t small_rom = dfs_rom_addr("random.dat");
+	const int small_len = 1024-3;
+
+	uint8_t *big = malloc_uncached_aligned(8, big_len);
+	DEFER(free_uncached(big));
+	uint8_t *small = malloc_uncached_aligned(8, small_len+16);
+	DEFER(free_uncached(small));
+	uint8_t *small_exp = malloc_uncached_aligned(8, small_len+16);
+	DEFER(free_uncached(small_exp));
+
+	dma_queue_read_wait(small_exp, small_rom, small_len, DMA_PRIORITY_NORMAL);
+
+	dma_req_t rbig = {
+		.ram_address = big, .pi_address = big_rom, .len = big_len,
+		.priority = DMA_PRIORITY_NORMAL,
+	};
+	dma_queue_read(&rbig);
+
+	// Use a misaligned destination, that the queue reads partly with the CPU
+	dma_read(small+3, small_rom+3, small_len-3);
+	ASSERT(!dma_req_done(&rbig), "synchronous read waited for the queued transfer");
+	dma_queue_wait();
+	ASSERT(dma_req_done(&rbig), "large transfer not completed");
+
+	ASSERT_EQUAL_MEM(small+3, small_exp+3, small_len-3, "invalid data in synchronous read");
+}
@@ -0,0 +1,98 @@
+#include "fgeom.h"
+
+#define ASSERT_NEAR(_a, _b, _eps, msg, ...) ({ \
+	float __a = (_a), __b = (_b); \
+	ASSERT(fabsf(__a - __b) <= (_eps), "%s: %f != %f " msg, #_a, __a, __b, ##__VA_ARGS__); \
+})
+
+void test_fgeom_rsqrt(TestContext *ctx) {
+	for (float x = 1e-3f; x < 1e6f; x *= 1.37f) {
+		float r = fm_rsqrtf(x);
+		ASSERT_NEAR(r * sqrtf(x), 1.0f, 1e-5f, "(x=%f)", x);
+	}
+}
+
+void test_fgeom_mat4(TestContext *ctx) {
+	fm_vec3_t axis = {{ 0, 0.6f, 0.8f }};
+	fm_vec3_t scale = {{ 2, 3, 0.5f }};
+	fm_vec3_t pos = {{ 5, -3, 7 }};
+	fm_quat_t q;
+	fm_quat_from_axis_angle(&q, &axis, 0.7f);
+
+	// Rotating via quaternion or via matrix must give the same result
+	fm_mat4_t rot;
+	fm_mat4_from_srt(&rot, NULL, &q, NULL);
+	fm_vec3_t v = {{ 1, -2, 0.5f }}, vq;
+	fm_vec4_t vm;
+	fm_quat_rotate(&vq, &q, &v);
+	fm_mat4_mul_vec3(&vm, &rot, &v);
+	for (int i=0; i<3; i++)
+		ASSERT_NEAR(vq.v[i], vm.v[i], 1e-4f, "(component %d)", i);
+	ASSERT_NEAR(vm.w, 1.0f, 1e-6f, "");
+
+	// M * M^-1 must be identity
+	fm_mat4_t m, inv, id;
+	fm_mat4_from_srt(&m, &scale, &q, &pos);
+	fm_mat4_affine_invert(&inv, &m);
+	fm_mat4_mul(&id, &m, &inv);
+	for (int i=0; i<4; i++)
+		for (int j=0; j<4; j++)
+			ASSERT_NEAR(id.m[i][j], i==j ? 1.0f : 0.0f, 1e-5f, "(element %d,%d)", i, j);
+
+	// Batch transform must match the single vector version
+	fm_vec3_t in[7]; fm_vec4_t out[7];
+	for (int i=0; i<7; i++)
+		in[i] = (fm_vec3_t){{ i*1.5f, -i*0.25f, i+2.0f }};
+	fm_mat4_transform_vec3(&m, in, 0, out, 0, 7);
+	for (int i=0; i<7; i++) {
+		fm_vec4_t exp;
+		fm_mat4_mul_vec3(&exp, &m, &in[i]);
+		ASSERT_EQUAL_MEM((uint8_t*)&out[i], (uint8_t*)&exp, sizeof(exp), "batch transform mismatch at %d", i);
+	}
+
+	// Fixed point conversion
+	fm_mat4_fixed_t fx;
+	fm_mat4_to_fixed(&fx, &m);
+	for (int i=0; i<4; i++)
+		for (int j=0; j<4; j++) {
+			float f = fx.integer[i][j] + fx.fraction[i][j] / 65536.0f;
+			ASSERT_NEAR(f, m.m[i][j], 1.0f/65536, "(element %d,%d)", i, j);
+		}
+}
+
+void test_fgeom_benchmark(TestContext *ctx) {
+	enum { N = 512 };
+	static fm_vec3_t in[N];
+	static fm_vec4_t out[N];
+	for (int i=0; i<N; i++)
+		in[i] = (fm_vec3_t){{ i, i*0.5f, -i }};
+
+	fm_mat4_t m;
+	fm_quat_t q;
+	fm_quat_from_axis_angle(&q, &(fm_vec3_t){{ 1, 0, 0 }}, 0.3f);
+	fm_mat4_from_srt(&m, NULL, &q, &(fm_vec3_t){{ 1, 2, 3 }});
+
+	uint32_t t0 = TICKS_READ();
+	for (int i=0; i<N; i++)
+		fm_mat4_mul_vec3(&out[i], &m, &in[i]);
+	uint32_t t1 = TICKS_READ();
+	fm_mat4_transform_vec3(&m, in, 0, out, 0, N);
+	uint32_t t2 = TICKS_READ();
+	LOG("transform %d vertices: single=%ld batch=%ld ticks\n", N,
+		TICKS_DISTANCE(t0, t1), TICKS_DISTANCE(t1, t2));
+
+	fm_mat4_t r = m;
+	t0 = TICKS_READ();
+	for (int i=0; i<64; i++)
+		fm_mat4_mul(&r, &r, &m);
+	t1 = TICKS_READ();
+	fm_vec3_t v = {{ 1, 2, 3 }};
+	volatile float sink = 0;
+	for (int i=0; i<64; i++) {
+		fm_vec3_norm(&v, &v);
+		sink += v.x;
+	}
+	t2 = TICKS_READ();
+	LOG("64 mat4 mul=%ld ticks, 64 vec3 norm=%ld ticks\n",
+		TICKS_DISTANCE(t0, t1), TICKS_DISTANCE(t1, t2));
+}
@@ -250,3 +250,470 @@ void test_gl_cull(TestContext *ctx)
     tri_count = debug_rdp_stream_count_cmd(RDPQ_CMD_TRI_SHADE + 0xC0);
     ASSERT_EQUAL_UNSIGNED(tri_count, 3, "Triangles should be drawn when culling disabled");
 }
+
+void test_gl_draw_queue(TestContext *ctx)
+{
+    GL_INIT();
+
+    GLuint tri_dlist = glGenLists(1);
+    glNewList(tri_dlist, GL_COMPILE);
+    glBegin(GL_TRIANGLES);
+    glVertex3f(0, 0, 0);
+    glVertex3f(0.5f, 0, 0);
+    glVertex3f(0, 0.5f, 0);
+    glEnd();
+    glEndList();
+
+    GLuint textures[2];
+    glGenTextures(2, textures);
+    glEnable(GL_TEXTURE_2D);
+
+    void queue_tri(GLuint texture, bool blend, float z) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        if (blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
+        glPushMatrix();
+        glTranslatef(0, 0, z);
+        glCallList(tri_dlist);
+        glPopMatrix();
+    }
+
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    glBeginDrawQueueN64();
+    queue_tri(textures[0], false, -0.8f);   // 0: opaque, far
+    queue_tri(textures[1], true,  -0.2f);   // 1: transparent, near
+    queue_tri(textures[1], false, -0.1f);   // 2: opaque, nearest
+    queue_tri(textures[0], false, -0.3f);   // 3: opaque
+    queue_tri(textures[0], true,  -0.6f);   // 4: transparent, far
+    glBindTexture(GL_TEXTURE_2D, textures[1]);
+    glDisable(GL_BLEND);
+    glEndDrawQueueN64();
+    ASSERT_EQUAL_HEX(glGetError(), GL_NO_ERROR, "Draw queue raised an error");
+
+    GLint draws, changes, unsorted_changes;
+    glGetIntegerv(GL_DRAW_QUEUE_DRAWS_N64, &draws);
+    glGetIntegerv(GL_DRAW_QUEUE_STATE_CHANGES_N64, &changes);
+    glGetIntegerv(GL_DRAW_QUEUE_UNSORTED_STATE_CHANGES_N64, &unsorted_changes);
+    ASSERT_EQUAL_SIGNED(draws, 5, "Wrong number of submitted draws");
+    // Sorted order: 2, 3, 0 (opaque, front to back and grouped by texture), then 4, 1
+    // (transparent, back to front).
+    ASSERT_EQUAL_SIGNED(changes, 3, "Wrong number of state changes");
+    ASSERT_EQUAL_SIGNED(unsorted_changes, 6, "Wrong number of state changes in API order");
+
+    glDeleteTextures(2, textures);
+}
+
+void test_gl_texture_residency(TestContext *ctx)
+{
+    GL_INIT();
+
+    // 8x8 RGBA16: 16 bytes per row in TMEM
+    surface_t tex = surface_alloc(FMT_RGBA16, 8, 8);
+    DEFER(surface_free(&tex));
+    surface_clear(&tex, 0xFF);
+
+    GLuint textures[2];
+    glGenTextures(2, textures);
+    DEFER(glDeleteTextures(2, textures));
+    for (int i = 0; i < 2; i++) {
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glSurfaceTexImageN64(GL_TEXTURE_2D, 0, &tex, NULL);
+    }
+    glEnable(GL_TEXTURE_2D);
+
+    GLuint tri_dlist = glGenLists(1);
+    DEFER(glDeleteLists(tri_dlist, 1));
+    glNewList(tri_dlist, GL_COMPILE);
+    glBegin(GL_TRIANGLES);
+    glTexCoord2f(0, 0); glVertex2f(-0.5f, -0.5f);
+    glTexCoord2f(1, 0); glVertex2f(0.5f, -0.5f);
+    glTexCoord2f(0, 1); glVertex2f(-0.5f, 0.5f);
+    glEnd();
+    glEndList();
+
+    GLint loads, load_bytes;
+    void check_loads(int expected, const char *msg) {
+        glGetIntegerv(GL_TEXTURE_LOADS_N64, &loads);
+        glGetIntegerv(GL_TEXTURE_LOAD_BYTES_N64, &load_bytes);
+        ASSERT_EQUAL_SIGNED(loads, expected, "%s: wrong number of texture loads", msg);
+        ASSERT_EQUAL_SIGNED(load_bytes, expected * 8 * 16, "%s: wrong number of loaded bytes", msg);
+    }
+
+    // Consecutive draws with the same texture load it only once, even if
+    // another texture is bound in between.
+    glBindTexture(GL_TEXTURE_2D, textures[0]);
+    glCallList(tri_dlist);
+    glCallList(tri_dlist);
+    glBindTexture(GL_TEXTURE_2D, textures[1]);
+    glBindTexture(GL_TEXTURE_2D, textures[0]);
+    glCallList(tri_dlist);
+    check_loads(1, "same texture");
+    if (ctx->result == TEST_FAILED) return;
+
+    glBindTexture(GL_TEXTURE_2D, textures[1]);
+    glCallList(tri_dlist);
+    check_loads(2, "texture change");
+    if (ctx->result == TEST_FAILED) return;
+
+    GLboolean residences[2] = { GL_TRUE, GL_FALSE };
+    ASSERT(!glAreTexturesResident(2, textures, residences), "Both textures reported as resident");
+    ASSERT(!residences[0], "Texture 0 reported as resident");
+    ASSERT(residences[1], "Texture 1 not reported as resident");
+    ASSERT(glAreTexturesResident(1, &textures[1], residences), "Texture 1 not reported as resident");
+
+    // A plain rdpq load overwrites TMEM, so the texture must be loaded again
+    rdpq_tex_upload(TILE0, &tex, NULL);
+    ASSERT(!glAreTexturesResident(1, &textures[1], residences), "Texture 1 reported as resident after a rdpq load");
+    glCallList(tri_dlist);
+    check_loads(3, "rdpq load");
+    if (ctx->result == TEST_FAILED) return;
+
+    // The draw queue submits the texture with the highest priority last,
+    // so that it stays resident.
+    void run_queue(void) {
+        glBeginDrawQueueN64();
+        glBindTexture(GL_TEXTURE_2D, textures[0]);
+        glCallList(tri_dlist);
+        glBindTexture(GL_TEXTURE_2D, textures[1]);
+        glCallList(tri_dlist);
+        glEndDrawQueueN64();
+    }
+
+    GLclampf priorities[2] = { 1.0f, 0.5f };
+    glPrioritizeTextures(2, textures, priorities);
+    run_queue();
+    ASSERT(glAreTexturesResident(1, &textures[0], residences), "Texture 0 with highest priority not resident");
+
+    priorities[0] = 0.0f;
+    glPrioritizeTextures(2, textures, priorities);
+    run_queue();
+    ASSERT(glAreTexturesResident(1, &textures[1], residences), "Texture 1 with highest priority not resident");
+    ASSERT_EQUAL_HEX(glGetError(), GL_NO_ERROR, "Residency queries raised an error");
+}
+
+void test_gl_secondary_texture(TestContext *ctx)
+{
+    GL_INIT();
+
+    surface_t tex_red = surface_alloc(FMT_RGBA16, 8, 8);
+    DEFER(surface_free(&tex_red));
+    for (int i = 0; i < 8*8; i++) ((uint16_t*)tex_red.buffer)[i] = color_to_packed16(RGBA32(0xFF, 0, 0, 0xFF));
+
+    // Lightmap at 50% intensity
+    surface_t tex_gray = surface_alloc(FMT_I8, 8, 8);
+    DEFER(surface_free(&tex_gray));
+    surface_clear(&tex_gray, 0x80);
+
+    GLuint textures[2];
+    glGenTextures(2, textures);
+    DEFER(glDeleteTextures(2, textures));
+    glBindTexture(GL_TEXTURE_2D, textures[1]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glSurfaceTexImageN64(GL_TEXTURE_2D, 0, &tex_gray, NULL);
+    glBindTexture(GL_TEXTURE_2D, textures[0]);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glSurfaceTexImageN64(GL_TEXTURE_2D, 0, &tex_red, NULL);
+    glEnable(GL_TEXTURE_2D);
+    glDisable(GL_DITHER);
+
+    void draw_quad(void) {
+        glBegin(GL_TRIANGLE_STRIP);
+        glColor3f(1, 1, 1);
+        glTexCoord2f(0, 0); glVertex2f(-1, -1);
+        glTexCoord2f(1, 0); glVertex2f(1, -1);
+        glTexCoord2f(0, 1); glVertex2f(-1, 1);
+        glTexCoord2f(1, 1); glVertex2f(1, 1);
+        glEnd();
+    }
+
+    int read_red(void) {
+        rspq_wait();
+        color_t c = color_from_packed16(((uint16_t*)test_surf.buffer)[32 * test_surf.width + 32]);
+        return c.r;
+    }
+
+    int draw_and_read_red(void) {
+        glClearColor(0, 0, 0, 0);
+        glClear(GL_COLOR_BUFFER_BIT);
+        draw_quad();
+        return read_red();
+    }
+
+    int red = draw_and_read_red();
+    ASSERT(red >= 0xF0, "Texture not drawn (red: %02x)", red);
+
+    glSecondaryTextureN64(textures[1], GL_MODULATE, NULL);
+    GLint binding;
+    glGetIntegerv(GL_SECONDARY_TEXTURE_BINDING_N64, &binding);
+    ASSERT_EQUAL_HEX(binding, textures[1], "Wrong secondary texture binding");
+
+    red = draw_and_read_red();
+    ASSERT(red >= 0x70 && red <= 0x90, "Secondary texture not modulated (red: %02x)", red);
+
+    // Start a new frame: the secondary texture must be loaded again
+    gl_context_end();
+    gl_context_begin();
+    red = draw_and_read_red();
+    ASSERT(red >= 0x70 && red <= 0x90, "Secondary texture not reloaded (red: %02x)", red);
+
+    // A display list must keep working after the secondary texture is changed
+    // (which frees the upload block of the previous one)
+    GLuint list = glGenLists(1);
+    DEFER(glDeleteLists(list, 1));
+    glNewList(list, GL_COMPILE);
+    draw_quad();
+    glEndList();
+    glSecondaryTextureN64(0, GL_MODULATE, NULL);
+    glSecondaryTextureN64(textures[1], GL_MODULATE, NULL);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glCallList(list);
+    red = read_red();
+    ASSERT(red >= 0x70 && red <= 0x90, "Secondary texture not loaded by display list (red: %02x)", red);
+
+    glSecondaryTextureN64(0, GL_MODULATE, NULL);
+    red = draw_and_read_red();
+    ASSERT(red >= 0xF0, "Secondary texture not disabled (red: %02x)", red);
+    ASSERT_EQUAL_HEX(glGetError(), GL_NO_ERROR, "Secondary texture raised an error");
+}
+
+void test_gl_tex_image_fast_paths(TestContext *ctx)
+{
+    GL_INIT();
+
+    enum { WIDTH = 16, HEIGHT = 8 };
+    static uint8_t pixels[WIDTH * HEIGHT * 4];
+    for (int i = 0; i < sizeof(pixels); i++) pixels[i] = RANDN(256);
+
+    static const GLenum internal_formats[] = { GL_RGB5_A1, GL_RGBA8, GL_LUMINANCE4_ALPHA4, GL_LUMINANCE8_ALPHA8, GL_INTENSITY4, GL_INTENSITY8 };
+    static const GLenum formats[] = { GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB, GL_RGBA };
+
+    GLuint textures[2];
+    glGenTextures(2, textures);
+    DEFER(glDeleteTextures(2, textures));
+
+    for (int i = 0; i < sizeof(internal_formats) / sizeof(internal_formats[0]); i++) {
+        for (int j = 0; j < sizeof(formats) / sizeof(formats[0]); j++) {
+            // Upload with the fast path, and then with the generic one. Swapping bytes
+            // has no effect on GL_UNSIGNED_BYTE data, but disables the fast path.
+            glBindTexture(GL_TEXTURE_2D, textures[0]);
+            glTexImage2D(GL_TEXTURE_2D, 0, internal_formats[i], WIDTH, HEIGHT, 0, formats[j], GL_UNSIGNED_BYTE, pixels);
+            surface_t *fast = &gl_get_active_texture()->surfaces[0];
+
+            glPixelStorei(GL_UNPACK_SWAP_BYTES, GL_TRUE);
+            glBindTexture(GL_TEXTURE_2D, textures[1]);
+            glTexImage2D(GL_TEXTURE_2D, 0, internal_formats[i], WIDTH, HEIGHT, 0, formats[j], GL_UNSIGNED_BYTE, pixels);
+            surface_t *generic = &gl_get_active_texture()->surfaces[0];
+            glPixelStorei(GL_UNPACK_SWAP_BYTES, GL_FALSE);
+
+            int row_bytes = TEX_FORMAT_PIX2BYTES(surface_get_format(fast), WIDTH);
+            for (int y = 0; y < HEIGHT; y++) {
+                ASSERT_EQUAL_MEM((uint8_t*)fast->buffer + y * fast->stride, (uint8_t*)generic->buffer + y * generic->stride, row_bytes,
+                    "Fast path mismatch: internal format %#lx, format %#lx, row %d", internal_formats[i], formats[j], y);
+            }
+        }
+    }
+}
+
+void test_gl_preconverted_buffer(TestContext *ctx)
+{
+    GL_INIT();
+
+    // Positions followed by colors, in the same buffer
+    static const GLfloat data[] = {
+        -1.0f, -1.0f,   0.5f, -1.0f,   -1.0f, 0.5f,   0.5f, 0.5f,
+        1.0f, 0.0f, 0.0f,   0.0f, 1.0f, 0.0f,   0.0f, 0.0f, 1.0f,   1.0f, 1.0f, 1.0f,
+    };
+    static const GLfloat green[] = { 0.0f, 1.0f, 0.0f };
+    const int colors_offset = 8 * sizeof(GLfloat);
+    const int fb_size = test_surf.stride * test_surf.height;
+
+    uint8_t *expected = malloc(fb_size);
+    DEFER(free(expected));
+
+    glDisable(GL_DITHER);
+    glDisable(GL_DEPTH_TEST);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    void draw(void) {
+        glClearColor(0, 0, 0, 0);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        rspq_wait();
+    }
+
+    // Reference image, from client arrays
+    glVertexPointer(2, GL_FLOAT, 0, data);
+    glColorPointer(3, GL_FLOAT, 0, (const uint8_t*)data + colors_offset);
+    draw();
+    memcpy(expected, test_surf.buffer, fb_size);
+
+    GLuint id;
+    glGenBuffersARB(1, &id);
+    DEFER(glDeleteBuffersARB(1, &id));
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, id);
+    glBufferDataARB(GL_ARRAY_BUFFER_ARB, sizeof(data), data, GL_STATIC_DRAW_PRECONVERTED_N64);
+    gl_buffer_object_t *obj = (gl_buffer_object_t*)id;
+
+    GLint usage;
+    glGetBufferParameterivARB(GL_ARRAY_BUFFER_ARB, GL_BUFFER_USAGE_ARB, &usage);
+    ASSERT_EQUAL_HEX(usage, GL_STATIC_DRAW_PRECONVERTED_N64, "Wrong buffer usage");
+
+    glVertexPointer(2, GL_FLOAT, 0, (const GLvoid*)0);
+    glColorPointer(3, GL_FLOAT, 0, (const GLvoid*)colors_offset);
+    draw();
+    ASSERT(obj->converted != NULL, "Buffer not converted");
+    ASSERT_EQUAL_UNSIGNED(obj->converted_count, 4, "Wrong number of converted vertices");
+    ASSERT_EQUAL_MEM((uint8_t*)test_surf.buffer, expected, fb_size, "Preconverted buffer rendered differently");
+
+    // Drawing again must reuse the converted vertices
+    uint32_t *converted = obj->converted;
+    draw();
+    ASSERT(obj->converted == converted, "Buffer converted again");
+    ASSERT_EQUAL_MEM((uint8_t*)test_surf.buffer, expected, fb_size, "Cached vertices rendered differently");
+
+    // Modifying the buffer must discard the converted vertices
+    glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, colors_offset, sizeof(green), green);
+    ASSERT(obj->converted == NULL, "Converted vertices not discarded");
+    draw();
+    color_t c = color_from_packed16(((uint16_t*)test_surf.buffer)[60 * test_surf.width + 3]);
+    ASSERT(c.g > 0x80 && c.r < 0x80, "Modified color not drawn (%02x,%02x,%02x)", c.r, c.g, c.b);
+
+    // A different layout must be converted again
+    glDisableClientState(GL_COLOR_ARRAY);
+    draw();
+    ASSERT_EQUAL_UNSIGNED(obj->converted_words, 1, "Wrong size of converted vertices");
+    ASSERT_EQUAL_HEX(glGetError(), GL_NO_ERROR, "Preconverted buffer raised an error");
+}
+
+void test_gl_draw_instanced(TestContext *ctx)
+{
+    GL_INIT();
+
+    debug_rdp_stream_init();
+
+    // A small square in the bottom left corner
+    static const GLfloat vertices[] = {
+        -1.0f, -1.0f,   -0.75f, -1.0f,   -1.0f, -0.75f,   -0.75f, -0.75f,
+    };
+    static const GLubyte indices[] = { 0, 1, 2, 2, 1, 3 };
+
+    enum { INSTANCES = 4 };
+    GLfloat matrices[INSTANCES][16];
+    for (int i = 0; i < INSTANCES; i++) {
+        memset(matrices[i], 0, sizeof(matrices[i]));
+        matrices[i][0] = matrices[i][5] = matrices[i][10] = matrices[i][15] = 1.0f;
+        // Move each instance along the diagonal
+        matrices[i][12] = matrices[i][13] = i * 0.5f;
+    }
+
+    glDisable(GL_DITHER);
+    glDisable(GL_DEPTH_TEST);
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glColor3f(1, 1, 1);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, vertices);
+    glDrawElementsInstancedN64(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE, indices, INSTANCES, matrices[0]);
+    glFinish();
+
+    uint32_t tri_count = debug_rdp_stream_count_cmd(RDPQ_CMD_TRI_SHADE + 0xC0);
+    ASSERT_EQUAL_UNSIGNED(tri_count, INSTANCES * 2, "Wrong number of triangles!");
+
+    for (int i = 0; i < INSTANCES; i++) {
+        // Center of the instance (the framebuffer is flipped vertically)
+        int x = 4 + i * 16, y = 63 - 4 - i * 16;
+        color_t c = color_from_packed16(((uint16_t*)test_surf.buffer)[y * test_surf.width + x]);
+        ASSERT(c.r > 0x80 && c.g > 0x80 && c.b > 0x80, "Instance %d not drawn", i);
+    }
+    ASSERT_EQUAL_HEX(glGetError(), GL_NO_ERROR, "Instanced draw raised an error");
+
+    // Instances are drawn one by one while the caller is recording a block
+    debug_rdp_stream_reset();
+    rspq_block_begin();
+    glDrawElementsInstancedN64(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE, indices, INSTANCES, matrices[0]);
+    rspq_block_t *block = rspq_block_end();
+    DEFER(rspq_block_free(block));
+    rspq_block_run(block);
+    glFinish();
+
+    tri_count = debug_rdp_stream_count_cmd(RDPQ_CMD_TRI_SHADE + 0xC0);
+    ASSERT_EQUAL_UNSIGNED(tri_count, INSTANCES * 2, "Wrong number of triangles in a block!");
+
+    // The matrix stack must be left untouched
+    GLfloat modelview[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+    ASSERT(modelview[12] == 0.0f && modelview[13] == 0.0f, "Modelview matrix modified");
+
+    // With a full modelview stack, nothing is drawn and the stack is preserved
+    int max_depth = MODELVIEW_STACK_SIZE;
+    for (int i = 1; i < max_depth; i++) {
+        glPushMatrix();
+        glTranslatef(1.0f, 0, 0);
+    }
+    ASSERT_EQUAL_HEX(glGetError(), GL_NO_ERROR, "Filling the matrix stack raised an error");
+    debug_rdp_stream_reset();
+    glDrawElementsInstancedN64(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE, indices, INSTANCES, matrices[0]);
+    glFinish();
+    ASSERT_EQUAL_HEX(glGetError(), GL_STACK_OVERFLOW, "Instanced draw on a full stack did not overflow");
+    tri_count = debug_rdp_stream_count_cmd(RDPQ_CMD_TRI_SHADE + 0xC0);
+    ASSERT_EQUAL_UNSIGNED(tri_count, 0, "Instanced draw on a full stack drew triangles");
+    for (int i = max_depth - 1; i > 0; i--) {
+        glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+        ASSERT(modelview[12] == (float)i, "Modelview stack corrupted at depth %d", i);
+        glPopMatrix();
+    }
+}
+
+void test_gl_guard_band(TestContext *ctx)
+{
+    GL_INIT();
+
+    debug_rdp_stream_init();
+
+    // The viewport is small, so the guard band is the largest possible
+    GLint guard_band = GUARD_BAND_MAX_FACTOR;
+
+    glDisable(GL_DITHER);
+    glDisable(GL_DEPTH_TEST);
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glColor3f(1, 1, 1);
+
+    // A triangle that exceeds the viewport but stays within the guard band
+    float x = guard_band - 2;
+    glBegin(GL_TRIANGLES);
+    glVertex2f(-x, -1.0f);
+    glVertex2f(x, -1.0f);
+    glVertex2f(0.0f, 1.0f);
+    glEnd();
+    glFinish();
+
+    uint32_t tri_count = debug_rdp_stream_count_cmd(RDPQ_CMD_TRI_SHADE + 0xC0);
+    ASSERT_EQUAL_UNSIGNED(tri_count, 1, "Triangle within the guard band was clipped!");
+
+    color_t c = color_from_packed16(((uint16_t*)test_surf.buffer)[48 * test_surf.width + 32]);
+    ASSERT(c.r > 0x80 && c.g > 0x80 && c.b > 0x80, "Triangle not drawn");
+
+    // A triangle that exceeds the guard band must be clipped, and still cover the viewport
+    debug_rdp_stream_reset();
+    glClear(GL_COLOR_BUFFER_BIT);
+    x = guard_band * 4;
+    glBegin(GL_TRIANGLES);
+    glVertex2f(-x, -1.0f);
+    glVertex2f(x, -1.0f);
+    glVertex2f(0.0f, 1.0f);
+    glEnd();
+    glFinish();
+
+    tri_count = debug_rdp_stream_count_cmd(RDPQ_CMD_TRI_SHADE + 0xC0);
+    ASSERT(tri_count > 1, "Triangle outside of the guard band was not clipped!");
+
+    c = color_from_packed16(((uint16_t*)test_surf.buffer)[60 * test_surf.width + 2]);
+    ASSERT(c.r > 0x80 && c.g > 0x80 && c.b > 0x80, "Clipped triangle not drawn");
+
+    ASSERT_EQUAL_HEX(glGetError(), GL_NO_ERROR, "Guard band test raised an error");
+}
@@ -0,0 +1,376 @@
+// Performance tests. These are run only in benchmark mode (testrom_bench.z64),
+// and report their results via PERF(). See tests/benchcompare.py to compare
+// two runs.
+
+#include "../src/asset_internal.h"
+#include "../src/compress/lzh5_internal.h"
+#include <rspq_profile.h>
+
+// From lz4_dec_internal.h, which can't be included here because it pulls
+// in stdlib.h, whose rand() conflicts with the testsuite one.
+int decompress_lz4_full_mem(const unsigned char *src, int src_size,
+    unsigned char *dst, int dst_size, bool dma_race);
+
+// Attach to an offscreen surface without rdpq debugging, which would
+// skew the measurements.
+#define PERF_RDPQ_INIT(w, h) \
+	rspq_init(); DEFER(rspq_close()); \
+	rdpq_init(); DEFER(rdpq_close()); \
+	surface_t perf_fb = surface_alloc(FMT_RGBA16, w, h); \
+	DEFER(surface_free(&perf_fb)); \
+	rdpq_attach(&perf_fb, NULL); \
+	DEFER(rdpq_detach_wait());
+
+void test_perf_rspq_commands(TestContext *ctx) {
+	rspq_init();
+	DEFER(rspq_close());
+
+	enum { N = 20000 };
+	rspq_wait();
+	uint32_t t0 = TICKS_READ();
+	for (int i=0; i<N; i++)
+		rspq_noop();
+	rspq_wait();
+	uint32_t t1 = TICKS_READ();
+
+	PERF("commands", N / TICKS_TO_SECS(TICKS_DISTANCE(t0, t1)), "cmd/s");
+}
+
+void test_perf_rdpq_rects(TestContext *ctx) {
+	PERF_RDPQ_INIT(320, 240);
+
+	enum { N = 2000, SIZE = 16 };
+	rdpq_set_mode_fill(RGBA32(0x40, 0x80, 0xC0, 0xFF));
+	rspq_wait();
+
+	uint32_t t0 = TICKS_READ();
+	for (int i=0; i<N; i++) {
+		int x = (i * 37) % (320 - SIZE), y = (i * 23) % (240 - SIZE);
+		rdpq_fill_rectangle(x, y, x + SIZE, y + SIZE);
+	}
+	rspq_wait();
+	uint32_t t1 = TICKS_READ();
+
+	float secs = TICKS_TO_SECS(TICKS_DISTANCE(t0, t1));
+	PERF("rects", N / secs, "rect/s");
+	PERF("fillrate", N * SIZE * SIZE / secs / 1e6f, "Mpix/s");
+}
+
+void test_perf_rdpq_triangles(TestContext *ctx) {
+	PERF_RDPQ_INIT(320, 240);
+
+	enum { N = 2000 };
+	rdpq_set_mode_fill(RGBA32(0xC0, 0x80, 0x40, 0xFF));
+	rspq_wait();
+
+	uint32_t t0 = TICKS_READ();
+	for (int i=0; i<N; i++) {
+		float x = (i * 37) % 300, y = (i * 23) % 220;
+		float v1[] = { x, y }, v2[] = { x + 20, y + 4 }, v3[] = { x + 6, y + 18 };
+		rdpq_triangle(&TRIFMT_FILL, v1, v2, v3);
+	}
+	rspq_wait();
+	uint32_t t1 = TICKS_READ();
+
+	PERF("triangles", N / TICKS_TO_SECS(TICKS_DISTANCE(t0, t1)), "tri/s");
+}
+
+void test_perf_dfs_read(TestContext *ctx) {
+	enum { REPEAT = 64 };
+	int fh = dfs_open("random.dat");
+	ASSERT(fh >= 0, "cannot open random.dat");
+	DEFER(dfs_close(fh));
+	int size = dfs_size(fh);
+	uint8_t *buf = malloc(size);
+	DEFER(free(buf));
+
+	uint32_t t0 = TICKS_READ();
+	for (int i=0; i<REPEAT; i++) {
+		dfs_seek(fh, 0, SEEK_SET);
+		int n = dfs_read(buf, 1, size, fh);
+		ASSERT_EQUAL_SIGNED(n, size, "short read");
+	}
+	uint32_t t1 = TICKS_READ();
+
+	PERF("read", (float)size * REPEAT / TICKS_TO_SECS(TICKS_DISTANCE(t0, t1)) / (1024*1024), "MiB/s");
+}
+
+// Load a compressed asset in memory without decompressing it
+static uint8_t *perf_load_compressed(const char *fn, asset_header_t *header) {
+	FILE *f = fopen(fn, "rb");
+	if (!f) return NULL;
+	fread(header, 1, sizeof(asset_header_t), f);
+	uint8_t *buf = malloc(header->cmp_size);
+	fread(buf, 1, header->cmp_size, f);
+	fclose(f);
+	return buf;
+}
+
+void test_perf_decompress(TestContext *ctx) {
+	enum { REPEAT = 16 };
+	asset_header_t h1, h2;
+	uint8_t *lz4 = perf_load_compressed("rom:/perf_sprite.c1", &h1);
+	ASSERT(lz4, "cannot open perf_sprite.c1");
+	DEFER(free(lz4));
+	uint8_t *lzh5 = perf_load_compressed("rom:/perf_sprite.c2", &h2);
+	ASSERT(lzh5, "cannot open perf_sprite.c2");
+	DEFER(free(lzh5));
+	ASSERT_EQUAL_UNSIGNED(h1.algo, 1, "perf_sprite.c1 is not LZ4-compressed");
+	ASSERT_EQUAL_UNSIGNED(h2.algo, 2, "perf_sprite.c2 is not LZH5-compressed");
+
+	uint8_t *out = malloc(h1.orig_size);
+	DEFER(free(out));
+
+	uint32_t t0 = TICKS_READ();
+	for (int i=0; i<REPEAT; i++) {
+		int n = decompress_lz4_full_mem(lz4, h1.cmp_size, out, h1.orig_size, false);
+		ASSERT_EQUAL_SIGNED(n, h1.orig_size, "LZ4 decompression error");
+	}
+	uint32_t t1 = TICKS_READ();
+	for (int i=0; i<REPEAT; i++) {
+		FILE *f = fmemopen(lzh5, h2.cmp_size, "rb");
+		int n = decompress_lz5h_full(f, out, h2.orig_size);
+		fclose(f);
+		ASSERT_EQUAL_SIGNED(n, h2.orig_size, "LZH5 decompression error");
+	}
+	uint32_t t2 = TICKS_READ();
+
+	PERF("lz4", (float)h1.orig_size * REPEAT / TICKS_TO_SECS(TICKS_DISTANCE(t0, t1)) / (1024*1024), "MiB/s");
+	PERF("lzh5", (float)h2.orig_size * REPEAT / TICKS_TO_SECS(TICKS_DISTANCE(t1, t2)) / (1024*1024), "MiB/s");
+}
+
+static int16_t perf_wave_samples[1024];
+
+static void perf_wave_read(void *wctx, samplebuffer_t *sbuf, int wpos, int wlen, bool seeking) {
+	int16_t *dst = samplebuffer_append(sbuf, wlen);
+	for (int i=0; i<wlen; i++)
+		dst[i] = perf_wave_samples[(wpos + i) % 1024];
+}
+
+void test_perf_mixer(TestContext *ctx) {
+	enum { CHANNELS = 16, FREQ = 32000, POLL = 512, SECONDS = 1 };
+	for (int i=0; i<1024; i++)
+		perf_wave_samples[i] = (i * 97) ^ (i << 7);
+
+	audio_init(FREQ, 4);
+	DEFER(audio_close());
+	mixer_init(CHANNELS);
+	DEFER(mixer_close());
+
+	waveform_t wave = {
+		.name = "perf", .bits = 16, .channels = 1, .frequency = FREQ,
+		.len = 1024, .loop_len = 1024, .read = perf_wave_read,
+	};
+	for (int ch=0; ch<CHANNELS; ch++) {
+		mixer_ch_play(ch, &wave);
+		// Use different frequencies to exercise the resampler
+		mixer_ch_set_freq(ch, FREQ * (0.5f + ch * 0.1f));
+		mixer_ch_set_vol(ch, 0.5f, 0.5f);
+	}
+
+	int16_t *out = malloc_uncached(POLL * 2 * sizeof(int16_t));
+	DEFER(free_uncached(out));
+
+	uint32_t t0 = TICKS_READ();
+	for (int i=0; i<FREQ * SECONDS / POLL; i++)
+		mixer_poll(out, POLL);
+	uint32_t t1 = TICKS_READ();
+
+	// Milliseconds of audio mixed per millisecond of time, for each channel:
+	// the number of channels that could be mixed in real time.
+	float audio_ms = (float)(FREQ * SECONDS / POLL * POLL) * 1000 / FREQ;
+	float wall_ms = TICKS_TO_SECS(TICKS_DISTANCE(t0, t1)) * 1000;
+	PERF("channels", CHANNELS * audio_ms / wall_ms, "ch*ms/ms");
+}
+
+void test_perf_gl_vertices(TestContext *ctx) {
+	PERF_RDPQ_INIT(320, 240);
+	gl_init();
+	DEFER(gl_close());
+	gl_context_begin();
+	DEFER(gl_context_end());
+
+	enum { NTRIS = 1000, NVERTS = NTRIS*3 };
+	float *pos = malloc(NVERTS * 3 * sizeof(float));
+	DEFER(free(pos));
+	uint8_t *col = malloc(NVERTS * 4);
+	DEFER(free(col));
+	for (int i=0; i<NVERTS; i++) {
+		float cx = ((i/3 * 37) % 200) / 100.0f - 1.0f;
+		float cy = ((i/3 * 23) % 200) / 100.0f - 1.0f;
+		pos[i*3+0] = cx + ((i%3) == 1 ? 0.08f : 0);
+		pos[i*3+1] = cy + ((i%3) == 2 ? 0.08f : 0);
+		pos[i*3+2] = 0;
+		col[i*4+0] = i; col[i*4+1] = i*3; col[i*4+2] = i*7; col[i*4+3] = 0xFF;
+	}
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, pos);
+	glColorPointer(4, GL_UNSIGNED_BYTE, 0, col);
+	glFinish();
+
+	uint32_t t0 = TICKS_READ();
+	glDrawArrays(GL_TRIANGLES, 0, NVERTS);
+	glFinish();
+	uint32_t t1 = TICKS_READ();
+
+	PERF("vertices", NVERTS / TICKS_TO_SECS(TICKS_DISTANCE(t0, t1)), "vtx/s");
+}
+
+void test_perf_gl_vbo(TestContext *ctx) {
+	PERF_RDPQ_INIT(320, 240);
+	gl_init();
+	DEFER(gl_close());
+	gl_context_begin();
+	DEFER(gl_context_end());
+
+	enum { NVERTS = 10002 };
+	const int colors_offset = NVERTS * 3 * sizeof(float);
+	uint8_t *data = malloc(colors_offset + NVERTS * 4);
+	DEFER(free(data));
+	float *pos = (float*)data;
+	uint8_t *col = data + colors_offset;
+	for (int i=0; i<NVERTS; i++) {
+		pos[i*3+0] = ((i/3 * 37) % 200) / 100.0f - 1.0f + ((i%3) == 1 ? 0.08f : 0);
+		pos[i*3+1] = ((i/3 * 23) % 200) / 100.0f - 1.0f + ((i%3) == 2 ? 0.08f : 0);
+		pos[i*3+2] = 0;
+		col[i*4+0] = i; col[i*4+1] = i*3; col[i*4+2] = i*7; col[i*4+3] = 0xFF;
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+
+	GLuint buffers[2];
+	glGenBuffersARB(2, buffers);
+	DEFER(glDeleteBuffersARB(2, buffers));
+
+	// Measure only the CPU side, by compiling the draw into a display list
+	// (so that the RSP does not run and cannot stall the command queue).
+	float draw(GLuint buffer, GLenum usage) {
+		glBindBufferARB(GL_ARRAY_BUFFER_ARB, buffer);
+		glBufferDataARB(GL_ARRAY_BUFFER_ARB, colors_offset + NVERTS * 4, data, usage);
+		glVertexPointer(3, GL_FLOAT, 0, (const GLvoid*)0);
+		glColorPointer(4, GL_UNSIGNED_BYTE, 0, (const GLvoid*)colors_offset);
+
+		GLuint list = glGenLists(1);
+		glNewList(list, GL_COMPILE);
+		glDrawArrays(GL_TRIANGLES, 0, NVERTS);	// Warm up (this converts preconverted buffers)
+		uint32_t t0 = TICKS_READ();
+		glDrawArrays(GL_TRIANGLES, 0, NVERTS);
+		uint32_t t1 = TICKS_READ();
+		glEndList();
+		glDeleteLists(list, 1);
+		return NVERTS / TICKS_TO_SECS(TICKS_DISTANCE(t0, t1));
+	}
+
+	PERF("static", draw(buffers[0], GL_STATIC_DRAW_ARB), "vtx/s");
+	PERF("preconverted", draw(buffers[1], GL_STATIC_DRAW_PRECONVERTED_N64), "vtx/s");
+}
+
+void test_perf_gl_clipping(TestContext *ctx) {
+	PERF_RDPQ_INIT(320, 240);
+	gl_init();
+	DEFER(gl_close());
+	gl_context_begin();
+	DEFER(gl_context_end());
+
+	// A ground plane seen in perspective: the nearest rows extend far out
+	// of the screen to the sides, which is where the guard band avoids clipping.
+	enum { COLS = 32, ROWS = 16, NTRIS = COLS * ROWS * 2, NVERTS = NTRIS * 3 };
+	float *pos = malloc(NVERTS * 3 * sizeof(float));
+	DEFER(free(pos));
+	float *p = pos;
+	for (int z=0; z<ROWS; z++) {
+		for (int x=0; x<COLS; x++) {
+			float x0 = (x - COLS/2) * 2.0f, x1 = x0 + 2.0f;
+			float z0 = -1.5f - z * 2.0f, z1 = z0 - 2.0f;
+			float quad[6][2] = { {x0,z0}, {x1,z0}, {x0,z1}, {x0,z1}, {x1,z0}, {x1,z1} };
+			for (int i=0; i<6; i++) {
+				*p++ = quad[i][0]; *p++ = -1.0f; *p++ = quad[i][1];
+			}
+		}
+	}
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_CULL_FACE);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glFrustum(-1, 1, -0.75f, 0.75f, 1, 100);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+	glColor3f(1, 1, 1);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, pos);
+	glFinish();
+
+	// The clipping cost is paid by the RSP, so the GL pipeline overlay is
+	// measured with the rspq profiler when it is compiled in (RSPQ_PROFILE):
+	// the result is then the throughput of that overlay alone.
+	float draw(void) {
+		rspq_profile_start();
+		uint32_t t0 = TICKS_READ();
+		glDrawArrays(GL_TRIANGLES, 0, NVERTS);
+		rspq_profile_next_frame();
+		rspq_wait();
+		uint32_t t1 = TICKS_READ();
+
+		if (!RSPQ_PROFILE)
+			return NTRIS / TICKS_TO_SECS(TICKS_DISTANCE(t0, t1));
+
+		rspq_profile_data_t data;
+		rspq_profile_get_data(&data);
+		for (int i=0; i<RSPQ_PROFILE_SLOT_COUNT; i++) {
+			if (data.slots[i].name && !strcmp(data.slots[i].name, "rsp_gl_pipeline"))
+				return NTRIS / ((float)data.slots[i].total_ticks / RCP_FREQUENCY);
+		}
+		return 0;
+	}
+
+	// Force the fixed guard band that was used before it adapted to the viewport
+	// (only the RSP copy, as the CPU pipeline is not involved here)
+	gl_set_long(GL_UPDATE_NONE, offsetof(gl_server_state_t, guard_band),
+		(1ull << 48) | (1ull << 32) | ((uint64_t)GUARD_BAND_FACTOR << 16) | GUARD_BAND_FACTOR);
+	PERF("ground_fixed", draw(), "tris/s");
+
+	glViewport(0, 0, 320, 240);
+	PERF("ground", draw(), "tris/s");
+}
+
+void test_perf_gl_teximage(TestContext *ctx) {
+	PERF_RDPQ_INIT(320, 240);
+	gl_init();
+	DEFER(gl_close());
+	gl_context_begin();
+	DEFER(gl_context_end());
+
+	enum { N = 50, SIZE = 64 };
+	uint8_t *pixels = malloc(SIZE * SIZE * 4);
+	DEFER(free(pixels));
+	for (int i=0; i<SIZE*SIZE*4; i++)
+		pixels[i] = i * 7;
+
+	GLuint tex;
+	glGenTextures(1, &tex);
+	DEFER(glDeleteTextures(1, &tex));
+	glBindTexture(GL_TEXTURE_2D, tex);
+
+	float upload(GLenum internalformat) {
+		uint32_t t0 = TICKS_READ();
+		for (int i=0; i<N; i++)
+			glTexImage2D(GL_TEXTURE_2D, 0, internalformat, SIZE, SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		uint32_t t1 = TICKS_READ();
+		return N / TICKS_TO_SECS(TICKS_DISTANCE(t0, t1));
+	}
+
+	PERF("rgba16", upload(GL_RGB5_A1), "upload/s");
+	PERF("ia16", upload(GL_LUMINANCE8_ALPHA8), "upload/s");
+	PERF("i4", upload(GL_INTENSITY4), "upload/s");
+
+	// Swapping bytes disables the fast paths (it has no effect on byte data)
+	glPixelStorei(GL_UNPACK_SWAP_BYTES, GL_TRUE);
+	PERF("rgba16_generic", upload(GL_RGB5_A1), "upload/s");
+	glPixelStorei(GL_UNPACK_SWAP_BYTES, GL_FALSE);
+}
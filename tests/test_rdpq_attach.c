@@ -56,3 +56,58 @@ void test_rdpq_attach_stack(TestContext *ctx)
         ASSERT_EQUAL_HEX(((uint16_t*)fbz.buffer)[i], 0xFFFC,
             "Invalid Z-buffer value at %d", i);
 }
+
+void test_rdpq_rt_pool(TestContext *ctx)
+{
+    RDPQ_INIT();
+    rdpq_rt_trim();
+    DEFER(rdpq_rt_trim());
+
+    const int WIDTH = 32;
+    const int SIZE = WIDTH * WIDTH * 2;
+    rdpq_rt_stats_t stats0 = rdpq_rt_get_stats();
+
+    surface_t *rt1 = rdpq_rt_acquire(FMT_RGBA16, WIDTH, WIDTH);
+    surface_t *rt2 = rdpq_rt_acquire(FMT_RGBA16, WIDTH, WIDTH);
+    ASSERT(rt1 != rt2, "The same render target was acquired twice");
+    ASSERT_EQUAL_SIGNED(surface_get_format(rt1), FMT_RGBA16, "Wrong render target format");
+    ASSERT_EQUAL_SIGNED(rt1->width, WIDTH, "Wrong render target width");
+
+    surface_clear(rt1, 0xAA);
+    rdpq_attach_clear(rt1, NULL);
+    rdpq_detach();
+    rdpq_rt_release(rt1);
+    rspq_wait();
+
+    ASSERT_EQUAL_HEX(((uint16_t*)rt1->buffer)[0], 0x0001, "Render target not drawn");
+
+    // A released render target is reused for the same format and size
+    surface_t *rt3 = rdpq_rt_acquire(FMT_RGBA16, WIDTH, WIDTH);
+    ASSERT(rt3 == rt1, "Released render target was not reused");
+
+    // A different format allocates a new one
+    surface_t *rt4 = rdpq_rt_acquire(FMT_RGBA32, WIDTH, WIDTH);
+    ASSERT(rt4 != rt1 && rt4 != rt2, "Render target reused with a different format");
+
+    rdpq_rt_stats_t stats = rdpq_rt_get_stats();
+    ASSERT_EQUAL_SIGNED(stats.num_surfaces - stats0.num_surfaces, 3, "Wrong number of surfaces");
+    ASSERT_EQUAL_SIGNED(stats.num_in_use - stats0.num_in_use, 3, "Wrong number of surfaces in use");
+    ASSERT_EQUAL_SIGNED(stats.memory_in_use - stats0.memory_in_use, SIZE * 4, "Wrong memory in use");
+    ASSERT(stats.peak_memory_in_use >= SIZE * 4, "Wrong peak memory in use");
+
+    rdpq_rt_release(rt2);
+    rdpq_rt_release(rt3);
+    rdpq_rt_release(rt4);
+    rspq_wait();
+
+    stats = rdpq_rt_get_stats();
+    ASSERT_EQUAL_SIGNED(stats.num_in_use, stats0.num_in_use, "Render targets not recycled");
+    ASSERT_EQUAL_SIGNED(stats.memory_in_use, stats0.memory_in_use, "Render targets not recycled");
+
+    // Trimming frees the unused render targets, but keeps the peak
+    rdpq_rt_trim();
+    stats = rdpq_rt_get_stats();
+    ASSERT_EQUAL_SIGNED(stats.num_surfaces, 0, "Render targets not freed");
+    ASSERT_EQUAL_SIGNED(stats.memory, 0, "Render targets not freed");
+    ASSERT(stats.peak_memory >= SIZE * 4, "Peak memory was reset");
+}
@@ -0,0 +1,109 @@
+#include "rdpq_occlusion.h"
+
+// Add a screen-space quad occluder (as two triangles) to an occlusion buffer
+static void occlusion_add_quad(rdpq_occlusion_t *occ, float x0, float y0, float x1, float y1, float z) {
+	float q[4][3] = { {x0,y0,z}, {x1,y0,z}, {x1,y1,z}, {x0,y1,z} };
+	rdpq_occlusion_add_triangle(occ, q[0], q[1], q[2]);
+	rdpq_occlusion_add_triangle(occ, q[0], q[2], q[3]);
+}
+
+void test_rdpq_occlusion_rect(TestContext *ctx) {
+	rdpq_occlusion_t *occ = rdpq_occlusion_alloc(64, 64);
+	DEFER(rdpq_occlusion_free(occ));
+
+	ASSERT(rdpq_occlusion_test_rect(occ, 16, 16, 48, 48, 0.9f), "empty buffer must not occlude");
+
+	// Cells along the diagonal are covered half by each triangle:
+	// they must be occluded as well.
+	occlusion_add_quad(occ, 8, 8, 56, 56, 0.5f);
+	ASSERT(!rdpq_occlusion_test_rect(occ, 16, 16, 48, 48, 0.7f), "rect behind the occluder not rejected");
+	ASSERT(!rdpq_occlusion_test_rect(occ, 8, 8, 55, 55, 0.7f), "rect exactly behind the occluder not rejected");
+	ASSERT(rdpq_occlusion_test_rect(occ, 16, 16, 48, 48, 0.3f), "rect in front of the occluder rejected");
+	ASSERT(rdpq_occlusion_test_rect(occ, 0, 16, 48, 48, 0.7f), "rect partially outside the occluder rejected");
+	ASSERT(rdpq_occlusion_test_rect(occ, 100, 100, 120, 120, 0.7f), "rect outside the buffer rejected");
+
+	// An occluder not aligned to the cells must not cover the cells it touches partially
+	rdpq_occlusion_clear(occ);
+	occlusion_add_quad(occ, 12, 12, 52, 52, 0.5f);
+	ASSERT(!rdpq_occlusion_test_rect(occ, 16, 16, 47, 47, 0.7f), "rect behind the occluder not rejected");
+	ASSERT(rdpq_occlusion_test_rect(occ, 8, 8, 47, 47, 0.7f), "partially covered cell treated as occluded");
+
+	// Sloped occluder: the test must use the farthest depth of each cell
+	rdpq_occlusion_clear(occ);
+	float s[4][3] = { {0,0,0.2f}, {64,0,0.8f}, {64,64,0.8f}, {0,64,0.2f} };
+	rdpq_occlusion_add_triangle(occ, s[0], s[1], s[2]);
+	rdpq_occlusion_add_triangle(occ, s[0], s[2], s[3]);
+	ASSERT(!rdpq_occlusion_test_rect(occ, 0, 0, 15, 63, 0.4f), "rect behind the sloped occluder not rejected");
+	ASSERT(rdpq_occlusion_test_rect(occ, 0, 0, 31, 63, 0.4f), "rect intersecting the sloped occluder rejected");
+}
+
+void test_rdpq_occlusion_box(TestContext *ctx) {
+	rdpq_occlusion_t *occ = rdpq_occlusion_alloc(64, 64);
+	DEFER(rdpq_occlusion_free(occ));
+
+	fm_mat4_t mvp;
+	fm_mat4_identity(&mvp);
+
+	// Occluder mesh at Z=0 in clip space (depth 0.5), covering most of the buffer
+	fm_vec3_t verts[4] = { {{-0.75f,-0.75f,0}}, {{0.75f,-0.75f,0}}, {{0.75f,0.75f,0}}, {{-0.75f,0.75f,0}} };
+	uint16_t indices[6] = { 0,1,2, 0,2,3 };
+	rdpq_occlusion_add_mesh(occ, &mvp, verts, indices, 6);
+
+	fm_vec3_t bmin = {{-0.5f,-0.5f,0.2f}}, bmax = {{0.5f,0.5f,0.6f}};
+	ASSERT(!rdpq_occlusion_test_box(occ, &mvp, &bmin, &bmax), "box behind the occluder not rejected");
+	bmin.z = -0.2f;
+	ASSERT(rdpq_occlusion_test_box(occ, &mvp, &bmin, &bmax), "box crossing the occluder rejected");
+	bmin = (fm_vec3_t){{-1.0f,-0.5f,0.2f}};
+	ASSERT(rdpq_occlusion_test_box(occ, &mvp, &bmin, &bmax), "box partially outside the occluder rejected");
+
+	rdpq_occlusion_stats_t stats = rdpq_occlusion_get_stats(occ);
+	ASSERT_EQUAL_SIGNED(stats.objects_tested, 3, "wrong number of tested objects");
+	ASSERT_EQUAL_SIGNED(stats.objects_rejected, 1, "wrong number of rejected objects");
+	ASSERT_EQUAL_SIGNED(stats.pixels_saved, 32*32, "wrong estimate of saved pixels");
+
+	rdpq_occlusion_clear(occ);
+	stats = rdpq_occlusion_get_stats(occ);
+	ASSERT_EQUAL_SIGNED(stats.objects_tested, 0, "statistics not reset");
+}
+
+void test_rdpq_occlusion_triangle(TestContext *ctx) {
+	RDPQ_INIT();
+
+	const int FBWIDTH = 64;
+	surface_t fb = surface_alloc(FMT_RGBA16, FBWIDTH, FBWIDTH);
+	DEFER(surface_free(&fb));
+	surface_clear(&fb, 0);
+
+	rdpq_occlusion_t *occ = rdpq_occlusion_alloc(FBWIDTH, FBWIDTH);
+	DEFER(rdpq_occlusion_free(occ));
+	occlusion_add_quad(occ, 0, 0, 32, 64, 0.5f);
+
+	rdpq_attach(&fb, NULL);
+	rdpq_set_mode_standard();
+	rdpq_mode_combiner(RDPQ_COMBINER_FLAT);
+	rdpq_set_prim_color(RGBA32(255,255,255,255));
+
+	// Hidden behind the occluder
+	bool drawn = rdpq_occlusion_triangle(occ, &TRIFMT_ZBUF,
+		(float[]){ 4, 4, 0.8f }, (float[]){ 28, 4, 0.8f }, (float[]){ 4, 28, 0.8f });
+	ASSERT(!drawn, "hidden triangle was drawn");
+	// In front of the occluder
+	drawn = rdpq_occlusion_triangle(occ, &TRIFMT_ZBUF,
+		(float[]){ 4, 36, 0.2f }, (float[]){ 28, 36, 0.2f }, (float[]){ 4, 60, 0.2f });
+	ASSERT(drawn, "visible triangle was not drawn");
+	// Not covered by the occluder
+	drawn = rdpq_occlusion_triangle(occ, &TRIFMT_ZBUF,
+		(float[]){ 36, 4, 0.8f }, (float[]){ 60, 4, 0.8f }, (float[]){ 36, 28, 0.8f });
+	ASSERT(drawn, "visible triangle was not drawn");
+	rdpq_detach_wait();
+
+	uint16_t *pixels = fb.buffer;
+	ASSERT_EQUAL_HEX(pixels[8 * FBWIDTH + 8], 0, "hidden triangle reached the framebuffer");
+	ASSERT_EQUAL_HEX(pixels[40 * FBWIDTH + 8], 0xFFFF, "visible triangle not drawn");
+	ASSERT_EQUAL_HEX(pixels[8 * FBWIDTH + 40], 0xFFFF, "visible triangle not drawn");
+
+	rdpq_occlusion_stats_t stats = rdpq_occlusion_get_stats(occ);
+	ASSERT_EQUAL_SIGNED(stats.tris_tested, 3, "wrong number of tested triangles");
+	ASSERT_EQUAL_SIGNED(stats.tris_rejected, 1, "wrong number of rejected triangles");
+	ASSERT_EQUAL_SIGNED(stats.pixels_saved, 24*24/2, "wrong estimate of saved pixels");
+}
@@ -77,3 +77,138 @@ void test_rdpq_sprite_lod(TestContext *ctx)
         return color_from_packed32(0);
     });
 }
+
+void test_rdpq_sprite_atlas(TestContext *ctx)
+{
+    RDPQ_INIT();
+
+    // Load an atlas sheet made of two images (converted to RGBA16), and the
+    // same images as standalone sprites for comparison.
+    sprite_t *atlas = sprite_load("rom:/grass_atlas.sprite");
+    DEFER(sprite_free(atlas));
+    sprite_t *s1 = sprite_load("rom:/grass1.rgba32.sprite");
+    DEFER(sprite_free(s1));
+    sprite_t *s2 = sprite_load("rom:/grass2.rgba32.sprite");
+    DEFER(sprite_free(s2));
+
+    ASSERT_EQUAL_SIGNED(sprite_get_atlas_count(atlas), 2, "invalid number of atlas images");
+    ASSERT_EQUAL_SIGNED(sprite_get_atlas_count(s1), 0, "standalone sprite reported as atlas");
+    int idx1 = sprite_get_atlas_index(atlas, "grass1.rgba32");
+    int idx2 = sprite_get_atlas_index(atlas, "grass2.rgba32");
+    ASSERT_EQUAL_SIGNED(idx1, 0, "invalid index for grass1");
+    ASSERT_EQUAL_SIGNED(idx2, 1, "invalid index for grass2");
+    ASSERT_EQUAL_SIGNED(sprite_get_atlas_index(atlas, "grass3"), -1, "unexpected image found");
+
+    // Check that the pixels of each sub-image match the standalone sprites
+    sprite_t *sprites[2] = { s1, s2 };
+    int idxs[2] = { idx1, idx2 };
+    for (int i=0; i<2; i++) {
+        surface_t ssurf = sprite_get_pixels(sprites[i]);
+        surface_t tile = sprite_get_atlas_tile(atlas, idxs[i]);
+        ASSERT_EQUAL_SIGNED(tile.width, ssurf.width, "invalid width of atlas image %d", i);
+        ASSERT_EQUAL_SIGNED(tile.height, ssurf.height, "invalid height of atlas image %d", i);
+        for (int y=0; y<tile.height; y++) {
+            for (int x=0; x<tile.width; x++) {
+                color_t c16 = color_from_packed16(((uint16_t*)(tile.buffer + y*tile.stride))[x]);
+                color_t c32 = color_from_packed32(((uint32_t*)(ssurf.buffer + y*ssurf.stride))[x]);
+                ASSERT_EQUAL_HEX(color_to_packed16(c16), color_to_packed16(c32),
+                    "atlas image %d differs at (%d,%d)", i, x, y);
+            }
+        }
+    }
+
+    // Upload the sheet once, and draw the second image using the atlas coordinates
+    int x2, y2, w2, h2;
+    ASSERT(sprite_get_atlas_rect(atlas, idx2, &x2, &y2, &w2, &h2), "atlas rect not found");
+    surface_t t2 = sprite_get_atlas_tile(atlas, idx2);
+
+    surface_t fb = surface_alloc(FMT_RGBA16, w2, h2);
+    DEFER(surface_free(&fb));
+    surface_clear(&fb, 0);
+
+    rdpq_attach(&fb, NULL);
+    rdpq_set_mode_copy(false);
+    rdpq_sprite_upload(TILE0, atlas, NULL);
+    rdpq_texture_rectangle(TILE0, 0, 0, w2, h2, x2, y2);
+    rdpq_detach_wait();
+
+    ASSERT_SURFACE(&fb, {
+        return color_from_packed16(((uint16_t*)(t2.buffer + y*t2.stride))[x]);
+    });
+}
+
+void test_rdpq_sprite_blockcomp(TestContext *ctx)
+{
+    RDPQ_INIT();
+
+    // The test image has at most two colors (plus transparency) in each 4x4 block,
+    // so block compression is lossless on it. It is 30x18, so that the last
+    // row and column of blocks are only partially used.
+    sprite_t *s = sprite_load("rom:/blockcomp.rgba16.sprite");
+    DEFER(sprite_free(s));
+    ASSERT(s->flags & SPRITE_FLAGS_BLOCKCOMP, "sprite is not block-compressed");
+    ASSERT_EQUAL_SIGNED(sprite_get_format(s), FMT_RGBA16, "invalid sprite format");
+
+    surface_t surf = sprite_get_pixels(s);
+    ASSERT(surf.flags & SURFACE_FLAGS_BLOCKCOMP, "surface is not block-compressed");
+    ASSERT_EQUAL_SIGNED(surf.stride, 8*8, "invalid stride of compressed surface");
+
+    // Must match the generator of assets/blockcomp.rgba16.png
+    color_t expected(int x, int y) {
+        int bx = x/4, by = y/4;
+        if ((bx+by)%2 == 0 && x%4 == 3 && y%4 == 3)
+            return RGBA32(0,0,0,0);
+        if ((x+y)&1)
+            return RGBA32((bx*40)&0xF8, (by*56)&0xF8, 0x80, 0xFF);
+        return RGBA32(0xF8-((bx*24)&0xF8), 0x40, (by*72)&0xF8, 0xFF);
+    }
+
+    surface_t fb = surface_alloc(FMT_RGBA16, s->width, s->height);
+    DEFER(surface_free(&fb));
+
+    // Upload the full texture
+    surface_clear(&fb, 0);
+    rdpq_attach(&fb, NULL);
+    rdpq_set_mode_copy(false);
+    rdpq_sprite_upload(TILE0, s, NULL);
+    rdpq_texture_rectangle(TILE0, 0, 0, s->width, s->height, 0, 0);
+    rdpq_detach_wait();
+    ASSERT_SURFACE(&fb, { return expected(x, y); });
+
+    // Upload a portion not aligned to the blocks
+    surface_clear(&fb, 0);
+    rdpq_attach(&fb, NULL);
+    rdpq_set_mode_copy(false);
+    rdpq_tex_upload_sub(TILE0, &surf, NULL, 6, 5, 22, 15);
+    rdpq_texture_rectangle(TILE0, 6, 5, 22, 15, 6, 5);
+    rdpq_detach_wait();
+    ASSERT_SURFACE(&fb, {
+        if (x >= 6 && x < 22 && y >= 5 && y < 15)
+            return expected(x, y);
+        return RGBA32(0,0,0,0);
+    });
+
+    // Blit goes through the large texture loader
+    surface_clear(&fb, 0);
+    rdpq_attach(&fb, NULL);
+    rdpq_set_mode_copy(false);
+    rdpq_sprite_blit(s, 0, 0, NULL);
+    rdpq_detach_wait();
+    ASSERT_SURFACE(&fb, { return expected(x, y); });
+
+    // The upload can be recorded in a block, which keeps the decoded lines
+    // and can be run more than once
+    rspq_block_begin();
+    rdpq_sprite_upload(TILE0, s, NULL);
+    rspq_block_t *block = rspq_block_end();
+    DEFER(rspq_block_free(block));
+    for (int i = 0; i < 2; i++) {
+        surface_clear(&fb, 0);
+        rdpq_attach(&fb, NULL);
+        rdpq_set_mode_copy(false);
+        rspq_block_run(block);
+        rdpq_texture_rectangle(TILE0, 0, 0, s->width, s->height, 0, 0);
+        rdpq_detach_wait();
+        ASSERT_SURFACE(&fb, { return expected(x, y); });
+    }
+}
@@ -0,0 +1,150 @@
+#include <rsp_compute.h>
+
+#define TEST_RSP_COMPUTE_PROLOG() \
+	rspq_init(); \
+	rsp_compute_init(); \
+	DEFER(rsp_compute_close(); rspq_close());
+
+void test_rsp_compute_memops(TestContext *ctx) {
+	TEST_RSP_COMPUTE_PROLOG();
+
+	enum { MAXSIZE = 4096, GUARD = 64 };
+	uint8_t *src = memalign(16, MAXSIZE);
+	DEFER(free(src));
+	uint8_t *dst = memalign(16, MAXSIZE + GUARD);
+	DEFER(free(dst));
+	for (int i=0; i<MAXSIZE; i++)
+		src[i] = i * 7 + 3;
+
+	// Sizes smaller, equal and not multiple of the chunk size
+	const int sizes[] = { 16, 240, COMPUTE_CHUNK_SIZE, COMPUTE_CHUNK_SIZE+16, COMPUTE_CHUNK_SIZE*3, 4000, MAXSIZE };
+	for (int s=0; s<sizeof(sizes)/sizeof(sizes[0]); s++) {
+		int size = sizes[s];
+
+		memset(dst, 0xAA, MAXSIZE + GUARD);
+		rsp_compute_memcpy(dst, src, size);
+		rsp_compute_fence_wait(rsp_compute_fence());
+		ASSERT_EQUAL_MEM(dst, src, size, "memcpy mismatch (size %d)", size);
+		for (int i=size; i<size+GUARD; i++)
+			ASSERT_EQUAL_HEX(dst[i], 0xAA, "memcpy overflow at %d (size %d)", i, size);
+
+		memset(dst, 0xAA, MAXSIZE + GUARD);
+		rsp_compute_memset(dst, 0x12345678, size);
+		rsp_compute_fence_wait(rsp_compute_fence());
+		for (int i=0; i<size; i+=4)
+			ASSERT_EQUAL_HEX(*(uint32_t*)(dst+i), 0x12345678, "memset mismatch at %d (size %d)", i, size);
+		for (int i=size; i<size+GUARD; i++)
+			ASSERT_EQUAL_HEX(dst[i], 0xAA, "memset overflow at %d (size %d)", i, size);
+	}
+}
+
+void test_rsp_compute_saxpy(TestContext *ctx) {
+	TEST_RSP_COMPUTE_PROLOG();
+
+	enum { N = 1000 };
+	int16_t *x = memalign(16, N * sizeof(int16_t));
+	DEFER(free(x));
+	int16_t *y = memalign(16, N * sizeof(int16_t));
+	DEFER(free(y));
+	int16_t *out = memalign(16, N * sizeof(int16_t));
+	DEFER(free(out));
+
+	for (int i=0; i<N; i++) {
+		x[i] = (i * 1237) - 20000;
+		y[i] = 15000 - i * 31;
+	}
+
+	const float factors[] = { 1.0f, 0.5f, -2.25f, 3.0f };
+	for (int f=0; f<sizeof(factors)/sizeof(factors[0]); f++) {
+		rsp_compute_saxpy(out, factors[f], x, y, N);
+		rsp_compute_fence_wait(rsp_compute_fence());
+
+		int32_t fa = factors[f] * 65536.0f;
+		for (int i=0; i<N; i++) {
+			int32_t exp = (int32_t)(((int64_t)x[i] * fa) >> 16) + y[i];
+			if (exp > 32767) exp = 32767;
+			if (exp < -32768) exp = -32768;
+			ASSERT_EQUAL_SIGNED(out[i], exp, "saxpy mismatch at %d (a=%f)", i, factors[f]);
+		}
+	}
+}
+
+void test_rsp_compute_transform(TestContext *ctx) {
+	TEST_RSP_COMPUTE_PROLOG();
+
+	enum { N = 101, NSLOTS = (N+1)/2 };
+	fm_vec3_t *in = malloc(N * sizeof(fm_vec3_t));
+	DEFER(free(in));
+	fm_vec4_t *out = malloc(N * sizeof(fm_vec4_t));
+	DEFER(free(out));
+	rsp_compute_vec4x2_t *slots = memalign(16, NSLOTS * sizeof(rsp_compute_vec4x2_t));
+	DEFER(free(slots));
+
+	for (int i=0; i<N; i++)
+		in[i] = (fm_vec3_t){{ i * 0.75f - 30.0f, 10.0f - i * 0.125f, i * 0.5f }};
+
+	fm_mat4_t m;
+	fm_quat_t q;
+	fm_quat_from_axis_angle(&q, &(fm_vec3_t){{ 0, 0.6f, 0.8f }}, 1.1f);
+	fm_mat4_from_srt(&m, &(fm_vec3_t){{ 2, 0.5f, 1 }}, &q, &(fm_vec3_t){{ 5, -7, 12.5f }});
+	fm_mat4_fixed_t *mfx = memalign(16, sizeof(fm_mat4_fixed_t));
+	DEFER(free(mfx));
+	fm_mat4_to_fixed(mfx, &m);
+
+	rsp_compute_pack_vec3(slots, in, N);
+	rsp_compute_transform(slots, mfx, slots, NSLOTS);
+	rsp_compute_fence_wait(rsp_compute_fence());
+	rsp_compute_unpack_vec4(out, slots, N);
+
+	for (int i=0; i<N; i++) {
+		fm_vec4_t exp;
+		fm_mat4_mul_vec3(&exp, &m, &in[i]);
+		for (int j=0; j<4; j++)
+			ASSERT_NEAR(out[i].v[j], exp.v[j], 1e-2f, "(vertex %d, component %d)", i, j);
+	}
+}
+
+void test_rsp_compute_benchmark(TestContext *ctx) {
+	TEST_RSP_COMPUTE_PROLOG();
+
+	enum { SIZE = 64*1024, NVTX = 1024 };
+	uint8_t *src = memalign(16, SIZE);
+	DEFER(free(src));
+	uint8_t *dst = memalign(16, SIZE);
+	DEFER(free(dst));
+	memset(src, 0x5A, SIZE);
+
+	uint32_t t0 = TICKS_READ();
+	memcpy(dst, src, SIZE);
+	uint32_t t1 = TICKS_READ();
+	rsp_compute_memcpy(dst, src, SIZE);
+	rsp_compute_fence_wait(rsp_compute_fence());
+	uint32_t t2 = TICKS_READ();
+	LOG("memcpy %d bytes: cpu=%ld rsp=%ld ticks\n", SIZE,
+		TICKS_DISTANCE(t0, t1), TICKS_DISTANCE(t1, t2));
+
+	fm_vec3_t *in = malloc(NVTX * sizeof(fm_vec3_t));
+	DEFER(free(in));
+	fm_vec4_t *out = malloc(NVTX * sizeof(fm_vec4_t));
+	DEFER(free(out));
+	rsp_compute_vec4x2_t *slots = memalign(16, NVTX/2 * sizeof(rsp_compute_vec4x2_t));
+	DEFER(free(slots));
+	for (int i=0; i<NVTX; i++)
+		in[i] = (fm_vec3_t){{ i * 0.01f, 1.0f, -i * 0.01f }};
+	rsp_compute_pack_vec3(slots, in, NVTX);
+
+	fm_mat4_t m;
+	fm_mat4_from_srt(&m, NULL, NULL, &(fm_vec3_t){{ 1, 2, 3 }});
+	fm_mat4_fixed_t *mfx = memalign(16, sizeof(fm_mat4_fixed_t));
+	DEFER(free(mfx));
+	fm_mat4_to_fixed(mfx, &m);
+
+	t0 = TICKS_READ();
+	fm_mat4_transform_vec3(&m, in, 0, out, 0, NVTX);
+	t1 = TICKS_READ();
+	rsp_compute_transform(slots, mfx, slots, NVTX/2);
+	rsp_compute_fence_wait(rsp_compute_fence());
+	t2 = TICKS_READ();
+	LOG("transform %d vertices: cpu=%ld rsp=%ld ticks\n", NVTX,
+		TICKS_DISTANCE(t0, t1), TICKS_DISTANCE(t1, t2));
+}
@@ -0,0 +1,72 @@
+void test_uncached_pool(TestContext *ctx) {
+	uncached_pool_t *pool = uncached_pool_new();
+	DEFER(uncached_pool_free(pool));
+
+	// Small buffers: uncached, aligned, not overlapping
+	uint8_t *buf1 = uncached_pool_alloc(pool, 10);
+	uint8_t *buf2 = uncached_pool_alloc(pool, 10);
+	uint8_t *buf3 = uncached_pool_alloc(pool, 100);
+	ASSERT(buf1 && buf2 && buf3, "allocation failed");
+	ASSERT_EQUAL_HEX((uint32_t)buf1 & 0xF0000000, 0xA0000000, "buffer not uncached");
+	ASSERT_EQUAL_HEX((uint32_t)buf1 & 15, 0, "small buffer not 16-byte aligned");
+	ASSERT_EQUAL_HEX((uint32_t)buf3 & 63, 0, "buffer not 64-byte aligned");
+	ASSERT(buf2 >= buf1+16 || buf1 >= buf2+16, "overlapping buffers");
+	memset(buf1, 0x11, 10); memset(buf2, 0x22, 10); memset(buf3, 0x33, 100);
+	ASSERT_EQUAL_HEX(buf1[9], 0x11, "buffer corrupted");
+
+	uncached_pool_stats_t stats;
+	uncached_pool_get_stats(pool, &stats);
+	ASSERT_EQUAL_SIGNED(stats.num_allocs, 3, "invalid number of allocations");
+	ASSERT_EQUAL_SIGNED(stats.num_slabs, 2, "invalid number of slabs");
+	ASSERT_EQUAL_UNSIGNED(stats.used_bytes, 16+16+128, "invalid used bytes");
+
+	// Released buffers are reused immediately
+	uncached_pool_release(pool, buf2);
+	uint8_t *buf2b = uncached_pool_alloc(pool, 16);
+	ASSERT(buf2b == buf2, "released buffer not reused (%p != %p)", buf2b, buf2);
+
+	// Aligned and large allocations
+	uint8_t *buf4 = uncached_pool_alloc_aligned(pool, 64, 8);
+	ASSERT_EQUAL_HEX((uint32_t)buf4 & 63, 0, "aligned buffer not 64-byte aligned");
+	uint8_t *big = uncached_pool_alloc_aligned(pool, 256, 10000);
+	ASSERT(big, "large allocation failed");
+	ASSERT_EQUAL_HEX((uint32_t)big & 255, 0, "large buffer not aligned");
+	ASSERT_EQUAL_HEX((uint32_t)big & 0xF0000000, 0xA0000000, "large buffer not uncached");
+	memset(big, 0x44, 10000);
+
+	// Fill more than a slab of a single class
+	int n = UNCACHED_POOL_SLAB_SIZE / 32 + 4;
+	for (int i=0; i<n; i++)
+		ASSERT(uncached_pool_alloc(pool, 32), "allocation %d failed", i);
+
+	uncached_pool_get_stats(pool, &stats);
+	ASSERT_EQUAL_SIGNED(stats.num_slabs, 5, "invalid number of slabs");
+	ASSERT(stats.large_bytes >= 10000, "large allocation not accounted");
+	size_t peak = stats.peak_bytes;
+
+	// Reset keeps the slabs and carves them again from the start
+	uncached_pool_reset(pool);
+	uncached_pool_get_stats(pool, &stats);
+	ASSERT_EQUAL_SIGNED(stats.num_allocs, 0, "allocations left after reset");
+	ASSERT_EQUAL_UNSIGNED(stats.large_bytes, 0, "large allocations left after reset");
+	ASSERT_EQUAL_SIGNED(stats.num_slabs, 5, "slabs not kept after reset");
+	ASSERT_EQUAL_UNSIGNED(stats.peak_bytes, peak, "peak changed after reset");
+	uint8_t *buf1b = uncached_pool_alloc(pool, 10);
+	ASSERT(buf1b == buf1, "slab not reused after reset (%p != %p)", buf1b, buf1);
+
+	// Default pool: malloc_uncached is routed through it, and free_uncached
+	// handles both pool buffers and heap buffers.
+	void *heap = malloc_uncached(64);
+	uncached_pool_set_default(pool);
+	void *p1 = malloc_uncached(64);
+	void *p2 = malloc_uncached_aligned(64, 8192);
+	uncached_pool_set_default(NULL);
+
+	uncached_pool_get_stats(pool, &stats);
+	ASSERT_EQUAL_SIGNED(stats.num_allocs, 3, "default pool not used");
+	free_uncached(p1);
+	free_uncached(p2);
+	free_uncached(heap);
+	uncached_pool_get_stats(pool, &stats);
+	ASSERT_EQUAL_SIGNED(stats.num_allocs, 1, "free_uncached did not release to the pool");
+}
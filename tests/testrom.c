@@ -8,6 +8,12 @@
 #define IN_EMULATOR  0
 #endif
 
+// Activate this to run only the performance tests (TEST_FLAGS_PERF), and
+// emit their results as JSON on the debug channel at the end of the run.
+#ifndef BENCHMARK_MODE
+#define BENCHMARK_MODE  0
+#endif
+
 /**********************************************************************
  * SIMPLE TEST FRAMEWORK
  **********************************************************************/
@@ -56,6 +62,35 @@ typedef void (*TestFunc)(TestContext *ctx);
 	return; \
 })
 
+// PERF(metric, value, unit): record a performance metric of the current test
+// (higher is better). Metrics are logged, and in benchmark mode they are also
+// emitted as JSON at the end of the run, to be compared with tests/benchcompare.py.
+#define PERF(metric, value, unit)  ({ \
+	float __v = (value); \
+	perf_record(metric, __v, unit); \
+	LOG("%s: %.3f %s\n", metric, __v, unit); \
+})
+
+// TICKS_TO_SECS(t): convert a number of ticks into seconds (as float)
+#define TICKS_TO_SECS(t)  ((float)(t) / (float)TICKS_PER_SECOND)
+
+typedef struct {
+	const char *test;
+	const char *metric;
+	const char *unit;
+	float value;
+} PerfResult;
+
+static PerfResult perf_results[128];
+static int perf_count = 0;
+static const char *perf_cur_test = NULL;
+
+static void perf_record(const char *metric, float value, const char *unit) {
+	if (perf_count == sizeof(perf_results) / sizeof(perf_results[0]))
+		return;
+	perf_results[perf_count++] = (PerfResult){ perf_cur_test, metric, unit, value };
+}
+
 // Fair and fast random generation (using xorshift32, with explicit seed)
 static uint32_t rand_state = 1;
 static uint32_t rand(void) {
@@ -202,18 +237,26 @@ int assert_equal_mem(TestContext *ctx, const char *file, int line, const uint8_t
 #include "test_exception.c"
 #include "test_debug.c"
 #include "test_dma.c"
+#include "test_uncached_pool.c"
+#include "test_arena.c"
 #include "test_cop1.c"
+#include "test_fgeom.c"
 #include "test_constructors.c"
 #include "test_backtrace.c"
 #include "test_rspq.c"
+#include "test_rsp_compute.c"
+#include "test_bulk.c"
 #include "test_rdpq.c"
 #include "test_rdpq_tri.c"
 #include "test_rdpq_tex.c"
 #include "test_rdpq_attach.c"
 #include "test_rdpq_sprite.c"
+#include "test_rdpq_occlusion.c"
+#include "test_console.c"
 #include "test_mpeg1.c"
 #include "test_gl.c"
 #include "test_dl.c"
+#include "test_perf.c"
 
 /**********************************************************************
  * MAIN
@@ -225,6 +268,7 @@ int assert_equal_mem(TestContext *ctx, const char *file, int line, const uint8_t
 #define TEST_FLAGS_NO_BENCHMARK  0x2  // Test is too variable, do not attempt to benchmark it
 #define TEST_FLAGS_RESET_COUNT   0x4  // Test resets the hardware count register
 #define TEST_FLAGS_NO_EMULATOR   0x8  // Test does not work under emulators
+#define TEST_FLAGS_PERF          0x10 // Performance test: only run in benchmark mode
 
 #define TEST_FUNC(fn, dur, flags)   { #fn, fn, dur, flags }
 static const struct Testsuite
@@ -254,7 +298,15 @@ static const struct Testsuite
 	TEST_FUNC(test_cache_invalidate,        1763, TEST_FLAGS_NONE),
 	TEST_FUNC(test_debug_sdfs,                 0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_dma_read_misalign,       7003, TEST_FLAGS_NONE),
+	TEST_FUNC(test_dma_queue,                  0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_dma_queue_sync,             0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_uncached_pool,              0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_arena,                      0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_arena_loaders,              0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_cop1_denormalized_float,    0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_fgeom_rsqrt,                0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_fgeom_mat4,                 0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_fgeom_benchmark,            0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_backtrace_analyze,          0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_backtrace_basic,            0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_backtrace_fp,               0, TEST_FLAGS_NO_BENCHMARK),
@@ -284,6 +336,12 @@ static const struct Testsuite
 	TEST_FUNC(test_rspq_rdp_dynamic,           0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rspq_rdp_dynamic_switch,    0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rspq_deferred_call,         0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_rsp_compute_memops,         0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_rsp_compute_saxpy,          0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_rsp_compute_transform,      0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_rsp_compute_benchmark,      0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_bulk,                       0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_bulk_benchmark,             0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rdpq_rspqwait,              0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rdpq_clear,                 0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rdpq_dynamic,               0, TEST_FLAGS_NO_BENCHMARK),
@@ -318,12 +376,19 @@ static const struct Testsuite
 	TEST_FUNC(test_rdpq_triangle_w1,           0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rdpq_attach_clear,             0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rdpq_attach_stack,             0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_rdpq_rt_pool,                  0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rdpq_tex_upload,            0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rdpq_tex_upload_multi,      0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rdpq_tex_blit_normal,       0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rdpq_tex_multi_i4,          0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rdpq_sprite_upload,         0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_rdpq_sprite_lod,            0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_rdpq_sprite_atlas,          0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_rdpq_sprite_blockcomp,      0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_rdpq_occlusion_rect,        0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_rdpq_occlusion_box,         0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_rdpq_occlusion_triangle,    0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_console_overlay,            0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_mpeg1_idct,                 0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_mpeg1_block_decode,         0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_mpeg1_block_dequant,        0, TEST_FLAGS_NO_BENCHMARK),
@@ -334,6 +399,13 @@ static const struct Testsuite
 	TEST_FUNC(test_gl_texture_completeness,    0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_gl_list,					   0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_gl_cull,					   0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_gl_draw_queue,              0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_gl_texture_residency,       0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_gl_secondary_texture,       0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_gl_tex_image_fast_paths,    0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_gl_preconverted_buffer,     0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_gl_draw_instanced,          0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_gl_guard_band,              0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_dl_syms,                   0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_dladdr,             0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_dl_relocs,             0, TEST_FLAGS_NO_BENCHMARK),
@@ -341,6 +413,16 @@ static const struct Testsuite
 	TEST_FUNC(test_dlsym_rtld_default,           0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_dlclose,           0, TEST_FLAGS_NO_BENCHMARK),
 	TEST_FUNC(test_dl_ctors,           0, TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_perf_rspq_commands,         0, TEST_FLAGS_PERF | TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_perf_rdpq_rects,            0, TEST_FLAGS_PERF | TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_perf_rdpq_triangles,        0, TEST_FLAGS_PERF | TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_perf_dfs_read,              0, TEST_FLAGS_PERF | TEST_FLAGS_NO_BENCHMARK | TEST_FLAGS_IO),
+	TEST_FUNC(test_perf_decompress,            0, TEST_FLAGS_PERF | TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_perf_mixer,                 0, TEST_FLAGS_PERF | TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_perf_gl_vertices,           0, TEST_FLAGS_PERF | TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_perf_gl_teximage,           0, TEST_FLAGS_PERF | TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_perf_gl_vbo,                0, TEST_FLAGS_PERF | TEST_FLAGS_NO_BENCHMARK),
+	TEST_FUNC(test_perf_gl_clipping,           0, TEST_FLAGS_PERF | TEST_FLAGS_NO_BENCHMARK),
 };
 
 int main() {
@@ -364,6 +446,12 @@ int main() {
 	for (int i=0; i < NUM_TESTS; i++) {
 		static char logbuf[16384], errbuf[4096];
 
+		// Performance tests are run only in benchmark mode, and vice versa.
+		if (BENCHMARK_MODE != !!(tests[i].flags & TEST_FLAGS_PERF)) {
+			skipped++;
+			continue;
+		}
+
 		printf("%-59s", tests[i].name);
 		fflush(stdout);
 		debugf("**** Starting test: %s\n", tests[i].name);
@@ -393,6 +481,7 @@ int main() {
 		uint32_t test_start = TICKS_READ();
 
 		// Run the test!
+		perf_cur_test = tests[i].name;
 		tests[i].fn(&ctx);
 
 		// Compute the test duration
@@ -453,4 +542,19 @@ int main() {
 	console_set_debug(true);
 	printf("\nTestsuite finished in %02lld:%02lld\n", total_time/60, total_time%60);
 	printf("Passed: %d out of %d (%d skipped)\n", successes, NUM_TESTS, skipped);
+
+	if (BENCHMARK_MODE) {
+		// Emit the results between markers, so that tests/benchcompare.py
+		// can extract them from the emulator log.
+		debugf("@@@ BENCHMARK BEGIN\n");
+		debugf("{\"suite\": \"testrom\", \"emulator\": %s, \"bbplayer\": %s, \"failures\": %d, \"results\": [\n",
+			IN_EMULATOR ? "true" : "false", sys_bbplayer() ? "true" : "false", failures);
+		for (int i=0; i<perf_count; i++) {
+			debugf("  {\"test\": \"%s\", \"metric\": \"%s\", \"value\": %.3f, \"unit\": \"%s\"}%s\n",
+				perf_results[i].test, perf_results[i].metric, perf_results[i].value,
+				perf_results[i].unit, i < perf_count-1 ? "," : "");
+		}
+		debugf("]}\n");
+		debugf("@@@ BENCHMARK END\n");
+	}
 }
@@ -0,0 +1,198 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "batch.h"
+
+static pthread_mutex_t batch_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+uint64_t batch_hash_buf(uint64_t h, const void *buf, int size)
+{
+    const uint8_t *p = buf;
+    for (int i=0; i<size; i++) {
+        h ^= p[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+uint64_t batch_hash_str(uint64_t h, const char *s)
+{
+    // Include the terminator, so that ("ab","c") and ("a","bc") hash differently
+    return batch_hash_buf(h, s ? s : "", s ? strlen(s)+1 : 1);
+}
+
+uint64_t batch_hash_file(uint64_t h, const char *fn, bool *ok)
+{
+    FILE *f = fopen(fn, "rb");
+    if (!f) {
+        if (ok) *ok = false;
+        return h;
+    }
+    uint8_t buf[16384]; int n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        h = batch_hash_buf(h, buf, n);
+    fclose(f);
+    if (ok) *ok = true;
+    return h;
+}
+
+void batch_cache_load(batch_cache_t *cache, const char *fn)
+{
+    memset(cache, 0, sizeof(*cache));
+    cache->fn = strdup(fn);
+
+    FILE *f = fopen(fn, "r");
+    if (!f) return;
+    char *line = NULL; size_t linesz = 0;
+    while (getline(&line, &linesz, f) > 0) {
+        unsigned long long hash; int pos;
+        if (sscanf(line, "%16llx %n", &hash, &pos) != 1)
+            continue;
+        char *outfn = line + pos;
+        outfn[strcspn(outfn, "\r\n")] = 0;
+        batch_cache_update(cache, outfn, hash);
+    }
+    free(line);
+    fclose(f);
+    cache->dirty = false;
+}
+
+bool batch_cache_check(batch_cache_t *cache, const char *outfn, uint64_t hash)
+{
+    bool uptodate = false;
+    batch_lock();
+    for (int i=0; i<cache->num; i++) {
+        if (!strcmp(cache->entries[i].outfn, outfn)) {
+            uptodate = cache->entries[i].hash == hash;
+            break;
+        }
+    }
+    batch_unlock();
+
+    // The output must also still exist
+    struct stat st;
+    return uptodate && stat(outfn, &st) == 0;
+}
+
+void batch_cache_update(batch_cache_t *cache, const char *outfn, uint64_t hash)
+{
+    batch_lock();
+    cache->dirty = true;
+    for (int i=0; i<cache->num; i++) {
+        if (!strcmp(cache->entries[i].outfn, outfn)) {
+            cache->entries[i].hash = hash;
+            batch_unlock();
+            return;
+        }
+    }
+    cache->entries = realloc(cache->entries, (cache->num+1) * sizeof(cache->entries[0]));
+    cache->entries[cache->num].outfn = strdup(outfn);
+    cache->entries[cache->num].hash = hash;
+    cache->num++;
+    batch_unlock();
+}
+
+bool batch_cache_save(batch_cache_t *cache)
+{
+    if (!cache->dirty) return true;
+    FILE *f = fopen(cache->fn, "w");
+    if (!f) {
+        fprintf(stderr, "error writing cache file: %s\n", cache->fn);
+        return false;
+    }
+    for (int i=0; i<cache->num; i++)
+        fprintf(f, "%016llx %s\n", (unsigned long long)cache->entries[i].hash, cache->entries[i].outfn);
+    fclose(f);
+    cache->dirty = false;
+    return true;
+}
+
+void batch_cache_free(batch_cache_t *cache)
+{
+    for (int i=0; i<cache->num; i++)
+        free(cache->entries[i].outfn);
+    free(cache->entries);
+    free(cache->fn);
+    memset(cache, 0, sizeof(*cache));
+}
+
+int batch_default_jobs(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? n : 1;
+#endif
+}
+
+typedef struct {
+    int count;
+    int next;
+    void (*fn)(int idx, void *arg);
+    void *arg;
+} batch_queue_t;
+
+static void* batch_worker(void *arg)
+{
+    batch_queue_t *q = arg;
+    while (1) {
+        batch_lock();
+        int idx = q->next++;
+        batch_unlock();
+        if (idx >= q->count) break;
+        q->fn(idx, q->arg);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Run fn(0..count-1) on a pool of worker threads.
+ *
+ * Items are picked in order by the first available worker, so it is
+ * advisable to sort them from the slowest to the fastest if known.
+ */
+void batch_run(int jobs, int count, void (*fn)(int idx, void *arg), void *arg)
+{
+    batch_queue_t q = { .count = count, .next = 0, .fn = fn, .arg = arg };
+    if (jobs > count) jobs = count;
+    if (jobs <= 1) {
+        batch_worker(&q);
+        return;
+    }
+
+    pthread_t threads[jobs];
+    for (int i=0; i<jobs; i++)
+        pthread_create(&threads[i], NULL, batch_worker, &q);
+    for (int i=0; i<jobs; i++)
+        pthread_join(threads[i], NULL);
+}
+
+void batch_lock(void)
+{
+    pthread_mutex_lock(&batch_mutex);
+}
+
+void batch_unlock(void)
+{
+    pthread_mutex_unlock(&batch_mutex);
+}
+
+double batch_time_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
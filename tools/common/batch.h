@@ -0,0 +1,43 @@
+#ifndef COMMON_BATCH_H
+#define COMMON_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** @brief Initial value for the batch hashing functions (FNV-1a 64-bit) */
+#define BATCH_HASH_INIT     0xcbf29ce484222325ULL
+
+uint64_t batch_hash_buf(uint64_t h, const void *buf, int size);
+uint64_t batch_hash_str(uint64_t h, const char *s);
+uint64_t batch_hash_file(uint64_t h, const char *fn, bool *ok);
+
+/**
+ * @brief Cache of the conversions done by a previous run of a tool.
+ *
+ * Every output file is associated to a hash of its inputs and of the
+ * options used to convert it, so that it can be skipped if nothing changed.
+ * The cache is a text file with one line per output ("<hash> <filename>").
+ */
+typedef struct {
+    char *fn;                   ///< Cache filename
+    struct {
+        char *outfn;            ///< Output filename
+        uint64_t hash;          ///< Hash of inputs and options
+    } *entries;                 ///< Cache entries
+    int num;                    ///< Number of entries
+    bool dirty;                 ///< True if the cache must be saved
+} batch_cache_t;
+
+void batch_cache_load(batch_cache_t *cache, const char *fn);
+bool batch_cache_check(batch_cache_t *cache, const char *outfn, uint64_t hash);
+void batch_cache_update(batch_cache_t *cache, const char *outfn, uint64_t hash);
+bool batch_cache_save(batch_cache_t *cache);
+void batch_cache_free(batch_cache_t *cache);
+
+int batch_default_jobs(void);
+void batch_run(int jobs, int count, void (*fn)(int idx, void *arg), void *arg);
+void batch_lock(void);
+void batch_unlock(void);
+double batch_time_ms(void);
+
+#endif
@@ -7,6 +7,8 @@
 #include <stdint.h>
 #include <sys/types.h>
 #include <sys/param.h>
+#include <stdbool.h>
+#include <limits.h>
 #include "dragonfs.h"
 #include "dfsinternal.h"
 
@@ -19,6 +21,28 @@
 uint8_t *dfs = NULL;
 uint32_t fs_size = 0;
 
+/* Layout optimizer options */
+bool flag_optimize = false;         /* Defer file data placement to the optimizer */
+uint32_t flag_align = SECTOR_SIZE;  /* Alignment of the start of each file */
+const char *flag_trace = NULL;      /* Access trace manifest used to order files */
+
+/* File whose data placement is deferred to the optimizer */
+typedef struct
+{
+    char *file;         /* Path on the host filesystem */
+    char *dfs_path;     /* Path within the filesystem (without leading slash) */
+    uint32_t entry;     /* Offset of the directory entry to patch */
+    uint32_t size;      /* Size of the file */
+    uint32_t data;      /* Offset of the file data in the filesystem */
+    uint64_t hash;      /* Hash of the file contents */
+    int trace_pos;      /* Position of the first access in the trace (INT_MAX if not traced) */
+    int order;          /* Position in directory-walk order */
+    int dup_of;         /* Index of the identical file whose data is shared (-1 if none) */
+} deferred_file_t;
+
+deferred_file_t *deferred = NULL;
+int num_deferred = 0;
+
 /* Offset from start of filesystem */
 inline uint32_t sector_offset(void *sector)
 {
@@ -79,9 +103,15 @@ void kill_fs()
 
 void print_help(const char * const prog_name)
 {
-    fprintf(stderr, "Usage: %s <File> <Directory>\n", prog_name);
+    fprintf(stderr, "Usage: %s [flags] <File> <Directory>\n", prog_name);
     fprintf(stderr, "  where <File> is the resulting filesystem image\n");
     fprintf(stderr, "  and <Directory> is the directory (including subdirectories) to include\n");
+    fprintf(stderr, "\nLayout optimizer flags:\n");
+    fprintf(stderr, "  --optimize          Store identical files only once, and print a layout map\n");
+    fprintf(stderr, "  --align <bytes>     Align the start of each file (multiple of %d, implies --optimize)\n", SECTOR_SIZE);
+    fprintf(stderr, "  --trace <file>      Place files in the order they are first opened in the access trace,\n");
+    fprintf(stderr, "                      so that assets loaded together are contiguous (implies --optimize).\n");
+    fprintf(stderr, "                      The trace is the debug log of a run with dfs_trace_log(true)\n");
 }
 
 uint32_t add_file(const char * const file, uint32_t *size)
@@ -123,7 +153,40 @@ uint32_t add_file(const char * const file, uint32_t *size)
     return blob;
 }
 
-uint32_t add_directory(const char * const path)
+/* Queue a file for the optimizer, to be placed once the whole directory tree is known */
+int defer_file(const char * const file, const char * const dfs_path, uint32_t entry, uint32_t *size)
+{
+    struct stat stats;
+
+    if(stat(file, &stats) != 0)
+    {
+        fprintf(stderr, "Cannot open file '%s' for read!\n", file);
+        return 0;
+    }
+
+    if(stats.st_size > 0x0FFFFFFF)
+    {
+        fprintf(stderr, "File '%s' too big for the filesystem!\n", file);
+        return 0;
+    }
+
+    deferred = realloc(deferred, (num_deferred + 1) * sizeof(deferred_file_t));
+    deferred[num_deferred] = (deferred_file_t){
+        .file = strdup(file),
+        .dfs_path = strdup(dfs_path),
+        .entry = entry,
+        .size = stats.st_size,
+        .trace_pos = INT_MAX,
+        .order = num_deferred,
+        .dup_of = -1,
+    };
+    num_deferred++;
+
+    *size = stats.st_size;
+    return 1;
+}
+
+uint32_t add_directory(const char * const path, const char * const dfs_prefix)
 {
     directory_entry_t *tmp_entry;
     uint32_t first_entry = 0;
@@ -168,6 +231,10 @@ uint32_t add_directory(const char * const path)
 
                 strcat(file, dp->d_name);
 
+                char *dfs_path = malloc(strlen(dfs_prefix) + strlen(dp->d_name) + 2);
+                strcpy(dfs_path, dfs_prefix);
+                strcat(dfs_path, dp->d_name);
+
                 /* Figure out if it is a directory or regular (windows doesn't include d_type in dirent) */
                 stat( file, &stats );
 
@@ -183,12 +250,28 @@ uint32_t add_directory(const char * const path)
                     strncpy(tmp_entry->path, dp->d_name, MAX_FILENAME_LEN);
                     tmp_entry->path[MAX_FILENAME_LEN] = 0;
 
-                    uint32_t new_file = add_file(file, &file_size);
+                    uint32_t new_file = 0;
 
-                    if(!new_file)
+                    if(flag_optimize)
                     {
-                        free(file);
-                        return 0;
+                        /* File pointer will be patched by the optimizer */
+                        if(!defer_file(file, dfs_path, new_entry, &file_size))
+                        {
+                            free(file);
+                            free(dfs_path);
+                            return 0;
+                        }
+                    }
+                    else
+                    {
+                        new_file = add_file(file, &file_size);
+
+                        if(!new_file)
+                        {
+                            free(file);
+                            free(dfs_path);
+                            return 0;
+                        }
                     }
 
                     tmp_entry = sector_to_memory(new_entry);
@@ -217,12 +300,14 @@ uint32_t add_directory(const char * const path)
                     strncpy(tmp_entry->path, dp->d_name, MAX_FILENAME_LEN);
                     tmp_entry->path[MAX_FILENAME_LEN] = 0;
 
-                    uint32_t new_directory = add_directory(file);
+                    strcat(dfs_path, "/");
+                    uint32_t new_directory = add_directory(file, dfs_path);
 
                     if(!new_directory)
                     {
                         fprintf(stderr, "Skipping empty directory: %s\n", file);
                         free(file);
+                        free(dfs_path);
                         continue;
                     }
 
@@ -241,6 +326,7 @@ uint32_t add_directory(const char * const path)
                 }
 
                 free(file);
+                free(dfs_path);
 
                 if(!first_entry)
                 {
@@ -257,13 +343,202 @@ uint32_t add_directory(const char * const path)
     return first_entry;
 }
 
+/* FNV-1a hash of a buffer */
+uint64_t hash_data(const uint8_t *data, uint32_t size)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+
+    for(uint32_t i = 0; i < size; i++)
+    {
+        h ^= data[i];
+        h *= 0x100000001b3ull;
+    }
+
+    return h;
+}
+
+/* Read the access trace manifest, and record the first access of each file */
+int load_trace(const char * const manifest)
+{
+    FILE *fp = fopen(manifest, "r");
+    char line[1024];
+    int pos = 0;
+
+    if(!fp)
+    {
+        fprintf(stderr, "Cannot open trace file '%s' for read!\n", manifest);
+        return 0;
+    }
+
+    while(fgets(line, sizeof(line), fp))
+    {
+        /* Accept both plain lists of paths, and debug logs containing dfs_trace_log() output */
+        char *path = strstr(line, "dfs-trace: ");
+        path = path ? path + strlen("dfs-trace: ") : line;
+
+        path[strcspn(path, "\r\n")] = 0;
+        if(!strncmp(path, "rom:", 4)) path += 4;
+        while(*path == '/') path++;
+        if(!*path || *path == '#') continue;
+
+        for(int i = 0; i < num_deferred; i++)
+        {
+            if(!strcmp(deferred[i].dfs_path, path) && deferred[i].trace_pos == INT_MAX)
+            {
+                deferred[i].trace_pos = pos++;
+            }
+        }
+    }
+
+    fclose(fp);
+    return 1;
+}
+
+int cmp_layout_order(const void *a, const void *b)
+{
+    const deferred_file_t *fa = &deferred[*(const int *)a];
+    const deferred_file_t *fb = &deferred[*(const int *)b];
+
+    if(fa->trace_pos != fb->trace_pos) return fa->trace_pos < fb->trace_pos ? -1 : 1;
+    return fa->order - fb->order;
+}
+
+int cmp_data_offset(const void *a, const void *b)
+{
+    const deferred_file_t *fa = &deferred[*(const int *)a];
+    const deferred_file_t *fb = &deferred[*(const int *)b];
+
+    if(fa->data != fb->data) return fa->data < fb->data ? -1 : 1;
+    return fa->order - fb->order;
+}
+
+/* Place the data of all deferred files: traced files first in access order, then
+   the others in directory-walk order. Identical files are stored only once. */
+int optimize_layout(void)
+{
+    int *idx = malloc(num_deferred * sizeof(int));
+    uint32_t saved = 0, padding = 0;
+    int num_dups = 0;
+
+    for(int i = 0; i < num_deferred; i++) idx[i] = i;
+    qsort(idx, num_deferred, sizeof(int), cmp_layout_order);
+
+    for(int n = 0; n < num_deferred; n++)
+    {
+        deferred_file_t *f = &deferred[idx[n]];
+        uint8_t *buf = malloc(f->size ? f->size : 1);
+        FILE *fp = fopen(f->file, "rb");
+
+        if(!fp || fread(buf, 1, f->size, fp) != f->size)
+        {
+            fprintf(stderr, "Cannot add all contents of file '%s' to filesystem!\n", f->file);
+            if(fp) fclose(fp);
+            free(buf);
+            free(idx);
+            return 0;
+        }
+        fclose(fp);
+
+        f->hash = hash_data(buf, f->size);
+
+        /* Look for an identical file already placed */
+        for(int m = 0; m < n; m++)
+        {
+            deferred_file_t *o = &deferred[idx[m]];
+
+            if(o->dup_of < 0 && o->size == f->size && o->hash == f->hash &&
+               !memcmp(sector_to_memory(o->data), buf, f->size))
+            {
+                f->dup_of = idx[m];
+                f->data = o->data;
+                saved += f->size;
+                num_dups++;
+                break;
+            }
+        }
+
+        if(f->dup_of < 0)
+        {
+            printf("Adding '%s' to filesystem image.\n", f->file);
+
+            /* Pad to the requested alignment */
+            if(fs_size % flag_align)
+            {
+                uint32_t pad = flag_align - fs_size % flag_align;
+                new_blob(pad);
+                padding += pad;
+            }
+
+            f->data = new_blob(f->size);
+            memcpy(sector_to_memory(f->data), buf, f->size);
+        }
+
+        directory_entry_t *entry = sector_to_memory(f->entry);
+        entry->file_pointer = SWAPLONG(f->data);
+        free(buf);
+    }
+
+    /* Print the layout map */
+    qsort(idx, num_deferred, sizeof(int), cmp_data_offset);
+    printf("\nLayout map:\n");
+    printf("    Offset       Size  Path\n");
+    for(int n = 0; n < num_deferred; n++)
+    {
+        deferred_file_t *f = &deferred[idx[n]];
+
+        printf("0x%08x %10u  %s", f->data, f->size, f->dfs_path);
+        if(f->trace_pos != INT_MAX) printf(" [trace #%d]", f->trace_pos);
+        if(f->dup_of >= 0) printf(" (same as %s)", deferred[f->dup_of].dfs_path);
+        printf("\n");
+    }
+
+    printf("\n%d files, %d duplicates: %u bytes saved, %u bytes of alignment padding, %u bytes total\n",
+        num_deferred, num_dups, saved, padding, fs_size);
+
+    free(idx);
+    return 1;
+}
+
 int main(int argc, char *argv[])
 {
-    if(argc != 3)
+    int i = 1;
+
+    for(; i < argc && argv[i][0] == '-'; i++)
+    {
+        if(!strcmp(argv[i], "--optimize"))
+        {
+            flag_optimize = true;
+        }
+        else if(!strcmp(argv[i], "--align") && i + 1 < argc)
+        {
+            char *end;
+            flag_align = strtoul(argv[++i], &end, 0);
+
+            if(*end || flag_align == 0 || flag_align % SECTOR_SIZE)
+            {
+                fprintf(stderr, "Invalid alignment: %s (must be a multiple of %d)\n", argv[i], SECTOR_SIZE);
+                return -1;
+            }
+            flag_optimize = true;
+        }
+        else if(!strcmp(argv[i], "--trace") && i + 1 < argc)
+        {
+            flag_trace = argv[++i];
+            flag_optimize = true;
+        }
+        else
+        {
+            print_help(argv[0]);
+            return -1;
+        }
+    }
+
+    if(argc - i != 2)
     {
         print_help(argv[0]);
         return -1;
     }
+    argv += i - 1;
 
     /* Add in identifier */
     directory_entry_t *id = sector_to_memory(new_sector());
@@ -279,7 +554,7 @@ int main(int argc, char *argv[])
     id->next_entry = SWAPLONG(ROOT_NEXT_ENTRY);
     strcpy(id->path, ROOT_PATH);
 
-    if(!add_directory(argv[2]))
+    if(!add_directory(argv[2], ""))
     {
         /* Error adding directory */
         fprintf(stderr, "Error creating filesystem: directory is empty or does not exist: %s\n", argv[2]);
@@ -289,6 +564,16 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    if(flag_optimize)
+    {
+        if((flag_trace && !load_trace(flag_trace)) || !optimize_layout())
+        {
+            kill_fs();
+
+            return -1;
+        }
+    }
+
     /* Write out filesystem */
     FILE *fp = fopen(argv[1], "wb");
 
@@ -10,7 +10,7 @@
 #define STB_DS_IMPLEMENTATION
 #include "../common/stb_ds.h"
 #define STB_RECT_PACK_IMPLEMENTATION
-#include "stb_rect_pack.h"
+#include "../common/stb_rect_pack.h"
 #define STB_TRUETYPE_IMPLEMENTATION
 #include "stb_truetype.h"
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -24,6 +24,10 @@
 #include "../common/assetcomp.h"
 #include "../common/assetcomp.c"
 
+// Batch processing (thread pool, incremental cache)
+#include "../common/batch.h"
+#include "../common/batch.c"
+
 #include "../common/binout.h"
 #include "../common/subprocess.h"
 #include "../common/utils.h"
@@ -37,6 +41,8 @@ int *flag_ranges = NULL;
 const char *n64_inst = NULL;
 int flag_ellipsis_cp = 0x002E;
 int flag_ellipsis_repeats = 3;
+bool flag_timings = false;
+batch_cache_t *flag_cache = NULL;
 
 void print_args( char * name )
 {
@@ -50,6 +56,8 @@ void print_args( char * name )
     fprintf(stderr, "   --ellipsis <cp>,<reps>    Select glyph and repetitions to use for ellipsis (default: 2E,3) \n");
     fprintf(stderr, "   -c/--compress <level>     Compress output files (default: %d)\n", DEFAULT_COMPRESSION);
     fprintf(stderr, "   -d/--debug                Dump also debug images\n");
+    fprintf(stderr, "   -j/--jobs <n>             Convert input files in parallel using n threads (0: one per CPU), printing timings\n");
+    fprintf(stderr, "   --cache <file>            Skip input files whose contents and options did not change since the last run\n");
     fprintf(stderr, "\n");
     // fprintf(stderr, "BMFont specific flags:\n");
     // fprintf(stderr, "\n");
@@ -223,7 +231,9 @@ static void png_write_func(void *context, void *data, int size)
 void n64font_addatlas(rdpq_font_t *fnt, uint8_t *buf, int width, int height, int stride)
 {
     static char *mksprite = NULL;
+    batch_lock();
     if (!mksprite) asprintf(&mksprite, "%s/bin/mksprite", n64_inst);
+    batch_unlock();
 
     // Prepare mksprite command line
     struct subprocess_s subp;
@@ -610,11 +620,91 @@ int convert_ttf(const char *infn, const char *outfn, int point_size, int *ranges
 
 #include "mkfont_bmfont.c"
 
+typedef struct {
+    const char *infn;       // Input file
+    char *outfn;            // Output file
+    int point_size;         // Point size (TTF/OTF)
+    int *ranges;            // Codepoint ranges (TTF/OTF)
+    int compression;        // Compression level
+    bool error;             // Set if the conversion failed
+} convert_job_t;
+
+/** @brief Hash of the inputs and options of a conversion, used by --cache */
+uint64_t convert_job_hash(convert_job_t *job, bool *ok)
+{
+    uint64_t h = BATCH_HASH_INIT;
+    h = batch_hash_str(h, "mkfont");
+    h = batch_hash_file(h, job->infn, ok);
+    int opts[] = { job->point_size, job->compression, flag_kerning, flag_ellipsis_cp, flag_ellipsis_repeats };
+    h = batch_hash_buf(h, opts, sizeof(opts));
+    h = batch_hash_buf(h, job->ranges, arrlen(job->ranges) * sizeof(int));
+    return h;
+}
+
+void convert_job(int idx, void *arg)
+{
+    convert_job_t *job = &((convert_job_t*)arg)[idx];
+    const char *infn = job->infn, *outfn = job->outfn;
+    double t0 = batch_time_ms();
+
+    uint64_t hash = 0; bool ok = false;
+    if (flag_cache) {
+        hash = convert_job_hash(job, &ok);
+        if (ok && batch_cache_check(flag_cache, outfn, hash)) {
+            if (flag_timings)
+                fprintf(stderr, "[ up-to-date ] %s\n", outfn);
+            return;
+        }
+    }
+
+    if (flag_verbose)
+        printf("Converting: %s -> %s\n",
+            infn, outfn);
+
+    int ret;
+    int compression = job->compression;
+    if (strcasestr(infn, ".ttf") || strcasestr(infn, ".otf")) {
+        ret = convert_ttf(infn, outfn, job->point_size, job->ranges);
+    } else if (strcasestr(infn, ".fnt")) {
+        fprintf(stderr, "Error: BMFont support is incomplete.\n"); exit(1);
+        compression = 0;
+        ret = convert_bmfont(infn, outfn);
+    } else {
+        fprintf(stderr, "Error: unknown input file type: %s\n", infn);
+        ret = 1;
+    }
+
+    if (ret != 0) {
+        job->error = true;
+        return;
+    }
+
+    if (compression) {
+        // The compressors are not thread-safe
+        batch_lock();
+        struct stat st_decomp = {0}, st_comp = {0};
+        stat(outfn, &st_decomp);
+        asset_compress(outfn, outfn, compression);
+        stat(outfn, &st_comp);
+        if (flag_verbose)
+            printf("compressed: %s (%d -> %d, ratio %.1f%%)\n", outfn,
+            (int)st_decomp.st_size, (int)st_comp.st_size, 100.0 * (float)st_comp.st_size / (float)(st_decomp.st_size == 0 ? 1 :st_decomp.st_size));
+        batch_unlock();
+    }
+
+    if (flag_cache && ok)
+        batch_cache_update(flag_cache, outfn, hash);
+    if (flag_timings)
+        fprintf(stderr, "[%9.1f ms] %s -> %s\n", batch_time_ms() - t0, infn, outfn);
+}
+
 int main(int argc, char *argv[])
 {
     char *infn = NULL, *outdir = ".", *outfn = NULL;
     bool error = false;
     int compression = DEFAULT_COMPRESSION;
+    convert_job_t *jobs = NULL;
+    int parallel = 1; batch_cache_t cache;
 
     if (argc < 2) {
         print_args(argv[0]);
@@ -681,6 +771,27 @@ int main(int argc, char *argv[])
                         return 1;
                     }
                 }
+            } else if (!strcmp(argv[i], "-j") || !strcmp(argv[i], "--jobs")) {
+                if (++i == argc) {
+                    fprintf(stderr, "missing argument for %s\n", argv[i-1]);
+                    return 1;
+                }
+                char extra;
+                if (sscanf(argv[i], "%d%c", &parallel, &extra) != 1 || parallel < 0) {
+                    fprintf(stderr, "invalid argument for %s: %s\n", argv[i-1], argv[i]);
+                    return 1;
+                }
+                if (parallel == 0)
+                    parallel = batch_default_jobs();
+                flag_timings = true;
+            } else if (!strcmp(argv[i], "--cache")) {
+                if (++i == argc) {
+                    fprintf(stderr, "missing argument for %s\n", argv[i-1]);
+                    return 1;
+                }
+                if (flag_cache) batch_cache_free(flag_cache);
+                batch_cache_load(&cache, argv[i]);
+                flag_cache = &cache;
             } else if (!strcmp(argv[i], "-o") || !strcmp(argv[i], "--output")) {
                 if (++i == argc) {
                     fprintf(stderr, "missing argument for %s\n", argv[i-1]);
@@ -717,36 +828,34 @@ int main(int argc, char *argv[])
         }
 
         asprintf(&outfn, "%s/%s.font64", outdir, basename_noext);
-        if (flag_verbose)
-            printf("Converting: %s -> %s\n",
-                infn, outfn);
-        
-        int ret;
-        if (strcasestr(infn, ".ttf") || strcasestr(infn, ".otf")) {
-            ret = convert_ttf(infn, outfn, flag_point_size, flag_ranges);
-        } else if (strcasestr(infn, ".fnt")) {
-            fprintf(stderr, "Error: BMFont support is incomplete.\n"); exit(1);
-            compression = 0;
-            ret = convert_bmfont(infn, outfn);
-        } else {
-            fprintf(stderr, "Error: unknown input file type: %s\n", infn);
-            ret = 1;
-        }
+        free(basename_noext);
+
+        // Queue the conversion with the options specified so far
+        convert_job_t job = {
+            .infn = infn, .outfn = outfn, .point_size = flag_point_size,
+            .compression = compression,
+        };
+        for (int r=0; r<arrlen(flag_ranges); r++)
+            arrpush(job.ranges, flag_ranges[r]);
+        arrpush(jobs, job);
+    }
 
-        if (ret != 0) {
-            error = true;
-        } else {
-            if (compression) {
-                struct stat st_decomp = {0}, st_comp = {0};
-                stat(outfn, &st_decomp);
-                asset_compress(outfn, outfn, compression);
-                stat(outfn, &st_comp);
-                if (flag_verbose)
-                    printf("compressed: %s (%d -> %d, ratio %.1f%%)\n", outfn,
-                    (int)st_decomp.st_size, (int)st_comp.st_size, 100.0 * (float)st_comp.st_size / (float)(st_decomp.st_size == 0 ? 1 :st_decomp.st_size));
-            }
+    if (arrlen(jobs) > 0) {
+        double t0 = batch_time_ms();
+        batch_run(parallel, arrlen(jobs), convert_job, jobs);
+        for (int i=0; i<arrlen(jobs); i++) {
+            if (jobs[i].error) error = true;
+            free(jobs[i].outfn);
+            arrfree(jobs[i].ranges);
         }
-        free(outfn);
+        if (flag_timings)
+            fprintf(stderr, "[%9.1f ms] total (%d files, %d jobs)\n", batch_time_ms() - t0, (int)arrlen(jobs), parallel);
+        arrfree(jobs);
+    }
+
+    if (flag_cache) {
+        batch_cache_save(flag_cache);
+        batch_cache_free(flag_cache);
     }
 
     return error ? 1 : 0;
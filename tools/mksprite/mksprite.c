@@ -5,6 +5,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include <assert.h>
+#include <math.h>
 #include <sys/stat.h>
 #include "../common/binout.h"
 #include "../common/polyfill.h"
@@ -23,6 +24,14 @@
 #include "../common/assetcomp.h"
 #include "../common/assetcomp.c"
 
+// Batch processing (thread pool, incremental cache)
+#include "../common/batch.h"
+#include "../common/batch.c"
+
+// Rectangle packing (for atlases)
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "../common/stb_rect_pack.h"
+
 // Bring in tex_format_t definition
 #include "surface.h"
 #include "sprite.h"
@@ -65,26 +74,34 @@ tex_format_t tex_format_from_name(const char *name) {
     return FMT_NONE;
 }
 
-#define MIPMAP_ALGO_NONE  0
-#define MIPMAP_ALGO_BOX   1
+#define MIPMAP_ALGO_NONE     0
+#define MIPMAP_ALGO_BOX      1
+#define MIPMAP_ALGO_LANCZOS  2
+#define MIPMAP_ALGO_KAISER   3
 
 const char *mipmap_algo_name(int algo) {
     switch (algo) {
     case MIPMAP_ALGO_NONE: return "NONE";
     case MIPMAP_ALGO_BOX: return "BOX";
+    case MIPMAP_ALGO_LANCZOS: return "LANCZOS";
+    case MIPMAP_ALGO_KAISER: return "KAISER";
     default: assert(0); return "";
     }
 }
 
-#define DITHER_ALGO_NONE     0
-#define DITHER_ALGO_RANDOM   1
-#define DITHER_ALGO_ORDERED  2
+#define DITHER_ALGO_NONE             0
+#define DITHER_ALGO_RANDOM           1
+#define DITHER_ALGO_ORDERED          2
+#define DITHER_ALGO_FLOYD_STEINBERG  3
+#define DITHER_ALGO_SIERRA           4
 
 const char *dither_algo_name(int algo) {
     switch (algo) {
     case DITHER_ALGO_NONE: return "NONE";
     case DITHER_ALGO_RANDOM: return "RANDOM";
     case DITHER_ALGO_ORDERED: return "ORDERED";
+    case DITHER_ALGO_FLOYD_STEINBERG: return "FLOYD_STEINBERG";
+    case DITHER_ALGO_SIERRA: return "SIERRA";
     default: assert(0); return "";
     }
 }
@@ -108,7 +125,14 @@ typedef struct {
     int tileh;
     int mipmap_algo;
     int dither_algo;
+    bool perceptual;
+    bool blockcomp;
     texparms_t texparms;
+    struct {
+        const char *name;         // Base name of the atlas output files (NULL: atlas disabled)
+        int width, height;        // Maximum size of each atlas sheet (0: fit TMEM)
+        int padding;              // Empty pixels between sub-images
+    } atlas;
     struct{
         const char   *infn;       // Input file for detail texture
         texparms_t   texparms;
@@ -123,17 +147,19 @@ typedef struct {
 
 bool flag_verbose = false;
 bool flag_debug = false;
+bool flag_timings = false;
+batch_cache_t *flag_cache = NULL;
 
 void print_supported_formats(void) {
     fprintf(stderr, "Supported formats: AUTO, RGBA32, RGBA16, IA16, CI8, I8, IA8, CI4, I4, IA4, ZBUF\n");
 }
 
 void print_supported_mipmap(void) {
-    fprintf(stderr, "Supported mipmap algorithms: NONE (disable), BOX\n");
+    fprintf(stderr, "Supported mipmap algorithms: NONE (disable), BOX, LANCZOS, KAISER\n");
 }
 
 void print_supported_dithers(void) {
-    fprintf(stderr, "Supported dithering algorithms: NONE (disable), RANDOM, ORDERED. \nNote that dithering is only applied while quantizing an image.\n");
+    fprintf(stderr, "Supported dithering algorithms: NONE (disable), RANDOM, ORDERED, FLOYD_STEINBERG, SIERRA. \nNote that dithering is only applied while quantizing an image.\n");
 }
 
 void print_args( char * name )
@@ -145,8 +171,13 @@ void print_args( char * name )
     fprintf(stderr, "   -o/--output <dir>     Specify output directory (default: .)\n");
     fprintf(stderr, "   -f/--format <fmt>     Specify output format (default: AUTO)\n");
     fprintf(stderr, "   -D/--dither <dither>  Dithering algorithm (default: NONE)\n");
+    fprintf(stderr, "   -p/--perceptual       Select and map CI4/CI8 palettes in the OKLab color space\n");
+    fprintf(stderr, "   --compress-blocks     Store RGBA16 images as 4x4 compressed blocks (4 bits per pixel),\n");
+    fprintf(stderr, "                         decoded at upload time by rdpq\n");
     fprintf(stderr, "   -c/--compress <level> Compress output files (default: %d)\n", DEFAULT_COMPRESSION);
     fprintf(stderr, "   -d/--debug            Dump computed images (eg: mipmaps) as PNG files in output directory\n");
+    fprintf(stderr, "   -j/--jobs <n>         Convert input files in parallel using n threads (0: one per CPU), printing timings\n");
+    fprintf(stderr, "   --cache <file>        Skip input files whose contents and options did not change since the last run\n");
     fprintf(stderr, "\nSampling flags:\n");
     fprintf(stderr, "   --texparms <x,s,r,m>          Sampling parameters:\n");
     fprintf(stderr, "                                 x=translation, s=scale, r=repetitions, m=mirror\n");
@@ -158,6 +189,11 @@ void print_args( char * name )
     fprintf(stderr, "                                         <fmt> is the output format (default: AUTO)\n");
     fprintf(stderr, "                                         <factor> is the blend factor in range 0..1 (default: 0.5)\n");
     fprintf(stderr, "   --detail-texparms <x,x,s,s,r,r,m,m>   Sampling parameters for the detail texture\n");
+    fprintf(stderr, "\nAtlas flags:\n");
+    fprintf(stderr, "   --atlas <name>          Pack all input images into atlas sheets with a shared palette,\n");
+    fprintf(stderr, "                           written as <name>.sprite (or <name>_N.sprite if more than one)\n");
+    fprintf(stderr, "   --atlas-size <w,h>      Maximum size of an atlas sheet (default: fit TMEM in the output format)\n");
+    fprintf(stderr, "   --atlas-padding <n>     Empty pixels between images in the atlas (default: 0)\n");
     fprintf(stderr, "\n");
     print_supported_formats();
     print_supported_mipmap();
@@ -215,14 +251,24 @@ typedef struct {
 
 #define MAX_IMAGES 8
 
+typedef struct {
+    int x, y, w, h;         // Position and size of the sub-image in the sheet
+    char *name;             // Name of the sub-image (input basename without extension)
+} atlas_rect_t;
+
 typedef struct {
     const char *infn;       // Input file
     const char *outfn;      // Output file
+    const uint8_t *inpng;   // In-memory PNG to load instead of infn (if not NULL)
+    size_t inpng_size;      // Size of the in-memory PNG
+    atlas_rect_t *atlas;    // Sub-images packed in this sprite (if it is an atlas sheet)
+    int atlas_count;        // Number of sub-images in the atlas
     image_t images[MAX_IMAGES]; // Pixel images (one per lod level).
     palette_t palette;      // Palette (if any)
     int vslices;            // Number of vertical slices (deprecated API for old rdp.c)
     int hslices;            // Number of horizontal slices (deprecated API for old rdp.c)
     texparms_t texparms;    // Texture parameters
+    bool blockcomp;         // Store RGBA16 images as 4x4 compressed blocks
     struct{
         const char   *infn;         // Input file for detail texture
         texparms_t   texparms;      // Texture parameters for the detail
@@ -237,12 +283,14 @@ typedef struct {
  * @brief Load a PNG image from a file, performing all the required color conversions
  * 
  * @param infn      Input filename
+ * @param pngbuf    If not NULL, PNG file contents already in memory (infn is then only used for logging)
+ * @param pngsz     Size of pngbuf
  * @param fmt       Output format requested by the user (of FMT_NONE for autodetection)
  * @param imgout    Pointer to the image_t structure to fill
  * @return true     If the image was loaded successfully
  * @return false    If there was an error
  */
-bool load_png_image(const char *infn, tex_format_t fmt, image_t *imgout, palette_t *palout) {
+bool load_png_image(const char *infn, const uint8_t *pngbuf, size_t pngsz, tex_format_t fmt, image_t *imgout, palette_t *palout) {
     LodePNGState state;
     bool autofmt = (fmt == FMT_NONE);
     unsigned char* png = 0;
@@ -258,7 +306,11 @@ bool load_png_image(const char *infn, tex_format_t fmt, image_t *imgout, palette
     // Initialize lodepng and load the input file into memory (without decoding).
     lodepng_state_init(&state);
 
-    if (strcmp(infn, "(stdin)") != 0) {
+    if (pngbuf) {
+        png = malloc(pngsz);
+        memcpy(png, pngbuf, pngsz);
+        pngsize = pngsz;
+    } else if (strcmp(infn, "(stdin)") != 0) {
         error = lodepng_load_file(&png, &pngsize, infn);
         if(error) {
             fprintf(stderr, "%s: PNG reading error: %u: %s\n", infn, error, lodepng_error_text(error));
@@ -457,14 +509,14 @@ error:
 
 bool spritemaker_load_png(spritemaker_t *spr, tex_format_t outfmt)
 {
-    return load_png_image(spr->infn, outfmt, &spr->images[0], &spr->palette);
+    return load_png_image(spr->infn, spr->inpng, spr->inpng_size, outfmt, &spr->images[0], &spr->palette);
 }
 
 bool spritemaker_load_detail_png(spritemaker_t *spr, tex_format_t outfmt)
 {
     // Load the detail texture into images[7], as last lod.
     palette_t pal;
-    bool ok = load_png_image(spr->detail.infn, outfmt, &spr->images[7], &pal);
+    bool ok = load_png_image(spr->detail.infn, NULL, 0, outfmt, &spr->images[7], &pal);
 
     // For now, abort if the detail texture is palettized
     if (ok && (spr->images[7].fmt == FMT_CI4 || spr->images[7].fmt == FMT_CI8)) {
@@ -496,9 +548,105 @@ bool spritemaker_fit_tmem(spritemaker_t *spr, int *out_tmem_usage)
     return tmem_usage <= 4096;
 }
 
+// Lanczos kernel with 3 lobes
+static double mipmap_kernel_lanczos(double x) {
+    const double a = 3.0;
+    if (x == 0) return 1.0;
+    if (fabs(x) >= a) return 0.0;
+    double px = M_PI * x;
+    return a * sin(px) * sin(px / a) / (px * px);
+}
+
+// Modified Bessel function of the first kind (order 0), used by the Kaiser window
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k=1; k<32; k++) {
+        term *= (x / (2*k)) * (x / (2*k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Kaiser-windowed sinc kernel (support 3, alpha 4)
+static double mipmap_kernel_kaiser(double x) {
+    const double a = 3.0, alpha = 4.0;
+    if (fabs(x) >= a) return 0.0;
+    double sinc = x == 0 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+    double r = x / a;
+    return sinc * bessel_i0(alpha * sqrt(1.0 - r*r)) / bessel_i0(alpha);
+}
+
+/**
+ * @brief Halve an image using a separable windowed-sinc filter
+ *
+ * The kernel is evaluated in destination pixel space, so that for a 2x
+ * reduction it spans twice as many source pixels. Borders are clamped.
+ *
+ * @param src       Source pixels (interleaved channels)
+ * @param sw        Source width
+ * @param sh        Source height
+ * @param nch       Number of channels per pixel
+ * @param kernel    Filter kernel (support [-3, 3])
+ * @return          Newly allocated image of (sw/2)x(sh/2) pixels
+ */
+static uint8_t *mipmap_downsample(const uint8_t *src, int sw, int sh, int nch, double (*kernel)(double)) {
+    const int taps = 12;
+    int dw = sw / 2, dh = sh / 2;
+    double weights[12];
+    double wsum = 0;
+
+    // For a 2x reduction, destination pixel centers always fall on the same
+    // phase of the source grid, so the weights are the same for every pixel.
+    for (int k=0; k<taps; k++) {
+        double x = (k - taps/2 + 0.5) / 2.0;
+        weights[k] = kernel(x);
+        wsum += weights[k];
+    }
+    for (int k=0; k<taps; k++)
+        weights[k] /= wsum;
+
+    // Horizontal pass into a float buffer
+    float *tmp = malloc(dw * sh * nch * sizeof(float));
+    for (int y=0; y<sh; y++) {
+        for (int x=0; x<dw; x++) {
+            for (int c=0; c<nch; c++) {
+                double v = 0;
+                for (int k=0; k<taps; k++) {
+                    int sx = x*2 + k - taps/2 + 1;
+                    if (sx < 0) sx = 0;
+                    if (sx >= sw) sx = sw-1;
+                    v += weights[k] * src[(y*sw + sx)*nch + c];
+                }
+                tmp[(y*dw + x)*nch + c] = v;
+            }
+        }
+    }
+
+    // Vertical pass, with clamping to the 8-bit range
+    uint8_t *dst = malloc(dw * dh * nch);
+    for (int y=0; y<dh; y++) {
+        for (int x=0; x<dw; x++) {
+            for (int c=0; c<nch; c++) {
+                double v = 0;
+                for (int k=0; k<taps; k++) {
+                    int sy = y*2 + k - taps/2 + 1;
+                    if (sy < 0) sy = 0;
+                    if (sy >= sh) sy = sh-1;
+                    v += weights[k] * tmp[(sy*dw + x)*nch + c];
+                }
+                v = round(v);
+                dst[(y*dw + x)*nch + c] = v < 0 ? 0 : v > 255 ? 255 : v;
+            }
+        }
+    }
+
+    free(tmp);
+    return dst;
+}
+
 bool spritemaker_calc_lods(spritemaker_t *spr, int algo) {
     // Calculate mipmap levels
-    assert(algo == MIPMAP_ALGO_BOX);
+    assert(algo == MIPMAP_ALGO_BOX || algo == MIPMAP_ALGO_LANCZOS || algo == MIPMAP_ALGO_KAISER);
 
     int tmem_usage;
     if (!spritemaker_fit_tmem(spr, &tmem_usage)) {
@@ -522,7 +670,13 @@ bool spritemaker_calc_lods(spritemaker_t *spr, int algo) {
             break;
         }
         uint8_t *mipmap = NULL;
-        switch (prev->ct) {
+        if (algo != MIPMAP_ALGO_BOX && (prev->ct == LCT_RGBA || prev->ct == LCT_GREY)) {
+            if (prev->ct == LCT_GREY)
+                assert(prev->fmt == FMT_I8);  // only I8 supported for now
+            mipmap = mipmap_downsample(prev->image, prev->width, prev->height,
+                prev->ct == LCT_RGBA ? 4 : 1,
+                algo == MIPMAP_ALGO_LANCZOS ? mipmap_kernel_lanczos : mipmap_kernel_kaiser);
+        } else switch (prev->ct) {
         case LCT_RGBA:
             mipmap = malloc(mw * mh * 4);
             for (int y=0;y<mh;y++) {
@@ -606,7 +760,187 @@ bool spritemaker_expand_rgba(spritemaker_t *spr) {
     return true;
 }
 
-bool spritemaker_quantize(spritemaker_t *spr, uint8_t *colors, int num_colors, int dither) {
+typedef struct {
+    float l, a, b, alpha;
+} oklab_t;
+
+// sRGB to linear conversion table for 8-bit components
+static float srgb_to_linear_lut[256];
+
+static void oklab_init(void) {
+    for (int i=0; i<256; i++) {
+        float c = i / 255.0f;
+        srgb_to_linear_lut[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+}
+
+static float linear_to_srgb(float c) {
+    c = c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f/2.4f) - 0.055f;
+    return c < 0 ? 0 : c > 1 ? 1 : c;
+}
+
+static oklab_t rgb_to_oklab(float r, float g, float b, float alpha) {
+    // https://bottosson.github.io/posts/oklab/
+    float l = 0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b;
+    float m = 0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b;
+    float s = 0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b;
+    l = cbrtf(l); m = cbrtf(m); s = cbrtf(s);
+    return (oklab_t){
+        .l = 0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s,
+        .a = 1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s,
+        .b = 0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s,
+        .alpha = alpha,
+    };
+}
+
+static oklab_t rgba8_to_oklab(const uint8_t *c) {
+    return rgb_to_oklab(srgb_to_linear_lut[c[0]], srgb_to_linear_lut[c[1]], srgb_to_linear_lut[c[2]], c[3] / 255.0f);
+}
+
+static void oklab_to_rgba8(oklab_t c, uint8_t *out) {
+    float l = c.l + 0.3963377774f * c.a + 0.2158037573f * c.b;
+    float m = c.l - 0.1055613458f * c.a - 0.0638541728f * c.b;
+    float s = c.l - 0.0894841775f * c.a - 1.2914855480f * c.b;
+    l = l*l*l; m = m*m*m; s = s*s*s;
+    float r = +4.0767416621f * l - 3.3077115913f * m + 0.2309699292f * s;
+    float g = -1.2684380046f * l + 2.6097574011f * m - 0.3413193965f * s;
+    float b = -0.0041960863f * l - 0.7034186147f * m + 1.7076147010f * s;
+    out[0] = roundf(linear_to_srgb(r) * 255.0f);
+    out[1] = roundf(linear_to_srgb(g) * 255.0f);
+    out[2] = roundf(linear_to_srgb(b) * 255.0f);
+    out[3] = c.alpha >= 0.5f ? 255 : 0;
+}
+
+// Distance between two colors, either in OKLab (perceptual) or plain RGB space.
+// Alpha is weighted heavily as it is just one bit in RGBA5551 palettes.
+static float color_distance(const float *c1, const float *c2) {
+    float d0 = c1[0]-c2[0], d1 = c1[1]-c2[1], d2 = c1[2]-c2[2], d3 = c1[3]-c2[3];
+    return d0*d0 + d1*d1 + d2*d2 + 4.0f*d3*d3;
+}
+
+static void color_to_space(const float *rgba, bool perceptual, float *out) {
+    if (perceptual) {
+        float r = rgba[0] < 0 ? 0 : rgba[0] > 255 ? 255 : rgba[0];
+        float g = rgba[1] < 0 ? 0 : rgba[1] > 255 ? 255 : rgba[1];
+        float b = rgba[2] < 0 ? 0 : rgba[2] > 255 ? 255 : rgba[2];
+        oklab_t c = rgb_to_oklab(srgb_to_linear_lut[(int)r], srgb_to_linear_lut[(int)g], srgb_to_linear_lut[(int)b], rgba[3] / 255.0f);
+        out[0] = c.l; out[1] = c.a; out[2] = c.b; out[3] = c.alpha;
+    } else {
+        for (int i=0; i<4; i++) out[i] = rgba[i] / 255.0f;
+    }
+}
+
+static int palette_nearest(const float (*pal)[4], int num_colors, const float *c) {
+    int best = 0; float bestd = INFINITY;
+    for (int i=0; i<num_colors; i++) {
+        float d = color_distance(pal[i], c);
+        if (d < bestd) { bestd = d; best = i; }
+    }
+    return best;
+}
+
+/**
+ * @brief Refine a palette with k-means iterations in OKLab space.
+ *
+ * exoquant selects its palette in a weighted RGB space. This moves each entry
+ * to the perceptual centroid of the pixels that map to it, snapping the result
+ * to RGB555 after every iteration so that the final palette is what the RDP
+ * will actually use.
+ */
+static void palette_refine_oklab(spritemaker_t *spr, uint8_t (*colors)[4], int num_colors) {
+    const int iterations = 8;
+    float pal[256][4];
+    double sums[256][4]; int counts[256];
+
+    for (int it=0; it<iterations; it++) {
+        for (int i=0; i<num_colors; i++) {
+            oklab_t c = rgba8_to_oklab(colors[i]);
+            pal[i][0] = c.l; pal[i][1] = c.a; pal[i][2] = c.b; pal[i][3] = c.alpha;
+        }
+        memset(sums, 0, sizeof(sums));
+        memset(counts, 0, sizeof(counts));
+        for (int m=0; m<MAX_IMAGES; m++) {
+            image_t *img = &spr->images[m];
+            if (!img->image) continue;
+            for (int p=0; p<img->width*img->height; p++) {
+                oklab_t c = rgba8_to_oklab(img->image + p*4);
+                float cf[4] = { c.l, c.a, c.b, c.alpha };
+                int idx = palette_nearest((const float (*)[4])pal, num_colors, cf);
+                for (int k=0; k<4; k++) sums[idx][k] += cf[k];
+                counts[idx]++;
+            }
+        }
+        bool changed = false;
+        for (int i=0; i<num_colors; i++) {
+            if (!counts[i]) continue;
+            oklab_t c = { sums[i][0]/counts[i], sums[i][1]/counts[i], sums[i][2]/counts[i], sums[i][3]/counts[i] };
+            uint8_t rgba[4];
+            oklab_to_rgba8(c, rgba);
+            for (int k=0; k<3; k++) rgba[k] = (rgba[k] & 0xF8) | (rgba[k] >> 5);
+            if (memcmp(rgba, colors[i], 4)) changed = true;
+            memcpy(colors[i], rgba, 4);
+        }
+        if (!changed) break;
+    }
+}
+
+/**
+ * @brief Map a RGBA image to a palette, optionally with error-diffusion dithering.
+ *
+ * Scanning is serpentine to avoid directional artifacts. The error is diffused
+ * only on the color channels; alpha is matched but never dithered.
+ */
+static void palette_map_image(image_t *img, uint8_t (*colors)[4], int num_colors, int dither, bool perceptual, uint8_t *ci_image) {
+    // Error diffusion kernels: {dx, dy, weight}, normalized by the divisor
+    static const int fs_kernel[][3] = { {1,0,7}, {-1,1,3}, {0,1,5}, {1,1,1} };
+    static const int sierra_kernel[][3] = {
+        {1,0,5}, {2,0,3},
+        {-2,1,2}, {-1,1,4}, {0,1,5}, {1,1,4}, {2,1,2},
+        {-1,2,2}, {0,2,3}, {1,2,2},
+    };
+    const int (*kernel)[3] = NULL; int ntaps = 0; float divisor = 1;
+    switch (dither) {
+    case DITHER_ALGO_FLOYD_STEINBERG: kernel = fs_kernel; ntaps = 4; divisor = 16; break;
+    case DITHER_ALGO_SIERRA: kernel = sierra_kernel; ntaps = 10; divisor = 32; break;
+    }
+
+    float pal[256][4];
+    for (int i=0; i<num_colors; i++) {
+        float c[4] = { colors[i][0], colors[i][1], colors[i][2], colors[i][3] };
+        color_to_space(c, perceptual, pal[i]);
+    }
+
+    int w = img->width, h = img->height;
+    float *err = calloc(w * 3 * 3, sizeof(float));    // three rows of RGB error
+    for (int y=0; y<h; y++) {
+        bool rtl = y & 1;
+        for (int i=0; i<w; i++) {
+            int x = rtl ? w-1-i : i;
+            const uint8_t *px = img->image + (y*w + x)*4;
+            float *e = err + ((y%3)*w + x)*3;
+            float c[4] = { px[0] + e[0], px[1] + e[1], px[2] + e[2], px[3] };
+            float cs[4];
+            color_to_space(c, perceptual, cs);
+            int idx = palette_nearest((const float (*)[4])pal, num_colors, cs);
+            ci_image[y*w + x] = idx;
+
+            for (int t=0; t<ntaps; t++) {
+                int dx = rtl ? -kernel[t][0] : kernel[t][0];
+                int nx = x + dx, ny = y + kernel[t][1];
+                if (nx < 0 || nx >= w || ny >= h) continue;
+                float *ne = err + ((ny%3)*w + nx)*3;
+                float wt = kernel[t][2] / divisor;
+                for (int k=0; k<3; k++)
+                    ne[k] += (c[k] - colors[idx][k]) * wt;
+            }
+        }
+        // Clear the row that will be reused for y+3
+        memset(err + (y%3)*w*3, 0, w*3*sizeof(float));
+    }
+    free(err);
+}
+
+bool spritemaker_quantize(spritemaker_t *spr, uint8_t *colors, int num_colors, int dither, bool perceptual) {
     if (flag_verbose)
         fprintf(stderr, "quantizing image(s) to %d colors%s\n", num_colors, colors ? " (using existing palette)" : "");
 
@@ -634,6 +968,11 @@ bool spritemaker_quantize(spritemaker_t *spr, uint8_t *colors, int num_colors, i
         exq_get_palette(exq, spr->palette.colors[0], num_colors);
         spr->palette.num_colors = num_colors;
         spr->palette.used_colors = num_colors;
+
+        if (perceptual) {
+            palette_refine_oklab(spr, spr->palette.colors, num_colors);
+            exq_set_palette(exq, spr->palette.colors[0], num_colors);
+        }
     } else {
         // Force the input palette
         exq_set_palette(exq, colors, num_colors);
@@ -650,7 +989,14 @@ bool spritemaker_quantize(spritemaker_t *spr, uint8_t *colors, int num_colors, i
         uint8_t* ci_image = malloc(img->width * img->height);
         switch (dither) {
         case DITHER_ALGO_NONE:
-            exq_map_image(exq, img->width * img->height, img->image, ci_image);
+            if (perceptual)
+                palette_map_image(img, spr->palette.colors, num_colors, dither, perceptual, ci_image);
+            else
+                exq_map_image(exq, img->width * img->height, img->image, ci_image);
+            break;
+        case DITHER_ALGO_FLOYD_STEINBERG:
+        case DITHER_ALGO_SIERRA:
+            palette_map_image(img, spr->palette.colors, num_colors, dither, perceptual, ci_image);
             break;
         case DITHER_ALGO_RANDOM:
             exq_map_image_random(exq, img->width * img->height, img->image, ci_image);
@@ -675,6 +1021,171 @@ error:
     return false;
 }
 
+// Compute the 4-entry palette of a compressed block from its endpoints.
+// This must match the decoder in rdpq_tex.c (blockcomp_decode).
+static void blockcomp_palette(uint16_t c0, uint16_t c1, uint16_t pal[4]) {
+    int r0 = c0 >> 11, g0 = (c0 >> 6) & 0x1F, b0 = (c0 >> 1) & 0x1F;
+    int r1 = c1 >> 11, g1 = (c1 >> 6) & 0x1F, b1 = (c1 >> 1) & 0x1F;
+    pal[0] = c0; pal[1] = c1;
+    if (c0 > c1) {
+        pal[2] = (((2*r0+r1)/3) << 11) | (((2*g0+g1)/3) << 6) | (((2*b0+b1)/3) << 1) | 1;
+        pal[3] = (((r0+2*r1)/3) << 11) | (((g0+2*g1)/3) << 6) | (((b0+2*b1)/3) << 1) | 1;
+    } else {
+        pal[2] = (((r0+r1)/2) << 11) | (((g0+g1)/2) << 6) | (((b0+b1)/2) << 1) | 1;
+        pal[3] = 0;
+    }
+}
+
+// Squared error between a RGBA5551 color and a RGBA8888 pixel
+static int blockcomp_dist(uint16_t c, const uint8_t *px) {
+    if (!px[3] || !(c & 1))
+        return (!px[3] == !(c & 1)) ? 0 : 0x1000000;
+    int dr = ((c >> 11) << 3) - px[0];
+    int dg = (((c >> 6) & 0x1F) << 3) - px[1];
+    int db = (((c >> 1) & 0x1F) << 3) - px[2];
+    return dr*dr + dg*dg + db*db;
+}
+
+// Select the best palette index for each pixel of a block, returning the total error
+static int blockcomp_indices(uint16_t c0, uint16_t c1, uint8_t (*px)[4], bool *valid, uint32_t *idx) {
+    uint16_t pal[4];
+    blockcomp_palette(c0, c1, pal);
+    int err = 0;
+    *idx = 0;
+    for (int i=0; i<16; i++) {
+        int best = 0, best_dist = INT32_MAX;
+        if (valid[i]) {
+            for (int j=0; j<4; j++) {
+                int d = blockcomp_dist(pal[j], px[i]);
+                if (d < best_dist) { best = j; best_dist = d; }
+            }
+            err += best_dist;
+        }
+        *idx |= (uint32_t)best << (30 - 2*i);
+    }
+    return err;
+}
+
+// Try a pair of endpoints (as floating point RGB in 0..255), in the block modes compatible with
+// the block contents. Keep them if they are better than the current best.
+static void blockcomp_try(const float *e0, const float *e1, bool has_transp,
+    uint8_t (*px)[4], bool *valid, uint16_t *best_c, uint32_t *best_idx, int *best_err)
+{
+    #define U8(v) ((v) < 0 ? 0 : (v) > 255 ? 255 : (uint8_t)((v) + 0.5f))
+    uint16_t a = conv_rgb5551(U8(e0[0]), U8(e0[1]), U8(e0[2]), 0xFF);
+    uint16_t b = conv_rgb5551(U8(e1[0]), U8(e1[1]), U8(e1[2]), 0xFF);
+    #undef U8
+    uint16_t modes[2][2] = {
+        { a > b ? a : b, a > b ? b : a },   // 4 colors (c0 > c1)
+        { a > b ? b : a, a > b ? a : b },   // 3 colors + transparent (c0 <= c1)
+    };
+    for (int m = has_transp ? 1 : 0; m < 2; m++) {
+        uint32_t idx;
+        int err = blockcomp_indices(modes[m][0], modes[m][1], px, valid, &idx);
+        if (err < *best_err) {
+            best_c[0] = modes[m][0]; best_c[1] = modes[m][1];
+            *best_idx = idx; *best_err = err;
+        }
+    }
+}
+
+/**
+ * @brief Write a RGBA image as 4x4 compressed blocks (--compress-blocks)
+ * 
+ * Each block is made of two RGBA5551 endpoints and 16 2-bit indices (4 bits per pixel).
+ * Endpoints are initially selected along the principal axis of the opaque colors of
+ * the block, and then refined via least squares on the selected indices.
+ */
+void write_rgba16_blocks(FILE *out, image_t *image) {
+    for (int by=0; by<image->height; by+=4) {
+        for (int bx=0; bx<image->width; bx+=4) {
+            uint8_t px[16][4]; bool valid[16];
+            bool has_transp = false; int nopaque = 0;
+            float mean[3] = {0};
+            for (int i=0; i<16; i++) {
+                int x = bx + (i&3), y = by + (i>>2);
+                valid[i] = x < image->width && y < image->height;
+                if (!valid[i]) { memset(px[i], 0, 4); continue; }
+                memcpy(px[i], image->image + (y*image->width + x)*4, 4);
+                if (!px[i][3]) { has_transp = true; continue; }
+                for (int k=0; k<3; k++) mean[k] += px[i][k];
+                nopaque++;
+            }
+
+            uint16_t best_c[2] = { 0, 0 };
+            uint32_t best_idx = 0xFFFFFFFF;
+            int best_err = INT32_MAX;
+            if (nopaque == 0) {
+                // Fully transparent block: 3-color mode, all indices point to transparent
+                goto write;
+            }
+            for (int k=0; k<3; k++) mean[k] /= nopaque;
+
+            // Principal axis of the opaque colors via power iteration on the covariance matrix
+            float cov[6] = {0};
+            for (int i=0; i<16; i++) {
+                if (!valid[i] || !px[i][3]) continue;
+                float d[3] = { px[i][0]-mean[0], px[i][1]-mean[1], px[i][2]-mean[2] };
+                cov[0] += d[0]*d[0]; cov[1] += d[0]*d[1]; cov[2] += d[0]*d[2];
+                cov[3] += d[1]*d[1]; cov[4] += d[1]*d[2]; cov[5] += d[2]*d[2];
+            }
+            float axis[3] = { 1, 1, 1 };
+            for (int it=0; it<8; it++) {
+                float v[3] = {
+                    cov[0]*axis[0] + cov[1]*axis[1] + cov[2]*axis[2],
+                    cov[1]*axis[0] + cov[3]*axis[1] + cov[4]*axis[2],
+                    cov[2]*axis[0] + cov[4]*axis[1] + cov[5]*axis[2],
+                };
+                float len = sqrtf(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+                if (len < 1e-6f) break;
+                for (int k=0; k<3; k++) axis[k] = v[k] / len;
+            }
+
+            // Endpoints are the extremes of the projections on the axis
+            float tmin = 0, tmax = 0;
+            for (int i=0; i<16; i++) {
+                if (!valid[i] || !px[i][3]) continue;
+                float t = (px[i][0]-mean[0])*axis[0] + (px[i][1]-mean[1])*axis[1] + (px[i][2]-mean[2])*axis[2];
+                if (t < tmin) tmin = t;
+                if (t > tmax) tmax = t;
+            }
+            float e0[3], e1[3];
+            for (int k=0; k<3; k++) {
+                e0[k] = mean[k] + axis[k]*tmax;
+                e1[k] = mean[k] + axis[k]*tmin;
+            }
+            blockcomp_try(e0, e1, has_transp, px, valid, best_c, &best_idx, &best_err);
+
+            // Least squares refinement of the endpoints given the current indices
+            for (int it=0; it<2 && best_err > 0; it++) {
+                static const float w4[4] = { 1.0f, 0.0f, 2.0f/3.0f, 1.0f/3.0f };
+                static const float w3[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+                const float *w = best_c[0] > best_c[1] ? w4 : w3;
+                float aa = 0, ab = 0, bb = 0, ax[3] = {0}, bx_[3] = {0};
+                for (int i=0; i<16; i++) {
+                    int ix = (best_idx >> (30 - 2*i)) & 3;
+                    if (!valid[i] || !px[i][3] || (w == w3 && ix == 3)) continue;
+                    float a = w[ix], b = 1.0f - a;
+                    aa += a*a; ab += a*b; bb += b*b;
+                    for (int k=0; k<3; k++) { ax[k] += a*px[i][k]; bx_[k] += b*px[i][k]; }
+                }
+                float det = aa*bb - ab*ab;
+                if (fabsf(det) < 1e-6f) break;
+                for (int k=0; k<3; k++) {
+                    e0[k] = (ax[k]*bb - bx_[k]*ab) / det;
+                    e1[k] = (bx_[k]*aa - ax[k]*ab) / det;
+                }
+                blockcomp_try(e0, e1, has_transp, px, valid, best_c, &best_idx, &best_err);
+            }
+
+        write:
+            w16(out, best_c[0]);
+            w16(out, best_c[1]);
+            w32(out, best_idx);
+        }
+    }
+}
+
 bool spritemaker_write(spritemaker_t *spr) {
     FILE *out;
     if (strcmp(spr->outfn, "(stdout)") == 0) {
@@ -700,11 +1211,12 @@ bool spritemaker_write(spritemaker_t *spr) {
     w16(out, spr->images[0].width);
     w16(out, spr->images[0].height);
     w8(out, 0); // deprecated field
-    w8(out, (uint8_t)(img0fmt | SPRITE_FLAGS_EXT));
+    w8(out, (uint8_t)(img0fmt | SPRITE_FLAGS_EXT | (spr->blockcomp ? SPRITE_FLAGS_BLOCKCOMP : 0)));
     w8(out, spr->hslices);
     w8(out, spr->vslices);
 
     uint32_t w_palpos = 0;
+    uint32_t w_atlaspos = 0;
     uint32_t w_lodpos[7] = {0};
 
     // Process the images (the first always exists)
@@ -722,6 +1234,10 @@ bool spritemaker_write(spritemaker_t *spr) {
         switch ((int)image->fmt) {
         case FMT_RGBA16: {
             assert(image->ct == LCT_RGBA);
+            if (spr->blockcomp) {
+                write_rgba16_blocks(out, image);
+                break;
+            }
             // Convert to 16-bit RGB5551 format.
             uint8_t *img = image->image;
             for (int i=0;i<image->width*image->height;i++) {
@@ -816,7 +1332,7 @@ bool spritemaker_write(spritemaker_t *spr) {
         // Write extended sprite header after first image
         // See sprite_ext_t (sprite_internal.h)
         if (m == 0) { 
-            w16(out, 124);  // sizeof(sprite_ext_t)
+            w16(out, 128);  // sizeof(sprite_ext_t)
             w16(out, 4);    // version
             w_palpos = w32_placeholder(out); // placeholder for position of palette
             int numlods = 0;
@@ -861,6 +1377,7 @@ bool spritemaker_write(spritemaker_t *spr) {
             w8(out, 0); // padding
             w8(out, 0); // padding
             w8(out, 0); // padding
+            w_atlaspos = w32_placeholder(out); // placeholder for position of atlas
 
             walign(out, 8);
         }
@@ -883,6 +1400,27 @@ bool spritemaker_write(spritemaker_t *spr) {
         walign(out, 8);
     }
 
+    // Write the atlas sub-images table, if this is an atlas sheet.
+    // See sprite_atlas_t (sprite_internal.h)
+    if (spr->atlas_count > 0) {
+        w32_at(out, w_atlaspos, ftell(out));
+        w16(out, spr->atlas_count);
+        w16(out, 0); // padding
+        uint32_t w_namepos[spr->atlas_count];
+        for (int i=0; i<spr->atlas_count; i++) {
+            w16(out, spr->atlas[i].x);
+            w16(out, spr->atlas[i].y);
+            w16(out, spr->atlas[i].w);
+            w16(out, spr->atlas[i].h);
+            w_namepos[i] = w32_placeholder(out);
+        }
+        for (int i=0; i<spr->atlas_count; i++) {
+            w32_at(out, w_namepos[i], ftell(out));
+            fwrite(spr->atlas[i].name, 1, strlen(spr->atlas[i].name)+1, out);
+        }
+        walign(out, 8);
+    }
+
     if (strcmp(spr->outfn, "(stdout)") == 0) {
         // Copy the temporary file to stdout
         char buf[4096]; size_t n;
@@ -942,15 +1480,18 @@ void spritemaker_free(spritemaker_t *spr) {
     memset(spr, 0, sizeof(*spr));
 }
 
-int convert(const char *infn, const char *outfn, const parms_t *pm) {
+/**
+ * @brief Convert a sprite whose input (file or in-memory PNG) has already been configured
+ *
+ * This function takes ownership of the spritemaker_t and frees it on exit.
+ */
+int convert_sprite(spritemaker_t *_spr, const parms_t *pm) {
+    spritemaker_t spr = *_spr;
     if (flag_verbose)
-        fprintf(stderr, "Converting: %s -> %s [fmt=%s tiles=%d,%d mipmap=%s dither=%s]\n",
-            infn, outfn, tex_format_name(pm->outfmt), pm->tilew, pm->tileh, mipmap_algo_name(pm->mipmap_algo), dither_algo_name(pm->dither_algo));
+        fprintf(stderr, "Converting: %s -> %s [fmt=%s tiles=%d,%d mipmap=%s dither=%s%s]\n",
+            spr.infn, spr.outfn, tex_format_name(pm->outfmt), pm->tilew, pm->tileh, mipmap_algo_name(pm->mipmap_algo), dither_algo_name(pm->dither_algo),
+            pm->perceptual ? " perceptual" : "");
 
-    spritemaker_t spr = {0};
-
-    spr.infn = infn;
-    spr.outfn = outfn;
     spr.texparms = pm->texparms;
     if (!spr.texparms.defined) {
         spr.texparms.s.translate = 0.0f;
@@ -997,7 +1538,7 @@ int convert(const char *infn, const char *outfn, const parms_t *pm) {
             // Expand to RGBA, calc lods, and quantize with the original palette
             if (!spritemaker_expand_rgba(&spr)
                 || !spritemaker_calc_lods(&spr, pm->mipmap_algo)
-                || !spritemaker_quantize(&spr, orig_palette.colors[0], fmt_colors, pm->dither_algo))
+                || !spritemaker_quantize(&spr, orig_palette.colors[0], fmt_colors, pm->dither_algo, pm->perceptual))
                 goto error;
 
             // Restore palette. Notice that spritemake_quantize has already done that
@@ -1021,7 +1562,7 @@ int convert(const char *infn, const char *outfn, const parms_t *pm) {
 
         switch (spr.images[0].ct) {
         case LCT_RGBA:
-            if (!spritemaker_quantize(&spr, NULL, expected_colors, pm->dither_algo))
+            if (!spritemaker_quantize(&spr, NULL, expected_colors, pm->dither_algo, pm->perceptual))
                 goto error;
             break;
         case LCT_PALETTE:
@@ -1029,7 +1570,7 @@ int convert(const char *infn, const char *outfn, const parms_t *pm) {
             // the requested number of colors is less than the actually used colors.
             if (expected_colors < spr.palette.used_colors) {
                 if (!spritemaker_expand_rgba(&spr) || 
-                    !spritemaker_quantize(&spr, NULL, expected_colors, pm->dither_algo))
+                    !spritemaker_quantize(&spr, NULL, expected_colors, pm->dither_algo, pm->perceptual))
                     goto error;
             }
             break;
@@ -1056,6 +1597,13 @@ int convert(const char *infn, const char *outfn, const parms_t *pm) {
             fprintf(stderr, "auto detected vslices: %d (w=%d/%d)\n", spr.vslices, spr.images[0].height, spr.images[0].height/spr.vslices);
     }
 
+    // Block compression is only available for RGBA16 images
+    spr.blockcomp = pm->blockcomp;
+    if (spr.blockcomp && spr.images[0].fmt != FMT_RGBA16) {
+        fprintf(stderr, "ERROR: --compress-blocks requires RGBA16 format (got: %s)\n", tex_format_name(spr.images[0].fmt));
+        goto error;
+    }
+
     // Write the sprite
     if (!spritemaker_write(&spr))
         goto error;
@@ -1072,6 +1620,165 @@ error:
     return 1;
 }
 
+int convert(const char *infn, const char *outfn, const parms_t *pm) {
+    spritemaker_t spr = {0};
+    spr.infn = infn;
+    spr.outfn = outfn;
+    return convert_sprite(&spr, pm);
+}
+
+/**
+ * @brief Compute the default size of an atlas sheet, so that it fits TMEM in one upload
+ */
+void atlas_default_size(tex_format_t fmt, int *width, int *height) {
+    if (fmt == FMT_NONE) fmt = FMT_RGBA16;
+    int tmem = 4096;
+    if (fmt == FMT_CI4 || fmt == FMT_CI8) tmem -= 2048;
+    int texels = tmem * 8 / TEX_FORMAT_BITDEPTH(fmt);
+    // Use a square sheet if possible, otherwise twice as wide as tall
+    int w = 1;
+    while (w * w < texels) w *= 2;
+    *width = w;
+    *height = texels / w;
+}
+
+/**
+ * @brief Pack multiple input images into one or more atlas sheets
+ *
+ * Each sheet is converted as a single sprite, so that all its sub-images share
+ * the same palette and can be drawn after a single upload to TMEM. The position
+ * of each sub-image is stored in the sprite, and can be queried at runtime
+ * via #sprite_get_atlas_rect.
+ *
+ * @param infns     Input files
+ * @param num       Number of input files
+ * @param outdir    Output directory
+ * @param outfns    Filled with the allocated names of the generated sheets
+ * @param pm        Conversion parameters
+ * @return          Number of generated sheets, or -1 in case of error
+ */
+int convert_atlas(const char **infns, int num, const char *outdir, char ***outfns, const parms_t *pm) {
+    int sheet_w = pm->atlas.width, sheet_h = pm->atlas.height;
+    if (!sheet_w || !sheet_h)
+        atlas_default_size(pm->outfmt, &sheet_w, &sheet_h);
+    int pad = pm->atlas.padding;
+
+    // Decode all the input images as RGBA. Quantization (if any) will be
+    // performed later on each whole sheet, so to share the palette.
+    uint8_t **pixels = calloc(num, sizeof(uint8_t*));
+    stbrp_node *nodes = NULL;
+    stbrp_rect *rects = calloc(num, sizeof(stbrp_rect));
+    atlas_rect_t *arects = calloc(num, sizeof(atlas_rect_t));
+    int nsheets = 0, npacked = 0;
+    *outfns = NULL;
+
+    for (int i=0; i<num; i++) {
+        unsigned w, h;
+        int error = lodepng_decode32_file(&pixels[i], &w, &h, infns[i]);
+        if (error) {
+            fprintf(stderr, "%s: PNG reading error: %u: %s\n", infns[i], error, lodepng_error_text(error));
+            goto error;
+        }
+        if (w + pad > sheet_w || h + pad > sheet_h) {
+            fprintf(stderr, "ERROR: %s (%dx%d) does not fit in an atlas sheet of %dx%d\n", infns[i], w, h, sheet_w, sheet_h);
+            goto error;
+        }
+        rects[i] = (stbrp_rect){ .id = i, .w = w + pad, .h = h + pad };
+
+        const char *basename = strrchr(infns[i], '/');
+        basename = basename ? basename+1 : infns[i];
+        arects[i] = (atlas_rect_t){ .w = w, .h = h, .name = strdup(basename) };
+        char *ext = strrchr(arects[i].name, '.');
+        if (ext) *ext = '\0';
+    }
+
+    // Pack the images into as many sheets as needed. Every round, packs
+    // the images that did not fit in the previous sheets.
+    nodes = malloc(sheet_w * sizeof(stbrp_node));
+    while (npacked < num) {
+        stbrp_context ctx;
+        stbrp_init_target(&ctx, sheet_w + pad, sheet_h + pad, nodes, sheet_w);
+        stbrp_pack_rects(&ctx, rects, num);
+
+        // Collect the rects packed in this round (and not in previous ones),
+        // and blit them into the sheet.
+        spritemaker_t spr = {0};
+        spr.atlas = calloc(num, sizeof(atlas_rect_t));
+        uint8_t *sheet = calloc(sheet_w * sheet_h, 4);
+        int used_w = 0, used_h = 0;
+        for (int i=0; i<num; i++) {
+            if (!rects[i].was_packed || rects[i].w == 0) continue;
+            int id = rects[i].id;
+            atlas_rect_t *ar = &arects[id];
+            ar->x = rects[i].x;
+            ar->y = rects[i].y;
+            if (ar->x + ar->w > used_w) used_w = ar->x + ar->w;
+            if (ar->y + ar->h > used_h) used_h = ar->y + ar->h;
+            for (int y=0; y<ar->h; y++)
+                memcpy(sheet + ((ar->y + y) * sheet_w + ar->x) * 4, pixels[id] + y * ar->w * 4, ar->w * 4);
+            spr.atlas[spr.atlas_count++] = *ar;
+            // Mark as already packed, so the next round ignores it
+            rects[i].w = rects[i].h = 0;
+        }
+        assert(spr.atlas_count > 0);
+        npacked += spr.atlas_count;
+
+        // Shrink the sheet to the used area, keeping the width a multiple of 8 texels
+        used_w = ROUND_UP(used_w, 8);
+        if (used_w > sheet_w) used_w = sheet_w;
+        for (int y=1; y<used_h; y++)
+            memmove(sheet + y * used_w * 4, sheet + y * sheet_w * 4, used_w * 4);
+
+        // Encode the sheet as PNG, so that it can go through the standard
+        // conversion pipeline (format autodetection, quantization, etc.)
+        uint8_t *png = NULL; size_t pngsize = 0;
+        int error = lodepng_encode32(&png, &pngsize, sheet, used_w, used_h);
+        free(sheet);
+        if (error) {
+            fprintf(stderr, "ERROR: encoding atlas sheet: %u: %s\n", error, lodepng_error_text(error));
+            free(spr.atlas);
+            goto error;
+        }
+
+        char *outfn;
+        if (npacked == num && nsheets == 0)
+            asprintf(&outfn, "%s/%s.sprite", outdir, pm->atlas.name);
+        else
+            asprintf(&outfn, "%s/%s_%d.sprite", outdir, pm->atlas.name, nsheets);
+        *outfns = realloc(*outfns, (nsheets+1) * sizeof(char*));
+        (*outfns)[nsheets++] = outfn;
+
+        if (flag_verbose) {
+            fprintf(stderr, "atlas sheet %s: %dx%d, %d images\n", outfn, used_w, used_h, spr.atlas_count);
+            for (int r=0; r<spr.atlas_count; r++)
+                fprintf(stderr, "  [%d] %s: %d,%d %dx%d\n", r, spr.atlas[r].name,
+                    spr.atlas[r].x, spr.atlas[r].y, spr.atlas[r].w, spr.atlas[r].h);
+        }
+
+        spr.infn = pm->atlas.name;
+        spr.outfn = outfn;
+        spr.inpng = png;
+        spr.inpng_size = pngsize;
+        atlas_rect_t *sheet_rects = spr.atlas;
+        int res = convert_sprite(&spr, pm);
+        free(sheet_rects);
+        free(png);
+        if (res != 0)
+            goto error;
+    }
+    free(nodes);
+
+    for (int i=0; i<num; i++) { free(pixels[i]); free(arects[i].name); }
+    free(pixels); free(rects); free(arects);
+    return nsheets;
+
+error:
+    free(nodes);
+    for (int i=0; i<num; i++) { free(pixels[i]); free(arects[i].name); }
+    free(pixels); free(rects); free(arects);
+    return -1;
+}
+
 bool cli_parse_texparms(const char *opt, texparms_t *parms)
 {
     char extra;
@@ -1112,17 +1819,96 @@ bool cli_parse_texparms(const char *opt, texparms_t *parms)
 }
 
 
+typedef struct {
+    const char *infn;       // Input file
+    char *outfn;            // Output file
+    parms_t pm;             // Conversion parameters (as specified before the input file)
+    int compression;        // Compression level
+    bool error;             // Set if the conversion failed
+} convert_job_t;
+
+/** @brief Hash of the inputs and options of a conversion, used by --cache */
+uint64_t convert_job_hash(convert_job_t *job, bool *ok)
+{
+    uint64_t h = BATCH_HASH_INIT;
+    h = batch_hash_str(h, "mksprite");
+    h = batch_hash_file(h, job->infn, ok);
+    if (*ok && job->pm.detail.enabled && job->pm.detail.infn)
+        h = batch_hash_file(h, job->pm.detail.infn, ok);
+
+    // Hash the options, excluding pointers which change at every run
+    parms_t pm = job->pm;
+    pm.detail.infn = NULL;
+    pm.atlas.name = NULL;
+    h = batch_hash_buf(h, &pm, sizeof(pm));
+    h = batch_hash_buf(h, &job->compression, sizeof(job->compression));
+    return h;
+}
+
+void compress_output(const char *outfn, int compression);
+
+void convert_job(int idx, void *arg)
+{
+    convert_job_t *job = &((convert_job_t*)arg)[idx];
+    double t0 = batch_time_ms();
+
+    uint64_t hash = 0; bool ok = false;
+    if (flag_cache) {
+        hash = convert_job_hash(job, &ok);
+        if (ok && batch_cache_check(flag_cache, job->outfn, hash)) {
+            if (flag_timings)
+                fprintf(stderr, "[ up-to-date ] %s\n", job->outfn);
+            return;
+        }
+    }
+
+    if (convert(job->infn, job->outfn, &job->pm) != 0) {
+        job->error = true;
+        return;
+    }
+
+    // The compressors are not thread-safe
+    batch_lock();
+    compress_output(job->outfn, job->compression);
+    batch_unlock();
+
+    if (flag_cache && ok)
+        batch_cache_update(flag_cache, job->outfn, hash);
+    if (flag_timings)
+        fprintf(stderr, "[%9.1f ms] %s -> %s\n", batch_time_ms() - t0, job->infn, job->outfn);
+}
+
+void compress_output(const char *outfn, int compression)
+{
+    if (compression == -1)
+        compression = DEFAULT_COMPRESSION;
+    if (compression) {
+        struct stat st_decomp = {0}, st_comp = {0};
+        stat(outfn, &st_decomp);
+        asset_compress(outfn, outfn, compression);
+        stat(outfn, &st_comp);
+        if (flag_verbose)
+            fprintf(stderr, "compressed: %s (%d -> %d, ratio %.1f%%)\n", outfn,
+            (int)st_decomp.st_size, (int)st_comp.st_size, 100.0 * (float)st_comp.st_size / (float)(st_decomp.st_size == 0 ? 1 :st_decomp.st_size));
+    }
+}
+
 int main(int argc, char *argv[])
 {
     char *infn = NULL, *outdir = ".", *outfn = NULL;
     parms_t pm = {0}; int compression = -1;
     bool at_least_one_file = false;
+    char **atlas_infns = NULL; int atlas_num = 0;
+    convert_job_t *jobs = NULL; int num_jobs = 0;
+    int parallel = 1; batch_cache_t cache;
 
     if (argc < 2) {
         print_args(argv[0]);
         return 1;
     }
 
+    oklab_init();
+
     // We still support (but not document) the old mksprite command line
     // syntax: mksprite <bitdepth> [hslices vslices] input output
     if ((argc == 4 || argc == 6) && (!strcmp(argv[1], "16") || !strcmp(argv[1], "32"))) {
@@ -1161,6 +1947,35 @@ int main(int argc, char *argv[])
                 flag_debug = true;
             } 
 
+            /* ---------------- JOBS console argument ------------------- */
+            /* -j/--jobs <n>         Convert input files in parallel using n threads             */
+            else if (!strcmp(argv[i], "-j") || !strcmp(argv[i], "--jobs")) {
+                if (++i == argc) {
+                    fprintf(stderr, "missing argument for %s\n", argv[i-1]);
+                    return 1;
+                }
+                char extra;
+                if (sscanf(argv[i], "%d%c", &parallel, &extra) != 1 || parallel < 0) {
+                    fprintf(stderr, "invalid argument for %s: %s\n", argv[i-1], argv[i]);
+                    return 1;
+                }
+                if (parallel == 0)
+                    parallel = batch_default_jobs();
+                flag_timings = true;
+            }
+
+            /* ---------------- CACHE console argument ------------------- */
+            /* --cache <file>        Skip input files whose contents and options did not change             */
+            else if (!strcmp(argv[i], "--cache")) {
+                if (++i == argc) {
+                    fprintf(stderr, "missing argument for %s\n", argv[i-1]);
+                    return 1;
+                }
+                if (flag_cache) batch_cache_free(flag_cache);
+                batch_cache_load(&cache, argv[i]);
+                flag_cache = &cache;
+            }
+
             /* ---------------- OUTPUT FILE console argument ------------------- */
             /* -o/--output <dir>     Specify output directory (default: .)             */
             else if (!strcmp(argv[i], "-o") || !strcmp(argv[i], "--output")) {
@@ -1208,6 +2023,8 @@ int main(int argc, char *argv[])
                 }
                 if (!strcmp(argv[i], "NONE")) pm.mipmap_algo = MIPMAP_ALGO_NONE;
                 else if (!strcmp(argv[i], "BOX")) pm.mipmap_algo = MIPMAP_ALGO_BOX;
+                else if (!strcmp(argv[i], "LANCZOS")) pm.mipmap_algo = MIPMAP_ALGO_LANCZOS;
+                else if (!strcmp(argv[i], "KAISER")) pm.mipmap_algo = MIPMAP_ALGO_KAISER;
                 else {
                     fprintf(stderr, "invalid mipmap algorithm: %s\n", argv[i]);
                     print_supported_mipmap();
@@ -1225,6 +2042,8 @@ int main(int argc, char *argv[])
                 if (!strcmp(argv[i], "NONE")) pm.dither_algo = DITHER_ALGO_NONE;
                 else if (!strcmp(argv[i], "RANDOM")) pm.dither_algo = DITHER_ALGO_RANDOM;
                 else if (!strcmp(argv[i], "ORDERED")) pm.dither_algo = DITHER_ALGO_ORDERED;
+                else if (!strcmp(argv[i], "FLOYD_STEINBERG")) pm.dither_algo = DITHER_ALGO_FLOYD_STEINBERG;
+                else if (!strcmp(argv[i], "SIERRA")) pm.dither_algo = DITHER_ALGO_SIERRA;
                 else {
                     fprintf(stderr, "invalid dithering algorithm: %s\n", argv[i]);
                     print_supported_dithers();
@@ -1232,6 +2051,18 @@ int main(int argc, char *argv[])
                 }
             } 
             
+            /* ---------------- PERCEPTUAL console argument ------------------- */
+            /* -p/--perceptual       Select and map CI4/CI8 palettes in the OKLab color space             */
+            else if (!strcmp(argv[i], "-p") || !strcmp(argv[i], "--perceptual")) {
+                pm.perceptual = true;
+            }
+
+            /* ---------------- COMPRESS-BLOCKS console argument ------------------- */
+            /* --compress-blocks     Store RGBA16 images as 4x4 compressed blocks             */
+            else if (!strcmp(argv[i], "--compress-blocks")) {
+                pm.blockcomp = true;
+            }
+
             /* ---------------- COMPRESS console argument ------------------- */
             /* -c/--compress         Compress output files (using mksasset)             */
             else if (!strcmp(argv[i], "-c") || !strcmp(argv[i], "--compress")) {
@@ -1324,6 +2155,41 @@ int main(int argc, char *argv[])
                     return 1;
             }
             
+            /* ---------------- ATLAS console arguments ------------------- */
+            /* --atlas <name>          Pack all input images into atlas sheets             */
+            else if (!strcmp(argv[i], "--atlas")) {
+                if (++i == argc) {
+                    fprintf(stderr, "missing argument for %s\n", argv[i-1]);
+                    return 1;
+                }
+                pm.atlas.name = argv[i];
+            }
+            /* --atlas-size <w,h>      Maximum size of an atlas sheet             */
+            else if (!strcmp(argv[i], "--atlas-size")) {
+                if (++i == argc) {
+                    fprintf(stderr, "missing argument for %s\n", argv[i-1]);
+                    return 1;
+                }
+                char extra;
+                if (sscanf(argv[i], "%d,%d%c", &pm.atlas.width, &pm.atlas.height, &extra) != 2 ||
+                    pm.atlas.width <= 0 || pm.atlas.height <= 0) {
+                    fprintf(stderr, "invalid argument for %s: %s\n", argv[i-1], argv[i]);
+                    return 1;
+                }
+            }
+            /* --atlas-padding <n>     Empty pixels between images in the atlas             */
+            else if (!strcmp(argv[i], "--atlas-padding")) {
+                if (++i == argc) {
+                    fprintf(stderr, "missing argument for %s\n", argv[i-1]);
+                    return 1;
+                }
+                char extra;
+                if (sscanf(argv[i], "%d%c", &pm.atlas.padding, &extra) != 1 || pm.atlas.padding < 0) {
+                    fprintf(stderr, "invalid argument for %s: %s\n", argv[i-1], argv[i]);
+                    return 1;
+                }
+            }
+
             else {
                 fprintf(stderr, "invalid flag: %s\n", argv[i]);
                 return 1;
@@ -1332,6 +2198,13 @@ int main(int argc, char *argv[])
         }
 
         at_least_one_file = true;
+        if (pm.atlas.name) {
+            // Atlas inputs are converted all together at the end
+            atlas_infns = realloc(atlas_infns, (atlas_num+1) * sizeof(char*));
+            atlas_infns[atlas_num++] = argv[i];
+            continue;
+        }
+
         infn = argv[i];
         char *basename = strrchr(infn, '/');
         if (!basename) basename = infn; else basename += 1;
@@ -1340,24 +2213,38 @@ int main(int argc, char *argv[])
         if (ext) *ext = '\0';
 
         asprintf(&outfn, "%s/%s.sprite", outdir, basename_noext);
+        free(basename_noext);
 
-        if (convert(infn, outfn, &pm) != 0) {
-            error = true;
-        } else {
-            if (compression == -1)
-                compression = DEFAULT_COMPRESSION;
-            if (compression) {
-                struct stat st_decomp = {0}, st_comp = {0};
-                stat(outfn, &st_decomp);
-                asset_compress(outfn, outfn, compression);
-                stat(outfn, &st_comp);
-                if (flag_verbose)
-                    fprintf(stderr, "compressed: %s (%d -> %d, ratio %.1f%%)\n", outfn,
-                    (int)st_decomp.st_size, (int)st_comp.st_size, 100.0 * (float)st_comp.st_size / (float)(st_decomp.st_size == 0 ? 1 :st_decomp.st_size));
-            }
+        // Queue the conversion with the options specified so far
+        jobs = realloc(jobs, (num_jobs+1) * sizeof(convert_job_t));
+        jobs[num_jobs++] = (convert_job_t){
+            .infn = infn, .outfn = outfn, .pm = pm, .compression = compression,
+        };
+    }
+
+    if (num_jobs > 0) {
+        double t0 = batch_time_ms();
+        batch_run(parallel, num_jobs, convert_job, jobs);
+        for (int i=0; i<num_jobs; i++) {
+            if (jobs[i].error) error = true;
+            free(jobs[i].outfn);
         }
+        if (flag_timings)
+            fprintf(stderr, "[%9.1f ms] total (%d files, %d jobs)\n", batch_time_ms() - t0, num_jobs, parallel);
+        free(jobs);
+    }
 
-        free(outfn);
+    if (atlas_num > 0) {
+        char **outfns = NULL;
+        int nsheets = convert_atlas((const char**)atlas_infns, atlas_num, outdir, &outfns, &pm);
+        if (nsheets < 0)
+            error = true;
+        for (int i=0; i<nsheets; i++) {
+            compress_output(outfns[i], compression);
+            free(outfns[i]);
+        }
+        free(outfns);
+        free(atlas_infns);
     }
 
     if (!at_least_one_file) {
@@ -1378,5 +2265,10 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (flag_cache) {
+        batch_cache_save(flag_cache);
+        batch_cache_free(flag_cache);
+    }
+
     return error ? 1 : 0;
 }